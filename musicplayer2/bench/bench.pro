@@ -0,0 +1,12 @@
+# Benchmarks, built on demand: qmake bench/bench.pro && make, then run each
+# binary (release builds give the meaningful numbers). startup/startup.sh
+# is a script run against the two application builds instead.
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    controlload \
+    dsp \
+    playlistimport \
+    playlistmanager \
+    searchindex \
+    spectrum
@@ -0,0 +1,18 @@
+QT       += core network
+QT       -= gui
+
+CONFIG += c++17 console release
+CONFIG -= app_bundle
+
+TARGET = bench_controlload
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../controlserver.cpp \
+    ../../trackstorage.cpp
+
+HEADERS += \
+    ../../controlserver.h \
+    ../../trackstorage.h
@@ -0,0 +1,157 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QTextStream>
+#include <QTimer>
+#include <QtEndian>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "controlserver.h"
+
+namespace {
+
+// One connection; replies come back in request order, so the send times
+// queue up and each reply pops the oldest
+struct Client {
+    QLocalSocket socket;
+    std::deque<qint64> sentNs;
+    QByteArray buffer;
+};
+
+QByteArray frame(quint8 command, const QByteArray& argument) {
+    QByteArray data(4, Qt::Uninitialized);
+    qToBigEndian<quint32>(static_cast<quint32>(1 + argument.size()), data.data());
+    data.append(static_cast<char>(command));
+    data.append(argument);
+    return data;
+}
+
+double percentile(const std::vector<qint64>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p / 100.0 * sorted.size()));
+    return sorted[index] / 1000.0;
+}
+
+} // namespace
+
+// Drives a running player's control socket at a fixed request rate over
+// several connections and reports reply latency percentiles, e.g.
+//   musicplayer2-headless &  bench_controlload --rate 5000 --clients 8
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("MusicPlayer");  // same default socket as the player
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Load test for the player's control socket.");
+    parser.addHelpOption();
+    QCommandLineOption socketOption(QStringList() << "s" << "socket", "Control socket name.", "name",
+                                    ControlServer::defaultName());
+    parser.addOption(socketOption);
+    QCommandLineOption rateOption(QStringList() << "r" << "rate", "Requests per second, all clients together.",
+                                  "count", "5000");
+    parser.addOption(rateOption);
+    QCommandLineOption clientsOption(QStringList() << "c" << "clients", "Concurrent connections.", "count", "4");
+    parser.addOption(clientsOption);
+    QCommandLineOption durationOption(QStringList() << "d" << "duration", "Seconds to run.", "seconds", "10");
+    parser.addOption(durationOption);
+    QCommandLineOption mixOption(QStringList() << "m" << "mix",
+                                     "Requests to send: status (IsPlaying/Current/Count, read-only) "
+                                     "or list (List of 100 rows).", "mix", "status");
+    parser.addOption(mixOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int rate = qMax(1, parser.value(rateOption).toInt());
+    const int clientCount = qMax(1, parser.value(clientsOption).toInt());
+    const qint64 durationMs = qMax(1, parser.value(durationOption).toInt()) * 1000LL;
+    const bool listMix = parser.value(mixOption) == "list";
+
+    std::vector<std::unique_ptr<Client>> clients;
+    std::vector<qint64> latencies;
+    latencies.reserve(static_cast<size_t>(rate) * durationMs / 1000);
+    QElapsedTimer clock;
+    qint64 failed = 0;
+
+    for (int i = 0; i < clientCount; ++i) {
+        auto client = std::make_unique<Client>();
+        client->socket.connectToServer(parser.value(socketOption));
+        if (!client->socket.waitForConnected(1000)) {
+            out << "Cannot connect: " << client->socket.errorString() << Qt::endl;
+            return 1;
+        }
+        Client* c = client.get();
+        QObject::connect(&c->socket, &QLocalSocket::readyRead, &app, [&, c]() {
+            c->buffer.append(c->socket.readAll());
+            qsizetype offset = 0;
+            while (c->buffer.size() - offset >= 4) {
+                const quint32 length = qFromBigEndian<quint32>(c->buffer.constData() + offset);
+                if (c->buffer.size() - offset - 4 < static_cast<qsizetype>(length)) {
+                    break;
+                }
+                if (c->buffer.at(offset + 4) != ControlServer::Ok) {
+                    ++failed;
+                }
+                if (!c->sentNs.empty()) {
+                    latencies.push_back(clock.nsecsElapsed() - c->sentNs.front());
+                    c->sentNs.pop_front();
+                }
+                offset += 4 + length;
+            }
+            c->buffer.remove(0, offset);
+        });
+        clients.push_back(std::move(client));
+    }
+
+    // Every tick sends what is due so far, so timer jitter does not lower
+    // the rate; requests rotate over the connections
+    const QByteArray requests[] = {
+        listMix ? frame(ControlServer::List, "0 100") : frame(ControlServer::IsPlaying, QByteArray()),
+        listMix ? frame(ControlServer::List, "100 100") : frame(ControlServer::Current, QByteArray()),
+        listMix ? frame(ControlServer::List, "200 100") : frame(ControlServer::Count, QByteArray()),
+    };
+    qint64 sent = 0;
+    QTimer ticker;
+    ticker.setTimerType(Qt::PreciseTimer);
+    ticker.setInterval(1);
+    QObject::connect(&ticker, &QTimer::timeout, &app, [&]() {
+        const qint64 elapsedNs = clock.nsecsElapsed();
+        if (elapsedNs >= durationMs * 1000000) {
+            ticker.stop();
+            return;
+        }
+        const qint64 due = elapsedNs / 1000 * rate / 1000000;
+        for (; sent < due; ++sent) {
+            Client& client = *clients[static_cast<size_t>(sent % clientCount)];
+            client.sentNs.push_back(clock.nsecsElapsed());
+            client.socket.write(requests[sent % 3]);
+        }
+        for (const std::unique_ptr<Client>& client : clients) {
+            client->socket.flush();
+        }
+    });
+
+    // Give outstanding replies a second after the last request
+    QTimer::singleShot(durationMs + 1000, &app, [&]() {
+        std::sort(latencies.begin(), latencies.end());
+        qint64 lost = 0;
+        for (const std::unique_ptr<Client>& client : clients) {
+            lost += static_cast<qint64>(client->sentNs.size());
+        }
+        out << "sent:     " << sent << " (" << sent * 1000 / durationMs << "/s over " << clientCount
+            << " connections)" << Qt::endl
+            << "replies:  " << latencies.size() << ", " << failed << " failed, " << lost << " missing" << Qt::endl
+            << "latency:  p50 " << percentile(latencies, 50) << " us, p90 " << percentile(latencies, 90)
+            << " us, p99 " << percentile(latencies, 99) << " us, p99.9 " << percentile(latencies, 99.9)
+            << " us, max " << (latencies.empty() ? 0.0 : latencies.back() / 1000.0) << " us" << Qt::endl;
+        app.exit(lost == 0 ? 0 : 1);
+    });
+
+    clock.start();
+    ticker.start();
+    return app.exec();
+}
@@ -0,0 +1,5 @@
+# Same flags as the player's CONFIG+=avx2
+TARGET = bench_dsp_avx2
+msvc: QMAKE_CXXFLAGS += /arch:AVX2
+else: QMAKE_CXXFLAGS += -mavx2 -mfma
+include(../dsp.pri)
@@ -0,0 +1,14 @@
+QT        = core
+
+CONFIG += c++17 console release
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += \
+    $$PWD/main.cpp \
+    $$PWD/../../dspchain.cpp
+
+HEADERS += \
+    $$PWD/../../dspchain.h \
+    $$PWD/../../dspkernels.h
@@ -0,0 +1,7 @@
+# One binary per kernel variant, so a single build compares them
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    scalar \
+    sse \
+    avx2
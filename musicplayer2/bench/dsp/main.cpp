@@ -0,0 +1,146 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+#include "dspchain.h"
+#include "dspkernels.h"
+
+namespace {
+
+const int SampleRate = 48000;
+const int Channels = 2;
+// The mixer's DSP block; kernels see whole mixer blocks
+const qint64 ChainFrames = DspChain::MaxBlockFrames;
+const qint64 MixerFrames = 4096;
+const double SecondsPerCase = 0.5;
+
+const char* variant() {
+#if defined(DSP_KERNELS_AVX)
+    return "AVX";
+#elif defined(DSP_KERNELS_SSE)
+    return "SSE";
+#else
+    return "scalar";
+#endif
+}
+
+std::vector<float> noise(size_t count, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> sample(-0.5f, 0.5f);
+    std::vector<float> values(count);
+    for (float& value : values) {
+        value = sample(random);
+    }
+    return values;
+}
+
+// Runs step over blocks of frames for about SecondsPerCase and prints the
+// rate in samples (frames x channels) per second and as a multiple of
+// real time at 48 kHz stereo. reload restores the input before each step
+// so in-place stages never run on their own output.
+void measure(const char* name, qint64 frames, const std::function<void()>& reload,
+             const std::function<void()>& step) {
+    using Clock = std::chrono::steady_clock;
+    qint64 blocks = 0;
+    double busy = 0.0;
+    const Clock::time_point end =
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(SecondsPerCase));
+    while (Clock::now() < end) {
+        for (int i = 0; i < 64; ++i) {
+            reload();
+            const Clock::time_point start = Clock::now();
+            step();
+            busy += std::chrono::duration<double>(Clock::now() - start).count();
+            ++blocks;
+        }
+    }
+    const double samples = static_cast<double>(blocks) * frames * Channels;
+    const double perSecond = samples / busy;
+    std::printf("%-28s %10.1f Msamples/s %10.0fx real time\n", name, perSecond / 1e6,
+                perSecond / (SampleRate * Channels));
+}
+
+} // namespace
+
+// Per-stage throughput of the DSP path on generated stereo noise: the gain
+// and equalizer stages on DspChain-sized blocks, the full chain, and the
+// kernels the mixer calls on its 4096-frame blocks. Built once per kernel
+// variant (bench_dsp_scalar, bench_dsp_sse, bench_dsp_avx2); run each and
+// compare.
+int main() {
+    std::printf("kernels: %s, %d Hz, %d channels\n", variant(), SampleRate, Channels);
+
+    const std::vector<float> input = noise(static_cast<size_t>(MixerFrames * Channels), 1);
+    const std::vector<float> other = noise(static_cast<size_t>(MixerFrames * Channels), 2);
+    const std::vector<float> gainsA(input.size(), 0.6f);
+    const std::vector<float> gainsB(input.size(), 0.8f);
+    std::vector<float> work(input.size());
+    std::vector<float> out(input.size());
+
+    auto reloadChain = [&]() {
+        std::memcpy(work.data(), input.data(), static_cast<size_t>(ChainFrames * Channels) * sizeof(float));
+    };
+    auto reloadMixer = [&]() {
+        std::memcpy(work.data(), input.data(), work.size() * sizeof(float));
+    };
+
+    GainStage gain;
+    gain.prepare(SampleRate, Channels);
+    gain.setGainDb(-6.0f);
+    measure("GainStage", ChainFrames, reloadChain, [&]() { gain.process(work.data(), ChainFrames); });
+
+    // Every band boosted or cut, so none is skipped
+    EqualizerStage allBands;
+    allBands.prepare(SampleRate, Channels);
+    allBands.setEnabled(true);
+    for (int band = 0; band < EqualizerStage::BandCount; ++band) {
+        allBands.setBandGain(band, band % 2 ? 6.0f : -6.0f);
+    }
+    measure("EqualizerStage (10 bands)", ChainFrames, reloadChain,
+            [&]() { allBands.process(work.data(), ChainFrames); });
+
+    EqualizerStage threeBands;
+    threeBands.prepare(SampleRate, Channels);
+    threeBands.setEnabled(true);
+    threeBands.setBandGain(0, 4.0f);
+    threeBands.setBandGain(5, -3.0f);
+    threeBands.setBandGain(9, 2.0f);
+    measure("EqualizerStage (3 bands)", ChainFrames, reloadChain,
+            [&]() { threeBands.process(work.data(), ChainFrames); });
+
+    // What the mixer runs on each block: EQ, preamp, clamp
+    DspChain chain;
+    chain.prepare(SampleRate, Channels);
+    EqualizerStage* eq = chain.addStage(std::make_unique<EqualizerStage>());
+    eq->setEnabled(true);
+    for (int band = 0; band < EqualizerStage::BandCount; ++band) {
+        eq->setBandGain(band, band % 2 ? 6.0f : -6.0f);
+    }
+    chain.addStage(std::make_unique<GainStage>())->setGainDb(-3.0f);
+    measure("DspChain (EQ, gain, clamp)", MixerFrames, reloadMixer,
+            [&]() { chain.process(work.data(), MixerFrames); });
+
+    const qint64 count = static_cast<qint64>(work.size());
+    auto none = []() {};
+    measure("scale", MixerFrames, reloadMixer, [&]() { DspKernels::scale(work.data(), count, 0.7f); });
+    measure("copyScaled", MixerFrames, none,
+            [&]() { DspKernels::copyScaled(out.data(), input.data(), count, 0.7f); });
+    measure("mixWeighted", MixerFrames, none, [&]() {
+        DspKernels::mixWeighted(out.data(), input.data(), gainsA.data(), other.data(), gainsB.data(), count);
+    });
+    measure("multiply", MixerFrames, none,
+            [&]() { DspKernels::multiply(out.data(), input.data(), other.data(), count); });
+    measure("clamp", MixerFrames, reloadMixer, [&]() { DspKernels::clamp(work.data(), count, 0.25f); });
+
+    // Keep the results observable so the loops are not optimized away
+    float sum = 0.0f;
+    for (size_t i = 0; i < out.size(); i += 97) {
+        sum += out[i] + work[i];
+    }
+    std::printf("(checksum %g)\n", static_cast<double>(sum));
+    return 0;
+}
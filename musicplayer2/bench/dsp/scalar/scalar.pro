@@ -0,0 +1,5 @@
+# Plain loops; auto-vectorization is off so they stay scalar
+TARGET = bench_dsp_scalar
+DEFINES += DSP_KERNELS_NO_SIMD
+!msvc: QMAKE_CXXFLAGS += -fno-tree-vectorize
+include(../dsp.pri)
@@ -0,0 +1,3 @@
+# The baseline x86-64 build
+TARGET = bench_dsp_sse
+include(../dsp.pri)
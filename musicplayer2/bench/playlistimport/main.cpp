@@ -0,0 +1,77 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include "playlistio.h"
+#include "playlistmodel.h"
+
+// Generates an M3U with the given number of entries (default 200k, the size
+// the importer is meant to handle well under a second), then imports it the
+// way the window does: PlaylistImporter on its worker, batches added through
+// PlaylistModel on this thread. Prints generation, import and total times.
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times importing a generated M3U playlist.");
+    parser.addHelpOption();
+    QCommandLineOption entriesOption(QStringList() << "n" << "entries", "Entries to generate.", "count", "200000");
+    parser.addOption(entriesOption);
+    QCommandLineOption keepOption(QStringList() << "k" << "keep", "Write the playlist to this path and keep it.", "path");
+    parser.addOption(keepOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int entries = parser.value(entriesOption).toInt();
+    QTemporaryDir dir;
+    const QString path = parser.isSet(keepOption) ? parser.value(keepOption) : dir.filePath("bench.m3u8");
+
+    // Relative entries in nested folders, like a real library export
+    QElapsedTimer timer;
+    timer.start();
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            out << "Cannot write " << path << ": " << file.errorString() << Qt::endl;
+            return 1;
+        }
+        QTextStream playlist(&file);
+        playlist << "#EXTM3U\n";
+        for (int i = 0; i < entries; ++i) {
+            playlist << "#EXTINF:" << 180 + i % 240 << ",Artist " << i % 997 << " - Track " << i << '\n'
+                     << "Music/Artist " << i % 997 << "/Album " << i % 89 << "/" << i << " Track.flac\n";
+        }
+    }
+    const qint64 generateMs = timer.elapsed();
+
+    MusicPlaylist playlist;
+    PlaylistModel model(playlist);
+    PlaylistImporter importer;
+    int added = 0;
+    qint64 addMs = 0;
+    QObject::connect(&importer, &PlaylistImporter::batchReady, &app, [&](const QList<ScannedTrack>& tracks) {
+        QElapsedTimer addTimer;
+        addTimer.start();
+        added += model.addTracks(tracks);
+        addMs += addTimer.elapsed();
+    });
+    QObject::connect(&importer, &PlaylistImporter::finished, &app,
+                     [&](int entriesRead, bool, const QString& error) {
+        const qint64 importMs = timer.elapsed();
+        if (!error.isEmpty()) {
+            out << "Import failed: " << error << Qt::endl;
+            app.exit(1);
+            return;
+        }
+        out << "entries:  " << entriesRead << " read, " << added << " added" << Qt::endl
+            << "generate: " << generateMs << " ms" << Qt::endl
+            << "import:   " << importMs << " ms (" << addMs << " ms adding to the model)" << Qt::endl;
+        app.exit(added == entries ? 0 : 1);
+    });
+
+    timer.restart();
+    importer.import(path);
+    return app.exec();
+}
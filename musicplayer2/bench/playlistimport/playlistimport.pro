@@ -0,0 +1,27 @@
+QT       += core concurrent
+QT       -= gui
+
+CONFIG += c++17 console release
+CONFIG -= app_bundle
+
+TARGET = bench_playlistimport
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../playlistio.cpp \
+    ../../playlistmodel.cpp \
+    ../../playlistsorter.cpp \
+    ../../searchindex.cpp \
+    ../../trace.cpp \
+    ../../trackstorage.cpp
+
+HEADERS += \
+    ../../libraryscanner.h \
+    ../../playlistio.h \
+    ../../playlistmodel.h \
+    ../../playlistsorter.h \
+    ../../searchindex.h \
+    ../../trace.h \
+    ../../trackstorage.h
@@ -0,0 +1,132 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QUrl>
+#include <algorithm>
+#include <vector>
+#include "playlistmanager.h"
+#include "trackstorage.h"
+
+namespace {
+
+// The playlist before the hash index: a duplicate check or lookup is a
+// scan of every item
+class LinearPlaylist {
+public:
+    bool addItem(const QUrl& item, const TrackInfo& display) {
+        if (std::find(items.begin(), items.end(), item) != items.end()) {
+            return false;
+        }
+        items.push_back(item);
+        displays.push_back(display);
+        return true;
+    }
+
+    int findItem(const QUrl& item) const {
+        const auto it = std::find(items.begin(), items.end(), item);
+        return it == items.end() ? -1 : static_cast<int>(it - items.begin());
+    }
+
+private:
+    std::vector<QUrl> items;
+    std::vector<TrackInfo> displays;
+};
+
+using HashedPlaylist = PlaylistManager<QUrl, TrackInfo, QtHasher<QUrl>, TrackStorage>;
+
+struct Timings {
+    qint64 importNs = 0;
+    qint64 rescanNs = 0;
+    qint64 findNs = 0;
+    bool correct = false;
+};
+
+// Import every track, import every tenth again (a rescan that finds them
+// already there), then look every tenth up
+template <typename Playlist>
+Timings run(const std::vector<QUrl>& urls, const std::vector<TrackInfo>& infos) {
+    const size_t step = 10;
+    Playlist playlist;
+    Timings timings;
+    QElapsedTimer timer;
+
+    size_t added = 0;
+    timer.start();
+    for (size_t i = 0; i < urls.size(); ++i) {
+        added += playlist.addItem(urls[i], infos[i]) ? 1 : 0;
+    }
+    timings.importNs = timer.nsecsElapsed();
+
+    size_t rejected = 0;
+    timer.restart();
+    for (size_t i = 0; i < urls.size(); i += step) {
+        rejected += playlist.addItem(urls[i], infos[i]) ? 0 : 1;
+    }
+    timings.rescanNs = timer.nsecsElapsed();
+
+    size_t found = 0;
+    size_t lookups = 0;
+    timer.restart();
+    for (size_t i = step / 2; i < urls.size(); i += step) {
+        found += playlist.findItem(urls[i]) == static_cast<int>(i) ? 1 : 0;
+        ++lookups;
+    }
+    timings.findNs = timer.nsecsElapsed();
+
+    timings.correct = added == urls.size() && rejected == (urls.size() + step - 1) / step
+                      && found == lookups;
+    return timings;
+}
+
+QString ms(qint64 ns) {
+    return QString::number(ns / 1e6, 'f', 2).rightJustified(11);
+}
+
+} // namespace
+
+// Adds 1k, 10k and 100k generated tracks to the linear-scan baseline and to
+// the hash-indexed playlist the player uses, and prints import, re-import
+// and lookup times for both. The baseline is quadratic, so the largest size
+// takes a while; --max-linear limits it.
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times playlist imports with and without the hash index.");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption(QStringList() << "s" << "sizes", "Comma-separated track counts.", "list",
+                                   "1000,10000,100000");
+    parser.addOption(sizesOption);
+    QCommandLineOption maxLinearOption("max-linear", "Largest size to run the linear baseline on.", "count",
+                                       "100000");
+    parser.addOption(maxLinearOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int maxLinear = parser.value(maxLinearOption).toInt();
+    out << "tracks    playlist     import ms   rescan ms   find ms" << Qt::endl;
+    for (const QString& size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        const int count = size.toInt();
+        std::vector<QUrl> urls;
+        std::vector<TrackInfo> infos;
+        urls.reserve(static_cast<size_t>(count));
+        infos.reserve(static_cast<size_t>(count));
+        for (int i = 0; i < count; ++i) {
+            const QString path = QString("/music/Artist %1/Album %2/%3 Track.flac").arg(i % 997).arg(i % 89).arg(i);
+            urls.push_back(QUrl::fromLocalFile(path));
+            infos.push_back(TrackInfo(QString("%1 Track.flac").arg(i)));
+        }
+
+        auto report = [&](const char* name, const Timings& t) {
+            out << QString::number(count).leftJustified(10) << QString(name).leftJustified(10)
+                << ms(t.importNs) << ' ' << ms(t.rescanNs) << ' ' << ms(t.findNs)
+                << (t.correct ? "" : "  (wrong result)") << Qt::endl;
+        };
+        if (count <= maxLinear) {
+            report("linear", run<LinearPlaylist>(urls, infos));
+        }
+        report("hashed", run<HashedPlaylist>(urls, infos));
+    }
+    return 0;
+}
@@ -0,0 +1,17 @@
+QT       += core
+QT       -= gui
+
+CONFIG += c++17 console release
+CONFIG -= app_bundle
+
+TARGET = bench_playlistmanager
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../trackstorage.cpp
+
+HEADERS += \
+    ../../playlistmanager.h \
+    ../../trackstorage.h
@@ -0,0 +1,114 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "searchindex.h"
+
+namespace {
+
+const char* const Words[] = {
+    "love", "night", "blue", "heart", "fire", "river", "dream", "light", "home", "rain",
+    "summer", "shadow", "golden", "little", "wild", "city", "ocean", "sweet", "dancing", "lonely",
+    "electric", "morning", "silver", "stone", "paradise", "midnight", "broken", "highway", "angel", "thunder",
+    "bohemian", "rhapsody", "café", "señorita", "über", "mañana", "déjà", "vu", "el", "la",
+};
+const int WordCount = sizeof(Words) / sizeof(Words[0]);
+
+QString phrase(std::mt19937& random, int words) {
+    QStringList parts;
+    for (int i = 0; i < words; ++i) {
+        parts << Words[random() % WordCount];
+    }
+    return parts.join(' ');
+}
+
+// File name, title, artist and album, as TrackInfo::searchText builds them.
+// Artists and albums repeat the way a real library's do.
+std::vector<QString> makeEntries(int count) {
+    std::mt19937 random(2024);
+    std::vector<QString> artists;
+    std::vector<QString> albums;
+    for (int i = 0; i < 2000; ++i) {
+        artists.push_back(phrase(random, 2) + QString(" %1").arg(i));
+        albums.push_back(phrase(random, 3));
+    }
+
+    std::vector<QString> entries;
+    entries.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        const QString title = phrase(random, 1 + static_cast<int>(random() % 4));
+        const size_t artist = random() % artists.size();
+        entries.push_back(QString("%1 %2.flac %2 %3 %4")
+                              .arg(i % 20 + 1, 2, 10, QChar('0'))
+                              .arg(title, artists[artist], albums[(artist * 7 + random() % 7) % albums.size()]));
+    }
+    return entries;
+}
+
+} // namespace
+
+// Builds a search index over 100k generated playlist entries and times each
+// keystroke of a few queries as they would be typed into the search box:
+// short prefixes with many matches, multi-word titles, a typo, accents and a
+// query nothing matches. Prints the median time per keystroke over --rounds
+// repetitions and the number of matches of the full query.
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times as-you-type playlist search queries.");
+    parser.addHelpOption();
+    QCommandLineOption entriesOption(QStringList() << "n" << "entries", "Playlist entries to index.", "count",
+                                     "100000");
+    parser.addOption(entriesOption);
+    QCommandLineOption roundsOption(QStringList() << "r" << "rounds", "Repetitions of every query.", "count",
+                                    "20");
+    parser.addOption(roundsOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int count = parser.value(entriesOption).toInt();
+    const int rounds = std::max(1, parser.value(roundsOption).toInt());
+    const std::vector<QString> entries = makeEntries(count);
+
+    SearchIndex index;
+    QElapsedTimer timer;
+    timer.start();
+    index.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        index.add(i, entries[i]);
+    }
+    out << "indexed " << count << " entries in " << QString::number(timer.nsecsElapsed() / 1e6, 'f', 1) << " ms"
+        << Qt::endl << Qt::endl;
+
+    const QStringList queries = {"l", "love", "midnight highway", "bohemain rhapsody", "cafe manana",
+                                 "electric 1234", "xylophone"};
+    out << "query                 keystrokes  median us/key  slowest key us  matches" << Qt::endl;
+    for (const QString& query : queries) {
+        std::vector<qint64> perKey;
+        qint64 slowest = 0;
+        size_t matches = 0;
+        for (qsizetype length = 1; length <= query.size(); ++length) {
+            const QString typed = query.left(length);
+            std::vector<qint64> samples;
+            for (int round = 0; round < rounds; ++round) {
+                timer.restart();
+                matches = index.search(typed).size();
+                samples.push_back(timer.nsecsElapsed());
+            }
+            std::sort(samples.begin(), samples.end());
+            perKey.push_back(samples[samples.size() / 2]);
+            slowest = std::max(slowest, samples[samples.size() / 2]);
+        }
+        std::sort(perKey.begin(), perKey.end());
+        out << ('"' + query + '"').leftJustified(22) << QString::number(query.size()).rightJustified(10)
+            << QString::number(perKey[perKey.size() / 2] / 1e3, 'f', 1).rightJustified(15)
+            << QString::number(slowest / 1e3, 'f', 1).rightJustified(16)
+            << QString::number(matches).rightJustified(9) << Qt::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,16 @@
+QT       += core
+QT       -= gui
+
+CONFIG += c++17 console release
+CONFIG -= app_bundle
+
+TARGET = bench_searchindex
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../searchindex.cpp
+
+HEADERS += \
+    ../../searchindex.h
@@ -0,0 +1,126 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <random>
+#include <vector>
+#include "spectrumanalyzer.h"
+
+namespace {
+
+const int SampleRate = 48000;
+const int Channels = 2;
+const int BlockFrames = SampleRate / SpectrumAnalyzer::FramesPerSecond;
+
+// One second of stereo test signal: a sweep from 40 Hz to 16 kHz, two steady
+// tones and some noise, so every bar moves
+std::vector<float> makeSignal() {
+    const double pi = std::acos(-1.0);
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+    std::vector<float> signal(static_cast<size_t>(SampleRate * Channels));
+    double phase = 0.0;
+    for (int frame = 0; frame < SampleRate; ++frame) {
+        const double t = static_cast<double>(frame) / SampleRate;
+        phase += 2.0 * pi * 40.0 * std::pow(400.0, t) / SampleRate;
+        const float sweep = static_cast<float>(0.4 * std::sin(phase));
+        const float tones = static_cast<float>(0.2 * std::sin(2.0 * pi * 110.0 * t) + 0.1 * std::sin(2.0 * pi * 3520.0 * t));
+        signal[static_cast<size_t>(frame * Channels)] = sweep + tones + noise(random);
+        signal[static_cast<size_t>(frame * Channels + 1)] = sweep - tones + noise(random);
+    }
+    return signal;
+}
+
+struct Phase {
+    double cpuMs = 0.0;
+    qint64 writeNs = 0;
+    int blocks = 0;
+    int framesRead = 0;
+};
+
+// Write one block and look for a new frame every 60th of a second for the
+// given time, as the mixer and the visualizer do during playback
+Phase run(SpectrumAnalyzer& analyzer, const std::vector<float>& signal, int seconds) {
+    Phase phase;
+    SpectrumSnapshot snapshot;
+    qint64 offset = 0;
+    QElapsedTimer timer;
+
+    QTimer tick;
+    tick.setTimerType(Qt::PreciseTimer);
+    tick.setInterval(1000 / SpectrumAnalyzer::FramesPerSecond);
+    QObject::connect(&tick, &QTimer::timeout, [&]() {
+        timer.start();
+        analyzer.write(signal.data() + offset * Channels, BlockFrames, Channels);
+        phase.writeNs += timer.nsecsElapsed();
+        offset = (offset + BlockFrames) % (SampleRate - BlockFrames);
+        ++phase.blocks;
+        if (analyzer.latest(snapshot)) {
+            ++phase.framesRead;
+        }
+    });
+
+    QEventLoop loop;
+    QTimer::singleShot(seconds * 1000, &loop, &QEventLoop::quit);
+    const std::clock_t start = std::clock();
+    tick.start();
+    loop.exec();
+    tick.stop();
+    phase.cpuMs = 1000.0 * static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    return phase;
+}
+
+} // namespace
+
+// Drives the spectrum analyzer at 60 Hz with synthetic stereo audio for a
+// few seconds, first inactive (what an idle analyzer and this harness cost)
+// and then active, and prints the process CPU time of both. The difference
+// divided by the frames the visualizer side received is the analysis cost
+// per frame. std::clock is process CPU time on Linux and macOS; on Windows
+// it is wall time, so there only the write timings are meaningful.
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures spectrum analyzer CPU time per frame at 60 Hz.");
+    parser.addHelpOption();
+    QCommandLineOption secondsOption(QStringList() << "s" << "seconds", "Length of each phase.", "seconds", "10");
+    parser.addOption(secondsOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int seconds = std::max(1, parser.value(secondsOption).toInt());
+    const std::vector<float> signal = makeSignal();
+
+    SpectrumAnalyzer analyzer;
+    analyzer.setSampleRate(SampleRate);
+
+    analyzer.setActive(false);
+    const Phase idle = run(analyzer, signal, seconds);
+    analyzer.setActive(true);
+    const Phase active = run(analyzer, signal, seconds);
+
+    auto report = [&](const char* name, const Phase& phase) {
+        out << QString(name).leftJustified(10) << QString::number(phase.blocks).rightJustified(8)
+            << QString::number(phase.framesRead).rightJustified(13)
+            << QString::number(phase.cpuMs, 'f', 1).rightJustified(10)
+            << QString::number(phase.blocks ? phase.writeNs / 1e3 / phase.blocks : 0.0, 'f', 2).rightJustified(14)
+            << Qt::endl;
+    };
+    out << "phase       blocks  frames read    cpu ms  write us/blk" << Qt::endl;
+    report("inactive", idle);
+    report("active", active);
+
+    if (active.framesRead > 0) {
+        const double perFrameUs = 1000.0 * (active.cpuMs - idle.cpuMs) / active.framesRead;
+        out << Qt::endl << "analysis: " << QString::number(perFrameUs, 'f', 1) << " us CPU per frame, "
+            << QString::number(perFrameUs * SpectrumAnalyzer::FramesPerSecond / 1e4, 'f', 2)
+            << "% of one core at " << SpectrumAnalyzer::FramesPerSecond << " Hz" << Qt::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,18 @@
+QT       += core multimedia
+QT       -= gui
+
+CONFIG += c++17 console release
+CONFIG -= app_bundle
+
+TARGET = bench_spectrum
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../spectrumanalyzer.cpp
+
+HEADERS += \
+    ../../dspchain.h \
+    ../../dspkernels.h \
+    ../../spectrumanalyzer.h
@@ -0,0 +1,66 @@
+#!/bin/sh
+# Startup time and peak RSS of the window build against the headless build.
+#
+#   bench/startup/startup.sh path/to/musicplayer2 path/to/musicplayer2-headless [runs]
+#
+# Each binary is started runs times (default 10) with MUSICPLAYER_STARTUP_PROBE
+# set, which makes it quit as soon as its event loop runs and print VmHWM.
+# Wall time covers exec, dynamic loading, library load and the first event
+# loop pass. Both builds get the same fresh data directory, so they load the
+# same (empty) library; set MUSICPLAYER_BENCH_DATA to a directory holding a
+# library.bin to time a real one. Without a display, the window build runs
+# on the offscreen platform unless QT_QPA_PLATFORM says otherwise. Linux only.
+
+set -eu
+
+if [ $# -lt 2 ]; then
+    echo "usage: $0 window-binary headless-binary [runs]" >&2
+    exit 2
+fi
+window=$1
+headless=$2
+runs=${3:-10}
+
+home=$(mktemp -d)
+trap 'rm -rf "$home"' EXIT
+mkdir -p "$home/data/MusicPlayer"
+if [ -n "${MUSICPLAYER_BENCH_DATA:-}" ]; then
+    cp "$MUSICPLAYER_BENCH_DATA"/library.* "$home/data/MusicPlayer/"
+fi
+if [ -z "${DISPLAY:-}${WAYLAND_DISPLAY:-}" ]; then
+    export QT_QPA_PLATFORM=${QT_QPA_PLATFORM:-offscreen}
+fi
+
+# Median of the numbers on standard input
+median() {
+    sort -n | awk '{ v[NR] = $1 } END { print (NR % 2) ? v[(NR + 1) / 2] : (v[NR / 2] + v[NR / 2 + 1]) / 2 }'
+}
+
+measure() {
+    name=$1
+    binary=$2
+    times=$home/times
+    peaks=$home/peaks
+    : > "$times"
+    : > "$peaks"
+    i=0
+    while [ $i -lt "$runs" ]; do
+        start=$(date +%s%N)
+        HOME=$home XDG_DATA_HOME=$home/data MUSICPLAYER_STARTUP_PROBE=1 \
+            "$binary" < /dev/null > /dev/null 2> "$home/stderr"
+        end=$(date +%s%N)
+        echo $(( (end - start) / 1000 )) >> "$times"
+        # "startup-probe VmHWM:    12345 kB"
+        awk '/^startup-probe VmHWM:/ { print $3 }' "$home/stderr" >> "$peaks"
+        i=$((i + 1))
+    done
+    if [ ! -s "$peaks" ]; then
+        echo "$name: no VmHWM reported; is $binary built with the startup probe?" >&2
+        exit 1
+    fi
+    printf '%-10s startup %8.1f ms   VmHWM %8d kB   (median of %d)\n' "$name" \
+        "$(median < "$times" | awk '{ print $1 / 1000 }')" "$(median < "$peaks")" "$runs"
+}
+
+measure window "$window"
+measure headless "$headless"
@@ -0,0 +1,249 @@
+#include "controlserver.h"
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QtEndian>
+#include <exception>
+
+namespace {
+
+// Length prefix in front of every frame
+const int HeaderSize = 4;
+
+// Local files may be given as plain paths, anything else as a URL
+QUrl toUrl(const QString& argument) {
+    if (argument.contains("://")) {
+        return QUrl(argument);
+    }
+    return QUrl::fromLocalFile(QFileInfo(argument).absoluteFilePath());
+}
+
+} // namespace
+
+ControlServer::ControlServer(IPlayer& player, const MusicPlaylist& playlist, QObject *parent)
+    : QObject(parent), player(player), playlist(playlist) {
+    qRegisterMetaType<ControlRequest>();
+    qRegisterMetaType<QList<ControlRequest>>();
+    qRegisterMetaType<ControlReply>();
+    qRegisterMetaType<QList<ControlReply>>();
+
+    // The listener lives on the I/O thread and is deleted there
+    listener = new ControlListener;
+    listener->moveToThread(&ioThread);
+    connect(&ioThread, &QThread::finished, listener, &QObject::deleteLater);
+    connect(listener, &ControlListener::requestsReady, this, &ControlServer::executeBatch);
+    connect(listener, &ControlListener::errorOccurred, this, &ControlServer::errorOccurred);
+    connect(this, &ControlServer::repliesReady, listener, &ControlListener::writeReplies);
+    ioThread.setObjectName("ControlServer");
+    ioThread.start();
+}
+
+ControlServer::~ControlServer() {
+    ioThread.quit();
+    ioThread.wait();
+}
+
+QString ControlServer::defaultName() {
+    const QString name = QCoreApplication::applicationName().toLower() + "-control";
+#ifdef Q_OS_UNIX
+    // Keep the socket in the per-user runtime directory rather than /tmp
+    const QString runtime = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (!runtime.isEmpty()) {
+        return runtime + "/" + name;
+    }
+#endif
+    return name;
+}
+
+void ControlServer::setPlaylistHandlers(std::function<bool(const QString&)> add,
+                                        std::function<bool(int)> remove,
+                                        std::function<int()> current) {
+    addHandler = std::move(add);
+    removeHandler = std::move(remove);
+    currentHandler = std::move(current);
+}
+
+void ControlServer::listen(const QString& name) {
+    QMetaObject::invokeMethod(listener, [listener = listener, name]() {
+        listener->listen(name);
+    });
+}
+
+void ControlServer::executeBatch(const QList<ControlRequest>& requests) {
+    QList<ControlReply> replies;
+    replies.reserve(requests.size());
+    for (const ControlRequest& request : requests) {
+        replies.append(execute(request));
+    }
+    emit repliesReady(replies);
+}
+
+ControlReply ControlServer::execute(const ControlRequest& request) {
+    ControlReply reply;
+    reply.client = request.client;
+    reply.status = Ok;
+    const QString argument = QString::fromUtf8(request.argument);
+
+    auto fail = [&reply](const QByteArray& message) {
+        reply.status = Failed;
+        reply.payload = message;
+    };
+
+    try {
+        switch (request.command) {
+        case Play:
+            player.play();
+            break;
+        case Pause:
+            player.pause();
+            break;
+        case Stop:
+            player.stop();
+            break;
+        case SetSource: {
+            const QUrl url = toUrl(argument);
+            if (playlist.findItem(url) < 0) {
+                fail("Not in the playlist");
+            } else {
+                player.setSource(url);
+            }
+            break;
+        }
+        case IsPlaying:
+            reply.payload = player.isPlaying() ? "1" : "0";
+            break;
+        case Add:
+            if (argument.isEmpty() || !addHandler || !addHandler(argument)) {
+                fail("Cannot add " + request.argument);
+            }
+            break;
+        case Remove: {
+            bool ok = false;
+            const int row = argument.toInt(&ok);
+            if (!ok || !removeHandler || !removeHandler(row)) {
+                fail("No such row");
+            }
+            break;
+        }
+        case Count:
+            reply.payload = QByteArray::number(static_cast<qulonglong>(playlist.size()));
+            break;
+        case List: {
+            const QStringList range = argument.split(' ', Qt::SkipEmptyParts);
+            const int size = static_cast<int>(playlist.size());
+            const int first = qBound(0, range.value(0, "0").toInt(), size);
+            const int count = qBound(0, range.value(1, QString::number(MaxListRows)).toInt(), MaxListRows);
+            const int last = qMin(size, first + count);
+            for (int row = first; row < last; ++row) {
+                reply.payload += QByteArray::number(row) + '\t'
+                                 + playlist.getDisplayInfo(row).displayName().toUtf8() + '\t'
+                                 + playlist.getItem(row).toEncoded() + '\n';
+            }
+            break;
+        }
+        case Current: {
+            const int row = currentHandler ? currentHandler() : -1;
+            reply.payload = QByteArray::number(row);
+            if (row >= 0 && row < static_cast<int>(playlist.size())) {
+                reply.payload += '\t' + playlist.getDisplayInfo(row).displayName().toUtf8();
+            }
+            break;
+        }
+        default:
+            fail("Unknown command");
+            break;
+        }
+    } catch (const std::exception& e) {
+        fail(e.what());
+    }
+    return reply;
+}
+
+ControlListener::ControlListener() : server(nullptr), nextClient(1) {
+}
+
+void ControlListener::listen(const QString& name) {
+    if (!server) {
+        server = new QLocalServer(this);
+        server->setSocketOptions(QLocalServer::UserAccessOption);
+        connect(server, &QLocalServer::newConnection, this, &ControlListener::acceptClients);
+    }
+    server->close();
+
+    bool listening = server->listen(name);
+    if (!listening && server->serverError() == QAbstractSocket::AddressInUseError) {
+        // A socket left behind by a crashed run refuses connections; one
+        // owned by a running player answers and is left alone
+        QLocalSocket probe;
+        probe.connectToServer(name);
+        if (!probe.waitForConnected(100)) {
+            QLocalServer::removeServer(name);
+            listening = server->listen(name);
+        }
+    }
+    if (!listening) {
+        emit errorOccurred("Control server: " + server->errorString());
+    }
+}
+
+void ControlListener::acceptClients() {
+    while (QLocalSocket *socket = server->nextPendingConnection()) {
+        const quint64 client = nextClient++;
+        clients.insert(client, socket);
+        connect(socket, &QLocalSocket::readyRead, this, [this, client, socket]() {
+            readRequests(client, socket);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this, client, socket]() {
+            clients.remove(client);
+            socket->deleteLater();
+        });
+    }
+}
+
+void ControlListener::readRequests(quint64 client, QLocalSocket *socket) {
+    // Every complete frame in the buffer goes over in one batch; a partial
+    // one waits for the next readyRead
+    QList<ControlRequest> requests;
+    while (socket->bytesAvailable() >= HeaderSize) {
+        char header[HeaderSize];
+        socket->peek(header, HeaderSize);
+        const quint32 length = qFromBigEndian<quint32>(header);
+        if (length == 0 || length > static_cast<quint32>(ControlServer::MaxFrameSize)) {
+            socket->abort();
+            break;
+        }
+        if (socket->bytesAvailable() < HeaderSize + static_cast<qint64>(length)) {
+            break;
+        }
+
+        socket->skip(HeaderSize);
+        const QByteArray frame = socket->read(length);
+        ControlRequest request;
+        request.client = client;
+        request.command = static_cast<quint8>(frame.at(0));
+        request.argument = frame.mid(1);
+        requests.append(request);
+    }
+    if (!requests.isEmpty()) {
+        emit requestsReady(requests);
+    }
+}
+
+void ControlListener::writeReplies(const QList<ControlReply>& replies) {
+    for (const ControlReply& reply : replies) {
+        // The client may have gone away while its requests were running
+        QLocalSocket *socket = clients.value(reply.client);
+        if (!socket) {
+            continue;
+        }
+
+        QByteArray frame(HeaderSize, Qt::Uninitialized);
+        qToBigEndian<quint32>(static_cast<quint32>(1 + reply.payload.size()), frame.data());
+        frame.append(static_cast<char>(reply.status));
+        frame.append(reply.payload);
+        socket->write(frame);
+    }
+}
@@ -0,0 +1,135 @@
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <functional>
+#include "iplayer.h"
+#include "playlistmodel.h"
+
+QT_BEGIN_NAMESPACE
+class QLocalServer;
+class QLocalSocket;
+QT_END_NAMESPACE
+
+class ControlListener;
+
+// One framed request from a control client
+struct ControlRequest {
+    quint64 client = 0;
+    quint8 command = 0;
+    QByteArray argument;
+};
+
+// The answer to a request, routed back to the client that sent it
+struct ControlReply {
+    quint64 client = 0;
+    quint8 status = 0;
+    QByteArray payload;
+};
+
+Q_DECLARE_METATYPE(ControlRequest)
+Q_DECLARE_METATYPE(ControlReply)
+
+// Local control API for scripting a running player (QLocalServer: a Unix
+// domain socket, or a named pipe on Windows). Every message in either
+// direction is a frame:
+//   quint32 length (big-endian, bytes that follow)
+//   quint8  command in requests, status in replies
+//   UTF-8   argument or reply text
+// Requests on one connection are answered in order. Socket I/O and framing
+// run on the server's own thread; only complete requests reach the player's
+// thread, in one batch per read, so busy clients never stall the event loop
+// with partial reads or slow writes.
+class ControlServer : public QObject {
+    Q_OBJECT
+
+public:
+    enum Command : quint8 {
+        Play = 1,
+        Pause,
+        Stop,
+        SetSource,  // path or URL of a playlist entry
+        IsPlaying,  // replies "1" or "0"
+        Add,        // audio file, folder or playlist file
+        Remove,     // row, counted from 0
+        Count,      // replies the number of rows
+        List,       // "first count"; replies one "row<TAB>name<TAB>url" line per entry
+        Current     // replies "row<TAB>name", or row -1
+    };
+
+    enum Status : quint8 {
+        Ok = 0,
+        Failed = 1
+    };
+
+    // Larger frames make the server drop the connection
+    static constexpr int MaxFrameSize = 64 * 1024;
+    // Upper bound on the rows one List request returns
+    static constexpr int MaxListRows = 10000;
+
+    ControlServer(IPlayer& player, const MusicPlaylist& playlist, QObject *parent = nullptr);
+    virtual ~ControlServer();
+
+    // Per-user socket name used when none is given
+    static QString defaultName();
+
+    // Playlist mutations go through the owner so its views and current
+    // track stay in sync; add and remove return false if nothing was done,
+    // current returns the playing row or -1
+    void setPlaylistHandlers(std::function<bool(const QString& path)> add,
+                             std::function<bool(int row)> remove,
+                             std::function<int()> current);
+
+    // Start accepting clients; failures are reported through errorOccurred
+    void listen(const QString& name = defaultName());
+
+signals:
+    void errorOccurred(const QString& error);
+
+    // Internal: carries replies to the I/O thread
+    void repliesReady(const QList<ControlReply>& replies);
+
+private:
+    void executeBatch(const QList<ControlRequest>& requests);
+    ControlReply execute(const ControlRequest& request);
+
+    IPlayer& player;
+    const MusicPlaylist& playlist;
+    std::function<bool(const QString&)> addHandler;
+    std::function<bool(int)> removeHandler;
+    std::function<int()> currentHandler;
+
+    QThread ioThread;
+    ControlListener *listener;
+};
+
+// Owns the local server and its client sockets on ControlServer's I/O
+// thread; not used directly
+class ControlListener : public QObject {
+    Q_OBJECT
+
+public:
+    ControlListener();
+
+    void listen(const QString& name);
+    void writeReplies(const QList<ControlReply>& replies);
+
+signals:
+    void requestsReady(const QList<ControlRequest>& requests);
+    void errorOccurred(const QString& error);
+
+private:
+    void acceptClients();
+    void readRequests(quint64 client, QLocalSocket *socket);
+
+    QLocalServer *server;
+    QHash<quint64, QLocalSocket*> clients;
+    quint64 nextClient;
+};
+
+#endif // CONTROLSERVER_H
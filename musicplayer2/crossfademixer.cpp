@@ -0,0 +1,559 @@
+#include "crossfademixer.h"
+#include "dspkernels.h"
+#include "trace.h"
+
+#include <QAudioBuffer>
+#include <QAudioDecoder>
+#include <QAudioDevice>
+#include <QAudioSink>
+#include <QIODevice>
+#include <QMediaDevices>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Frames mixed per inner step; the work buffers are sized for this once
+const qint64 MaxBlockFrames = 4096;
+
+// Quarter sine table for the equal-power fade curves
+const int FadeTableSize = 1024;
+const double HalfPi = 1.57079632679489661923;
+
+float fadeCurve(double t) {
+    static const std::vector<float> table = [] {
+        std::vector<float> values(FadeTableSize + 1);
+        for (int i = 0; i <= FadeTableSize; ++i) {
+            values[i] = static_cast<float>(std::sin(i * HalfPi / FadeTableSize));
+        }
+        return values;
+    }();
+    const double pos = qBound(0.0, t, 1.0) * FadeTableSize;
+    const int i = qMin(static_cast<int>(pos), FadeTableSize - 1);
+    const float frac = static_cast<float>(pos - i);
+    return table[i] + (table[i + 1] - table[i]) * frac;
+}
+
+} // namespace
+
+// Pull-mode device handed to the QAudioSink; every read is a mix call
+class MixerDevice : public QIODevice {
+public:
+    explicit MixerDevice(CrossfadeMixer* mixer) : QIODevice(mixer), mixer(mixer) {}
+
+    bool isSequential() const override { return true; }
+
+    qint64 bytesAvailable() const override {
+        // The mixer can always produce data (silence when idle)
+        return QIODevice::bytesAvailable() + MaxBlockFrames * mixer->audioFormat().bytesPerFrame();
+    }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override {
+        const int bytesPerFrame = mixer->audioFormat().bytesPerFrame();
+        const qint64 frames = maxSize / bytesPerFrame;
+        mixer->mix(reinterpret_cast<float*>(data), frames);
+        return frames * bytesPerFrame;
+    }
+
+    qint64 writeData(const char*, qint64) override {
+        return -1;
+    }
+
+private:
+    CrossfadeMixer* mixer;
+};
+
+CrossfadeMixer::CrossfadeMixer(QObject *parent)
+    : QObject(parent), sink(nullptr), device(nullptr), available(false),
+      current(0), fading(false), fadePos(0), fadeLength(0), fadeFrames(0),
+      volume(1.0f), crossfadeMs(0), finishSignalled(false), starved(true), refillQueued(false) {
+    // Mix in float at the device's preferred rate and channel count; the
+    // decoders are asked for the same format so no resampling happens here
+    const QAudioDevice output = QMediaDevices::defaultAudioOutput();
+    format = output.preferredFormat();
+    format.setSampleFormat(QAudioFormat::Float);
+    available = !output.isNull() && output.isFormatSupported(format);
+    if (!available) {
+        return;
+    }
+
+    const int channels = format.channelCount();
+    blockA.resize(MaxBlockFrames * channels);
+    blockB.resize(MaxBlockFrames * channels);
+    gainOut.resize(MaxBlockFrames * channels);
+    gainIn.resize(MaxBlockFrames * channels);
+
+    dsp.prepare(format.sampleRate(), channels);
+
+    sink = new QAudioSink(output, format, this);
+    device = new MixerDevice(this);
+    device->open(QIODevice::ReadOnly);
+}
+
+CrossfadeMixer::~CrossfadeMixer() {
+    if (sink) {
+        sink->stop();
+    }
+    for (Deck& deck : decks) {
+        resetDeck(deck);
+    }
+}
+
+bool CrossfadeMixer::isAvailable() const {
+    return available;
+}
+
+void CrossfadeMixer::setCrossfadeDuration(int ms) {
+    QMutexLocker locker(&mutex);
+    crossfadeMs = qBound(0, ms, MaxCrossfadeMs);
+    fadeFrames = format.framesForDuration(static_cast<qint64>(crossfadeMs) * 1000);
+}
+
+int CrossfadeMixer::crossfadeDuration() const {
+    QMutexLocker locker(&mutex);
+    return crossfadeMs;
+}
+
+void CrossfadeMixer::setVolume(float value) {
+    QMutexLocker locker(&mutex);
+    volume = value;
+}
+
+size_t CrossfadeMixer::watermarkSamples() const {
+    // Keep at least the whole fade plus half a second decoded ahead, so the
+    // fade can start as soon as a deck has finished decoding
+    const qint64 frames = fadeFrames + format.framesForDuration(500000);
+    return static_cast<size_t>(qMax<qint64>(frames, format.framesForDuration(1000000)) * format.channelCount());
+}
+
+void CrossfadeMixer::setSource(const QUrl& source, float gain) {
+    if (!available) {
+        return;
+    }
+    resetDeck(decks[0]);
+    resetDeck(decks[1]);
+    {
+        QMutexLocker locker(&mutex);
+        current = 0;
+        fading = false;
+        finishSignalled = false;
+        starved = true;
+        dsp.reset();
+    }
+    startDeck(decks[0], source, gain);
+}
+
+void CrossfadeMixer::setNextSource(const QUrl& source, float gain) {
+    if (!available) {
+        return;
+    }
+
+    int nextIndex;
+    {
+        QMutexLocker locker(&mutex);
+        // Too late to swap the incoming track in the middle of a fade
+        if (fading) {
+            return;
+        }
+        nextIndex = 1 - current;
+        if (decks[nextIndex].source == source && !decks[nextIndex].retired) {
+            decks[nextIndex].gain = gain;
+            return;
+        }
+        finishSignalled = false;
+    }
+
+    resetDeck(decks[nextIndex]);
+    startDeck(decks[nextIndex], source, gain);
+}
+
+void CrossfadeMixer::play() {
+    if (!available) {
+        return;
+    }
+    if (sink->state() == QAudio::SuspendedState) {
+        sink->resume();
+    } else if (sink->state() != QAudio::ActiveState && sink->state() != QAudio::IdleState) {
+        sink->start(device);
+    }
+}
+
+void CrossfadeMixer::pause() {
+    if (available && sink->state() == QAudio::ActiveState) {
+        sink->suspend();
+    }
+}
+
+void CrossfadeMixer::stop() {
+    if (!available) {
+        return;
+    }
+    sink->stop();
+
+    // Restart the decoders so play() begins the current track from the top
+    QUrl currentSource;
+    QUrl nextSource;
+    float currentGain;
+    float nextGain;
+    {
+        QMutexLocker locker(&mutex);
+        currentSource = decks[current].source;
+        currentGain = decks[current].gain;
+        nextSource = decks[1 - current].retired ? QUrl() : decks[1 - current].source;
+        nextGain = decks[1 - current].gain;
+    }
+    setSource(currentSource, currentGain);
+    setNextSource(nextSource, nextGain);
+}
+
+void CrossfadeMixer::clear() {
+    if (!available) {
+        return;
+    }
+    sink->stop();
+    resetDeck(decks[0]);
+    resetDeck(decks[1]);
+}
+
+bool CrossfadeMixer::isPlaying() const {
+    return available && (sink->state() == QAudio::ActiveState || sink->state() == QAudio::IdleState);
+}
+
+void CrossfadeMixer::seek(qint64 ms) {
+    if (!available) {
+        return;
+    }
+    const int channels = format.channelCount();
+    const qint64 target = format.framesForDuration(qMax<qint64>(0, ms) * 1000);
+    bool restart = false;
+    QUrl source;
+    QUrl nextSource;
+    float gain = 1.0f;
+    float nextGain = 1.0f;
+    {
+        QMutexLocker locker(&mutex);
+        Deck& deck = decks[current];
+        if (deck.source.isEmpty()) {
+            return;
+        }
+        source = deck.source;
+        gain = deck.gain;
+
+        // A fade in progress is called off; the incoming track starts over
+        Deck& next = decks[1 - current];
+        if (fading && !next.retired) {
+            nextSource = next.source;
+            nextGain = next.gain;
+        }
+        fading = false;
+        finishSignalled = false;
+        starved = true;
+        dsp.reset();
+
+        const qint64 bufferedFrom = deck.endFrame - static_cast<qint64>(deck.available()) / channels;
+        if (target >= bufferedFrom && target <= deck.endFrame) {
+            deck.readPos += static_cast<size_t>((target - bufferedFrom) * channels);
+        } else if (target > deck.endFrame) {
+            // Past the end of a finished track: the track ends right away
+            deck.readPos = deck.samples.size();
+            deck.skipFrames = deck.decodeFinished ? 0 : target - deck.endFrame;
+        } else {
+            restart = true;
+        }
+    }
+
+    if (restart) {
+        resetDeck(decks[current]);
+        startDeck(decks[current], source, gain, target);
+    }
+    if (!nextSource.isEmpty()) {
+        resetDeck(decks[1 - current]);
+        startDeck(decks[1 - current], nextSource, nextGain);
+    }
+    // Frames dropped while skipping free room below the watermark
+    scheduleRefill();
+}
+
+qint64 CrossfadeMixer::position() const {
+    QMutexLocker locker(&mutex);
+    const Deck& deck = decks[current];
+    const qint64 frame = deck.endFrame + deck.skipFrames - static_cast<qint64>(deck.available()) / format.channelCount();
+    return format.durationForFrames(frame) / 1000;
+}
+
+qint64 CrossfadeMixer::duration() const {
+    const QAudioDecoder* decoder = decks[current].decoder;
+    return decoder ? decoder->duration() : -1;
+}
+
+void CrossfadeMixer::startDeck(Deck& deck, const QUrl& source, float gain, qint64 skipFrames) {
+    if (source.isEmpty()) {
+        return;
+    }
+
+    QAudioDecoder* decoder = new QAudioDecoder(this);
+    decoder->setAudioFormat(format);
+    decoder->setSource(source);
+
+    Deck* target = &deck;
+    connect(decoder, &QAudioDecoder::bufferReady, this, [this]() { refill(); });
+    connect(decoder, &QAudioDecoder::finished, this, [this, target, decoder]() {
+        if (target->decoder == decoder) {
+            QMutexLocker locker(&mutex);
+            target->decodeFinished = true;
+            Trace::add(Trace::Counter::DecodeMs, (Trace::now() - target->decodeStart) / 1000000);
+        }
+    });
+    connect(decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), this,
+            [this, target, decoder](QAudioDecoder::Error) {
+        if (target->decoder != decoder) {
+            return;
+        }
+        {
+            // Nothing more will decode; mix() reports the failure when the
+            // deck is current and empty
+            QMutexLocker locker(&mutex);
+            target->decodeFinished = true;
+            target->failed = true;
+        }
+        emit errorOccurred("Cannot decode " + target->source.fileName() + ": " + decoder->errorString());
+    });
+
+    {
+        QMutexLocker locker(&mutex);
+        deck.decoder = decoder;
+        deck.source = source;
+        deck.gain = gain;
+        deck.endFrame = 0;
+        deck.skipFrames = skipFrames;
+        deck.decodeStart = Trace::now();
+        deck.samples.reserve(watermarkSamples());
+    }
+    decoder->start();
+}
+
+void CrossfadeMixer::resetDeck(Deck& deck) {
+    QAudioDecoder* old = nullptr;
+    {
+        QMutexLocker locker(&mutex);
+        old = deck.decoder;
+        deck.decoder = nullptr;
+        deck.source = QUrl();
+        deck.gain = 1.0f;
+        deck.samples.clear();
+        deck.readPos = 0;
+        deck.endFrame = 0;
+        deck.skipFrames = 0;
+        deck.decodeFinished = false;
+        deck.failed = false;
+        deck.retired = false;
+    }
+    if (old) {
+        old->disconnect(this);
+        old->stop();
+        old->deleteLater();
+    }
+}
+
+void CrossfadeMixer::appendBuffer(Deck& deck, const QAudioBuffer& buffer) {
+    const QAudioFormat source = buffer.format();
+    const int channels = format.channelCount();
+    const int sourceChannels = source.channelCount();
+    const qsizetype frames = buffer.frameCount();
+    if (frames <= 0 || sourceChannels <= 0) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    // Frames before a seek target are decoded only to be dropped
+    const qsizetype first = static_cast<qsizetype>(qMin<qint64>(deck.skipFrames, frames));
+    deck.skipFrames -= first;
+    deck.endFrame += frames;
+    if (first == frames) {
+        return;
+    }
+
+    // Drop the consumed front once it outweighs what is still pending
+    if (deck.readPos > deck.samples.size() / 2) {
+        deck.samples.erase(deck.samples.begin(), deck.samples.begin() + deck.readPos);
+        deck.readPos = 0;
+    }
+
+    if (source.sampleFormat() == QAudioFormat::Float && sourceChannels == channels) {
+        const float* data = buffer.constData<float>();
+        deck.samples.insert(deck.samples.end(), data + first * channels, data + frames * channels);
+        return;
+    }
+
+    // Backend ignored the requested format: convert sample by sample
+    const char* raw = buffer.constData<char>();
+    const int bytesPerSample = source.bytesPerSample();
+    for (qsizetype frame = first; frame < frames; ++frame) {
+        for (int channel = 0; channel < channels; ++channel) {
+            const int from = qMin(channel, sourceChannels - 1);
+            deck.samples.push_back(source.normalizedSampleValue(raw + (frame * sourceChannels + from) * bytesPerSample));
+        }
+    }
+}
+
+void CrossfadeMixer::scheduleRefill() {
+    if (!refillQueued.exchange(true)) {
+        QMetaObject::invokeMethod(this, &CrossfadeMixer::refill, Qt::QueuedConnection);
+    }
+}
+
+void CrossfadeMixer::refill() {
+    refillQueued = false;
+    const size_t watermark = watermarkSamples();
+
+    for (Deck& deck : decks) {
+        // Decoders produce their next buffer only after read(), so stopping
+        // at the watermark also stops the decoding work
+        while (deck.decoder && deck.decoder->bufferAvailable()) {
+            {
+                QMutexLocker locker(&mutex);
+                if (deck.available() >= watermark) {
+                    break;
+                }
+            }
+            appendBuffer(deck, deck.decoder->read());
+        }
+    }
+}
+
+void CrossfadeMixer::switchDecks() {
+    // Called from mix() with the mutex held
+    Deck& old = decks[current];
+    old.samples.clear();
+    old.readPos = 0;
+    old.retired = true;
+    current = 1 - current;
+    fading = false;
+
+    const QUrl source = decks[current].source;
+    QMetaObject::invokeMethod(this, [this, source]() {
+        for (Deck& deck : decks) {
+            if (deck.retired) {
+                resetDeck(deck);
+            }
+        }
+        emit trackChanged(source);
+    }, Qt::QueuedConnection);
+}
+
+void CrossfadeMixer::mix(float* out, qint64 frames) {
+    TRACE_SCOPE("mixer: mix");
+    QMutexLocker locker(&mutex);
+    const int channels = format.channelCount();
+    bool needsRefill = false;
+    qint64 done = 0;
+
+    while (done < frames) {
+        float* dst = out + done * channels;
+        qint64 n = qMin(frames - done, MaxBlockFrames);
+        Deck& cur = decks[current];
+        Deck& next = decks[1 - current];
+        // A broken next track is not faded into; the current one ends
+        // normally and the owner moves on to it the usual way
+        const bool hasNext = next.decoder && !next.retired && !next.failed;
+        const bool ended = cur.decodeFinished && !cur.failed;
+        const qint64 curFrames = static_cast<qint64>(cur.available()) / channels;
+
+        if (cur.decoder && !cur.decodeFinished && cur.available() < watermarkSamples()) {
+            needsRefill = true;
+        }
+
+        // Everything left of the current track is decoded and fits in the fade
+        if (!fading && hasNext && ended && curFrames <= fadeFrames) {
+            fading = true;
+            fadePos = 0;
+            fadeLength = curFrames;
+        }
+
+        if (fading) {
+            if (fadePos >= fadeLength) {
+                switchDecks();
+                continue;
+            }
+            n = qMin(n, fadeLength - fadePos);
+            const qint64 nextFrames = static_cast<qint64>(next.available()) / channels;
+            const qint64 fromA = qMin(n, curFrames);
+            const qint64 fromB = qMin(n, nextFrames);
+            const qint64 count = n * channels;
+
+            // Gather both decks into flat blocks (zero-padded on underrun)
+            // so the mixing loop below is branch-free and vectorizable
+            std::copy(cur.data(), cur.data() + fromA * channels, blockA.begin());
+            std::fill(blockA.begin() + fromA * channels, blockA.begin() + count, 0.0f);
+            std::copy(next.data(), next.data() + fromB * channels, blockB.begin());
+            std::fill(blockB.begin() + fromB * channels, blockB.begin() + count, 0.0f);
+
+            for (qint64 i = 0; i < n; ++i) {
+                const double t = (fadePos + i + 0.5) / fadeLength;
+                const float outgoing = fadeCurve(1.0 - t) * volume * cur.gain;
+                const float incoming = fadeCurve(t) * volume * next.gain;
+                for (int c = 0; c < channels; ++c) {
+                    gainOut[i * channels + c] = outgoing;
+                    gainIn[i * channels + c] = incoming;
+                }
+            }
+            DspKernels::mixWeighted(dst, blockA.data(), gainOut.data(), blockB.data(), gainIn.data(), count);
+
+            cur.readPos += fromA * channels;
+            next.readPos += fromB * channels;
+            fadePos += n;
+            done += n;
+            needsRefill = needsRefill || fromB < n;
+            continue;
+        }
+
+        if (curFrames == 0) {
+            if (cur.failed) {
+                if (!finishSignalled) {
+                    finishSignalled = true;
+                    const QUrl source = cur.source;
+                    QMetaObject::invokeMethod(this, [this, source]() { emit trackFailed(source); },
+                                              Qt::QueuedConnection);
+                }
+                std::fill(dst, out + frames * channels, 0.0f);
+                break;
+            }
+            if (cur.decodeFinished && hasNext) {
+                // Zero-length fade: cut straight to the next track
+                switchDecks();
+                continue;
+            }
+            if (cur.decodeFinished && !finishSignalled) {
+                finishSignalled = true;
+                QMetaObject::invokeMethod(this, &CrossfadeMixer::finished, Qt::QueuedConnection);
+            }
+            // Decoding fell behind a track that was already playing
+            if (!starved && cur.decoder && !cur.decodeFinished) {
+                starved = true;
+                Trace::add(Trace::Counter::Underruns, 1);
+            }
+            // Nothing decoded yet (or nothing left): output silence
+            std::fill(dst, out + frames * channels, 0.0f);
+            break;
+        }
+
+        // Stop short of the fade start so it begins on the exact frame
+        if (hasNext && ended) {
+            n = qMin(n, curFrames - fadeFrames);
+        }
+        n = qMin(n, curFrames);
+        starved = false;
+        const qint64 count = n * channels;
+        DspKernels::copyScaled(dst, cur.data(), count, volume * cur.gain);
+        cur.readPos += count;
+        done += n;
+    }
+
+    dsp.process(out, frames);
+
+    if (needsRefill) {
+        scheduleRefill();
+    }
+}
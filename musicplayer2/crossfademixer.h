@@ -0,0 +1,141 @@
+#ifndef CROSSFADEMIXER_H
+#define CROSSFADEMIXER_H
+
+#include <QObject>
+#include <QAudioFormat>
+#include <QMutex>
+#include <QUrl>
+#include <atomic>
+#include <vector>
+#include "dspchain.h"
+
+QT_BEGIN_NAMESPACE
+class QAudioBuffer;
+class QAudioDecoder;
+class QAudioSink;
+QT_END_NAMESPACE
+
+class MixerDevice;
+
+// Decoded playback path that mixes two tracks into one QAudioSink.
+// Each track is decoded by its own QAudioDecoder ("deck") into an interleaved
+// float buffer; the sink pulls mixed blocks through mix(). When the current
+// deck has fully decoded and only the crossfade length is left, the next
+// deck is faded in with equal-power gains. A zero-length fade is a
+// sample-accurate gapless cut. Each deck carries its own gain (ReplayGain)
+// and the mixed output runs through a DspChain before reaching the sink.
+//
+// Decoders are only touched on the owner's thread. The sample buffers are
+// shared with the sink's pull callback and guarded by a mutex; decoding is
+// throttled to a watermark so memory stays bounded for long tracks.
+class CrossfadeMixer : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int MaxCrossfadeMs = 12000;
+
+    explicit CrossfadeMixer(QObject *parent = nullptr);
+    virtual ~CrossfadeMixer();
+
+    // False if the output device cannot take float samples
+    bool isAvailable() const;
+
+    void setCrossfadeDuration(int ms);
+    int crossfadeDuration() const;
+    void setVolume(float volume);
+
+    // Load the track to play; playback starts with play()
+    void setSource(const QUrl& source, float gain = 1.0f);
+    // Track to mix in when the current one ends; empty clears it
+    void setNextSource(const QUrl& source, float gain = 1.0f);
+
+    void play();
+    void pause();
+    // Stop and rewind both decks to the start of their tracks
+    void stop();
+    // Stop and drop both tracks
+    void clear();
+    bool isPlaying() const;
+
+    // Jump within the current track. Decoders cannot seek, so a target
+    // already decoded is reached at once, one further on by dropping frames
+    // as they decode, and an earlier one by restarting the decoder.
+    void seek(qint64 ms);
+    // Playback position in the current track, in ms
+    qint64 position() const;
+    // Length of the current track in ms; -1 until the decoder knows it
+    qint64 duration() const;
+
+    // Fill frames of interleaved float output; called from the sink's pull
+    void mix(float* out, qint64 frames);
+
+    const QAudioFormat& audioFormat() const { return format; }
+
+    // Processing applied to the mixed output; add stages before playback
+    DspChain& dspChain() { return dsp; }
+
+signals:
+    // The next track took over as the current one
+    void trackChanged(const QUrl& source);
+    // The current track ended with nothing queued after it
+    void finished();
+    // The current track could not be decoded; sent instead of finished or a
+    // fade into the next track, once what did decode has played
+    void trackFailed(const QUrl& source);
+    void errorOccurred(const QString& error);
+
+private:
+    struct Deck {
+        QAudioDecoder* decoder = nullptr;
+        QUrl source;
+        float gain = 1.0f;
+        std::vector<float> samples;    // Decoded, interleaved, not yet mixed
+        size_t readPos = 0;
+        qint64 endFrame = 0;           // Track frame just past the decoded samples
+        qint64 skipFrames = 0;         // Frames still to drop before a seek target
+        qint64 decodeStart = 0;        // Trace clock when the decoder started
+        bool decodeFinished = false;
+        bool failed = false;           // Decoder error; decodeFinished is set too
+        bool retired = false;          // Mixed out; waiting for owner-thread cleanup
+
+        size_t available() const { return samples.size() - readPos; }
+        const float* data() const { return samples.data() + readPos; }
+    };
+
+    void startDeck(Deck& deck, const QUrl& source, float gain, qint64 skipFrames = 0);
+    void resetDeck(Deck& deck);
+    void appendBuffer(Deck& deck, const QAudioBuffer& buffer);
+    void refill();
+    void scheduleRefill();
+    void switchDecks();
+    size_t watermarkSamples() const;
+
+    QAudioFormat format;
+    QAudioSink *sink;
+    MixerDevice *device;
+    bool available;
+
+    mutable QMutex mutex;
+    Deck decks[2];
+    int current;
+    bool fading;
+    qint64 fadePos;
+    qint64 fadeLength;
+    qint64 fadeFrames;
+    float volume;
+    int crossfadeMs;
+    bool finishSignalled;
+    // Output ran dry mid-track, or not started since a load or seek;
+    // an underrun is counted once until audio flows again
+    bool starved;
+    std::atomic<bool> refillQueued;
+    DspChain dsp;
+
+    // Preallocated per-block work buffers for the pull callback
+    std::vector<float> blockA;
+    std::vector<float> blockB;
+    std::vector<float> gainOut;
+    std::vector<float> gainIn;
+};
+
+#endif // CROSSFADEMIXER_H
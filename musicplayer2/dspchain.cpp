@@ -0,0 +1,144 @@
+#include "dspchain.h"
+#include "dspkernels.h"
+
+#include <cmath>
+
+void GainStage::prepare(int, int channelCount) {
+    channels = channelCount;
+}
+
+void GainStage::process(float* samples, qint64 frames) {
+    const float db = gainDb;
+    if (db == 0.0f) {
+        return;
+    }
+    DspKernels::scale(samples, frames * channels, std::pow(10.0f, db / 20.0f));
+}
+
+const std::array<float, EqualizerStage::BandCount>& EqualizerStage::frequencies() {
+    static const std::array<float, BandCount> bands = {
+        31.0f, 62.0f, 125.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 4000.0f, 8000.0f, 16000.0f
+    };
+    return bands;
+}
+
+EqualizerStage::EqualizerStage()
+    : enabled(false), dirty(true), sampleRate(48000), channels(2) {
+    for (std::atomic<float>& gain : gains) {
+        gain = 0.0f;
+    }
+}
+
+void EqualizerStage::setBandGain(int band, float db) {
+    if (band < 0 || band >= BandCount) {
+        return;
+    }
+    gains[band] = std::max(-MaxGainDb, std::min(db, MaxGainDb));
+    dirty = true;
+}
+
+float EqualizerStage::bandGain(int band) const {
+    if (band < 0 || band >= BandCount) {
+        return 0.0f;
+    }
+    return gains[band];
+}
+
+void EqualizerStage::prepare(int rate, int channelCount) {
+    sampleRate = rate;
+    channels = channelCount;
+    state.assign(static_cast<size_t>(BandCount) * channels * 2, 0.0f);
+    dirty = true;
+}
+
+void EqualizerStage::reset() {
+    std::fill(state.begin(), state.end(), 0.0f);
+}
+
+void EqualizerStage::updateCoefficients() {
+    // Octave-spaced bands: Q of sqrt(2) gives roughly one-octave bandwidth
+    const double q = std::sqrt(2.0);
+    const double pi = 3.14159265358979323846;
+    for (int band = 0; band < BandCount; ++band) {
+        Coefficients& c = coefficients[band];
+        const float db = gains[band];
+        const double f0 = frequencies()[band];
+        c.active = db != 0.0f && f0 < 0.45 * sampleRate;
+        if (!c.active) {
+            continue;
+        }
+
+        const double a = std::pow(10.0, db / 40.0);
+        const double w0 = 2.0 * pi * f0 / sampleRate;
+        const double alpha = std::sin(w0) / (2.0 * q);
+        const double cosw = std::cos(w0);
+        const double a0 = 1.0 + alpha / a;
+        c.b0 = static_cast<float>((1.0 + alpha * a) / a0);
+        c.b1 = static_cast<float>((-2.0 * cosw) / a0);
+        c.b2 = static_cast<float>((1.0 - alpha * a) / a0);
+        c.a1 = static_cast<float>((-2.0 * cosw) / a0);
+        c.a2 = static_cast<float>((1.0 - alpha / a) / a0);
+    }
+}
+
+void EqualizerStage::process(float* samples, qint64 frames) {
+    if (!enabled) {
+        return;
+    }
+    if (dirty.exchange(false)) {
+        updateCoefficients();
+    }
+
+    // z1/z2 decay into denormals once the input goes quiet
+    const DspKernels::DenormalsToZero denormalsToZero;
+
+    // The filters are recursive in time, so each band runs over the block
+    // channel by channel; flat bands cost nothing
+    for (int band = 0; band < BandCount; ++band) {
+        const Coefficients c = coefficients[band];
+        if (!c.active) {
+            continue;
+        }
+        for (int channel = 0; channel < channels; ++channel) {
+            float* z = state.data() + (static_cast<size_t>(band) * channels + channel) * 2;
+            float z1 = z[0];
+            float z2 = z[1];
+            float* x = samples + channel;
+            for (qint64 i = 0; i < frames; ++i, x += channels) {
+                const float in = *x;
+                const float out = c.b0 * in + z1;
+                z1 = c.b1 * in - c.a1 * out + z2;
+                z2 = c.b2 * in - c.a2 * out;
+                *x = out;
+            }
+            z[0] = z1;
+            z[1] = z2;
+        }
+    }
+}
+
+void DspChain::prepare(int rate, int channelCount) {
+    sampleRate = rate;
+    channels = channelCount;
+    for (const std::unique_ptr<DspStage>& stage : stages) {
+        stage->prepare(rate, channelCount);
+    }
+}
+
+void DspChain::process(float* samples, qint64 frames) {
+    for (qint64 done = 0; done < frames; done += MaxBlockFrames) {
+        const qint64 block = std::min(MaxBlockFrames, frames - done);
+        float* data = samples + done * channels;
+        for (const std::unique_ptr<DspStage>& stage : stages) {
+            stage->process(data, block);
+        }
+        // Boosted EQ bands and gain can push past full scale
+        DspKernels::clamp(data, block * channels, 1.0f);
+    }
+}
+
+void DspChain::reset() {
+    for (const std::unique_ptr<DspStage>& stage : stages) {
+        stage->reset();
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef DSPCHAIN_H
+#define DSPCHAIN_H
+
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// One processing step in the DSP chain. Stages work in place on interleaved
+// float blocks and run on the audio pull thread, so parameters set from the
+// GUI are stored in atomics and picked up at the next block.
+class DspStage {
+public:
+    virtual ~DspStage() {}
+
+    // Called before processing starts and whenever the format changes
+    virtual void prepare(int sampleRate, int channels) = 0;
+    virtual void process(float* samples, qint64 frames) = 0;
+    // Clear filter history, e.g. after a seek or track cut
+    virtual void reset() {}
+};
+
+// Constant gain in dB (preamp / master gain)
+class GainStage : public DspStage {
+public:
+    GainStage() : gainDb(0.0f), channels(2) {}
+
+    void setGainDb(float db) { gainDb = db; }
+    float gain() const { return gainDb; }
+
+    void prepare(int sampleRate, int channelCount) override;
+    void process(float* samples, qint64 frames) override;
+
+private:
+    std::atomic<float> gainDb;
+    int channels;
+};
+
+// Ten-band graphic equalizer built from RBJ peaking biquads in transposed
+// direct form II. Bands at 0 dB are skipped entirely.
+class EqualizerStage : public DspStage {
+public:
+    static constexpr int BandCount = 10;
+    static constexpr float MaxGainDb = 12.0f;
+
+    // Band centre frequencies in Hz
+    static const std::array<float, BandCount>& frequencies();
+
+    EqualizerStage();
+
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled; }
+    void setBandGain(int band, float db);
+    float bandGain(int band) const;
+
+    void prepare(int sampleRate, int channelCount) override;
+    void process(float* samples, qint64 frames) override;
+    void reset() override;
+
+private:
+    struct Coefficients {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+        bool active = false;
+    };
+
+    void updateCoefficients();
+
+    std::atomic<bool> enabled;
+    std::atomic<bool> dirty;
+    std::array<std::atomic<float>, BandCount> gains;
+
+    // Audio thread only
+    int sampleRate;
+    int channels;
+    std::array<Coefficients, BandCount> coefficients;
+    std::vector<float> state;   // z1, z2 per band per channel
+};
+
+// Ordered list of stages run on the mixer output in short blocks, so
+// parameter changes land within a few milliseconds and no stage ever sees
+// more than MaxBlockFrames at once
+class DspChain {
+public:
+    static constexpr qint64 MaxBlockFrames = 256;
+
+    DspChain() : sampleRate(0), channels(2) {}
+
+    // Takes ownership; returns the stage for the caller to keep as a handle.
+    // Stages must be added before audio starts flowing.
+    template <typename Stage>
+    Stage* addStage(std::unique_ptr<Stage> stage) {
+        Stage* handle = stage.get();
+        if (sampleRate > 0) {
+            handle->prepare(sampleRate, channels);
+        }
+        stages.push_back(std::move(stage));
+        return handle;
+    }
+
+    void prepare(int sampleRate, int channelCount);
+    void process(float* samples, qint64 frames);
+    void reset();
+
+private:
+    std::vector<std::unique_ptr<DspStage>> stages;
+    int sampleRate;
+    int channels;
+};
+
+#endif // DSPCHAIN_H
@@ -0,0 +1,148 @@
+#ifndef DSPKERNELS_H
+#define DSPKERNELS_H
+
+#include <QtGlobal>
+
+// Inner loops shared by the mixer and the DSP chain. The instruction set is
+// picked at compile time: AVX when the compiler targets it (CONFIG += avx2),
+// SSE on any x86-64 build, and a plain loop elsewhere or when
+// DSP_KERNELS_NO_SIMD is defined (bench/dsp uses it for a baseline). Every
+// variant finishes the tail that does not fill a whole vector with the
+// scalar loop.
+#if defined(DSP_KERNELS_NO_SIMD)
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define DSP_KERNELS_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#include <pmmintrin.h>
+#define DSP_KERNELS_SSE
+#endif
+
+namespace DspKernels {
+
+// Flushes denormal results and inputs to zero on this thread while in scope,
+// then restores the caller's mode. Recursive filters fed silence decay into
+// denormals, which are many times slower to compute with on x86. A no-op
+// where the SSE control register is not available.
+class DenormalsToZero {
+public:
+#if defined(DSP_KERNELS_AVX) || defined(DSP_KERNELS_SSE)
+    DenormalsToZero() : saved(_mm_getcsr()) {
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+        _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    }
+    ~DenormalsToZero() {
+        _mm_setcsr(saved);
+    }
+
+private:
+    unsigned int saved;
+#else
+    DenormalsToZero() {}
+#endif
+    DenormalsToZero(const DenormalsToZero&) = delete;
+    DenormalsToZero& operator=(const DenormalsToZero&) = delete;
+};
+
+// data[i] *= gain
+inline void scale(float* data, qint64 count, float gain) {
+    qint64 i = 0;
+#if defined(DSP_KERNELS_AVX)
+    const __m256 g = _mm256_set1_ps(gain);
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), g));
+    }
+#elif defined(DSP_KERNELS_SSE)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), g));
+    }
+#endif
+    for (; i < count; ++i) {
+        data[i] *= gain;
+    }
+}
+
+// dst[i] = src[i] * gain
+inline void copyScaled(float* dst, const float* src, qint64 count, float gain) {
+    qint64 i = 0;
+#if defined(DSP_KERNELS_AVX)
+    const __m256 g = _mm256_set1_ps(gain);
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+    }
+#elif defined(DSP_KERNELS_SSE)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = src[i] * gain;
+    }
+}
+
+// dst[i] = a[i] * ga[i] + b[i] * gb[i]
+inline void mixWeighted(float* dst, const float* a, const float* ga,
+                        const float* b, const float* gb, qint64 count) {
+    qint64 i = 0;
+#if defined(DSP_KERNELS_AVX)
+    for (; i + 8 <= count; i += 8) {
+        const __m256 x = _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(ga + i));
+        const __m256 y = _mm256_mul_ps(_mm256_loadu_ps(b + i), _mm256_loadu_ps(gb + i));
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(x, y));
+    }
+#elif defined(DSP_KERNELS_SSE)
+    for (; i + 4 <= count; i += 4) {
+        const __m128 x = _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(ga + i));
+        const __m128 y = _mm_mul_ps(_mm_loadu_ps(b + i), _mm_loadu_ps(gb + i));
+        _mm_storeu_ps(dst + i, _mm_add_ps(x, y));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = a[i] * ga[i] + b[i] * gb[i];
+    }
+}
+
+// dst[i] = a[i] * b[i]
+inline void multiply(float* dst, const float* a, const float* b, qint64 count) {
+    qint64 i = 0;
+#if defined(DSP_KERNELS_AVX)
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+#elif defined(DSP_KERNELS_SSE)
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = a[i] * b[i];
+    }
+}
+
+// Hard-limit samples to [-limit, limit]
+inline void clamp(float* data, qint64 count, float limit) {
+    qint64 i = 0;
+#if defined(DSP_KERNELS_AVX)
+    const __m256 hi = _mm256_set1_ps(limit);
+    const __m256 lo = _mm256_set1_ps(-limit);
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(data + i, _mm256_max_ps(lo, _mm256_min_ps(hi, _mm256_loadu_ps(data + i))));
+    }
+#elif defined(DSP_KERNELS_SSE)
+    const __m128 hi = _mm_set1_ps(limit);
+    const __m128 lo = _mm_set1_ps(-limit);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(data + i, _mm_max_ps(lo, _mm_min_ps(hi, _mm_loadu_ps(data + i))));
+    }
+#endif
+    for (; i < count; ++i) {
+        data[i] = qBound(-limit, data[i], limit);
+    }
+}
+
+} // namespace DspKernels
+
+#endif // DSPKERNELS_H
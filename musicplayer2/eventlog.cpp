@@ -0,0 +1,100 @@
+#include "eventlog.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTimeZone>
+
+EventLog::EventLog(QObject *parent)
+    : QObject(parent), wakePending(false), dropped(0), droppedReported(0),
+      maxFileBytes(DefaultMaxFileBytes), keepFiles(3) {
+}
+
+void EventLog::record(Level level, const QString& source, const QString& message) {
+    // Stamped here, on the thread where it happened
+    if (!queue.push(Event{QDateTime::currentMSecsSinceEpoch(), level, source, message})) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    // One wake-up covers everything recorded until the log starts draining
+    if (!wakePending.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &EventLog::drain, Qt::QueuedConnection);
+    }
+}
+
+void EventLog::drain() {
+    // Cleared first so an event recorded while draining wakes us again
+    wakePending.store(false, std::memory_order_release);
+    Event event;
+    while (queue.pop(event)) {
+        append(event);
+    }
+
+    const quint64 lost = dropped.load(std::memory_order_relaxed);
+    if (lost != droppedReported) {
+        append(Event{QDateTime::currentMSecsSinceEpoch(), Level::Warning, "log",
+                     QString("%1 events dropped, the log queue was full").arg(lost - droppedReported)});
+        droppedReported = lost;
+    }
+}
+
+void EventLog::append(const Event& event) {
+    history.push_back(event);
+    if (history.size() > HistorySize) {
+        history.pop_front();
+    }
+    writeToFile(event);
+    emit eventRecorded(event);
+}
+
+QString EventLog::defaultLogFile() {
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath("musicplayer.log");
+}
+
+void EventLog::setLogFile(const QString& path, qint64 maxBytes, int keep) {
+    file.close();
+    maxFileBytes = qMax<qint64>(maxBytes, 4096);
+    keepFiles = qMax(keep, 1);
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        // Keep going without the file; the event itself says why
+        append(Event{QDateTime::currentMSecsSinceEpoch(), Level::Warning, "log",
+                     "Cannot open log file " + path + ": " + file.errorString()});
+    }
+}
+
+void EventLog::writeToFile(const Event& event) {
+    if (!file.isOpen()) {
+        return;
+    }
+    if (file.size() >= maxFileBytes) {
+        rotate();
+        if (!file.isOpen()) {
+            return;
+        }
+    }
+    file.write(format(event).toUtf8() + '\n');
+    file.flush();
+}
+
+void EventLog::rotate() {
+    const QString path = file.fileName();
+    file.close();
+    QFile::remove(path + '.' + QString::number(keepFiles));
+    for (int i = keepFiles - 1; i >= 1; --i) {
+        QFile::rename(path + '.' + QString::number(i), path + '.' + QString::number(i + 1));
+    }
+    QFile::rename(path, path + ".1");
+    file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+}
+
+QString EventLog::format(const Event& event) {
+    static const char* const levels[] = {"INFO", "WARN", "ERROR"};
+    return QString("%1 %2 [%3] %4")
+        .arg(QDateTime::fromMSecsSinceEpoch(event.timeMs, QTimeZone::UTC).toString(Qt::ISODateWithMs),
+             levels[static_cast<int>(event.level)], event.source, event.message);
+}
@@ -0,0 +1,76 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <deque>
+#include "commandqueue.h"
+
+// Bounded record of errors and other notable events, with timestamps.
+// record() may be called from any thread - including a worker emitting a
+// signal connected with Qt::DirectConnection - and never blocks: it pushes
+// onto a lock-free queue (counting the event as dropped if that is full)
+// and wakes the log's own thread. There the last HistorySize events are
+// kept, appended to an optional rotating log file and announced through
+// eventRecorded.
+class EventLog : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr std::size_t QueueCapacity = 256;
+    static constexpr std::size_t HistorySize = 500;
+    static constexpr qint64 DefaultMaxFileBytes = 1 << 20;
+
+    enum class Level : quint8 {
+        Info,
+        Warning,
+        Error
+    };
+
+    struct Event {
+        qint64 timeMs = 0;  // Since the epoch, UTC
+        Level level = Level::Info;
+        QString source;
+        QString message;
+    };
+
+    explicit EventLog(QObject *parent = nullptr);
+
+    void record(Level level, const QString& source, const QString& message);
+
+    // Also append events to path. Once it grows past maxBytes it becomes
+    // path.1 (the older ones path.2 ...), keeping at most keepFiles of them.
+    // An empty path turns the file off.
+    void setLogFile(const QString& path, qint64 maxBytes = DefaultMaxFileBytes, int keepFiles = 3);
+    static QString defaultLogFile();
+
+    // Log thread only: oldest first
+    const std::deque<Event>& events() const { return history; }
+
+    // One line per event, as written to the file
+    static QString format(const Event& event);
+
+signals:
+    void eventRecorded(const EventLog::Event& event);
+
+private:
+    void drain();
+    void append(const Event& event);
+    void writeToFile(const Event& event);
+    void rotate();
+
+    CommandQueue<Event, QueueCapacity> queue;
+    std::atomic<bool> wakePending;
+    std::atomic<quint64> dropped;
+
+    // Log thread only
+    quint64 droppedReported;
+    std::deque<Event> history;
+    QFile file;
+    qint64 maxFileBytes;
+    int keepFiles;
+};
+
+#endif // EVENTLOG_H
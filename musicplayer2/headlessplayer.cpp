@@ -0,0 +1,312 @@
+#include "headlessplayer.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <exception>
+
+namespace {
+
+// Output volume before any per-track gain
+const float DefaultVolume = 0.7f;
+
+// Give up skipping after this many unplayable tracks in a row
+const int MaxFailedInARow = 20;
+
+} // namespace
+
+HeadlessPlayer::HeadlessPlayer(QObject *parent)
+    : QObject(parent), readingPath(false), currentEntry(MusicPlaylist::InvalidId), queue(playlist),
+      playPending(false), failedInARow(0) {
+    playlistModel = new PlaylistModel(playlist, this);
+    // New entries join the shuffle order; removed ones just go stale
+    connect(playlistModel, &PlaylistModel::rowsInserted, this, [this](const QModelIndex&, int first, int last) {
+        for (int row = first; row <= last; ++row) {
+            queue.added(playlist.idAt(row));
+        }
+    });
+
+    player = new QMediaPlayer(this);
+    audioOutput = new QAudioOutput(this);
+    player->setAudioOutput(audioOutput);
+    audioOutput->setVolume(DefaultVolume);
+    connect(player, &QMediaPlayer::mediaStatusChanged, this, &HeadlessPlayer::handleMediaStatus);
+    connect(player, &QMediaPlayer::errorOccurred, this, [this](QMediaPlayer::Error, const QString& message) {
+        emit errorOccurred("Cannot play " + player->source().fileName() + ": " + message);
+        // An unattended player moves on rather than sit on a broken file
+        QMetaObject::invokeMethod(this, &HeadlessPlayer::skipFailedTrack, Qt::QueuedConnection);
+    });
+    connect(player, &QMediaPlayer::positionChanged, this, [this](qint64 ms) {
+        if (ms > 0) {
+            failedInARow = 0;
+        }
+    });
+
+    scanner = new LibraryScanner(this);
+    connect(scanner, &LibraryScanner::batchReady, this, &HeadlessPlayer::addTracks);
+    connect(scanner, &LibraryScanner::finished, this, [this]() {
+        readingPath = false;
+        startNextPath();
+    });
+
+    importer = new PlaylistImporter(this);
+    connect(importer, &PlaylistImporter::batchReady, this, &HeadlessPlayer::addTracks);
+    connect(importer, &PlaylistImporter::finished, this, [this](int, bool, const QString& error) {
+        if (!error.isEmpty()) {
+            emit errorOccurred("Import error: " + error);
+        }
+        readingPath = false;
+        startNextPath();
+    });
+
+    control = new ControlServer(*this, playlist, this);
+    control->setPlaylistHandlers(
+        [this](const QString& path) {
+            addPath(path);
+            return true;
+        },
+        [this](int row) { return removeRow(row); },
+        [this]() { return currentRow(); });
+    connect(control, &ControlServer::errorOccurred, this, &HeadlessPlayer::errorOccurred);
+}
+
+HeadlessPlayer::~HeadlessPlayer() {
+    try {
+        // Fold a long journal into a fresh library snapshot
+        if (library.needsCompaction()) {
+            library.compact(playlist);
+        }
+    } catch (...) {
+        // Catch any exceptions in destructor to prevent undefined behavior
+    }
+}
+
+void HeadlessPlayer::play() {
+    const int row = currentRow();
+    if (row < 0) {
+        // Nothing selected yet: start from the top
+        playRow(0);
+        return;
+    }
+    player->play();
+    emit statusChanged("Playing: " + playlist.getDisplayInfo(row).displayName());
+}
+
+void HeadlessPlayer::pause() {
+    player->pause();
+    emit statusChanged("Paused");
+}
+
+void HeadlessPlayer::stop() {
+    player->stop();
+    player->setPosition(0);
+    emit statusChanged("Stopped");
+}
+
+void HeadlessPlayer::setSource(const QUrl& source) {
+    try {
+        currentEntry = playlist.findId(source);
+        queue.setCurrent(currentEntry);
+        player->setSource(source);
+        audioOutput->setVolume(DefaultVolume * trackGain(currentRow()));
+    } catch (const std::exception& e) {
+        emit errorOccurred("Error setting source: " + QString(e.what()));
+    }
+}
+
+bool HeadlessPlayer::isPlaying() const {
+    return player->playbackState() == QMediaPlayer::PlayingState;
+}
+
+void HeadlessPlayer::addPath(const QString& path) {
+    pendingPaths.append(path);
+    startNextPath();
+}
+
+void HeadlessPlayer::listen(const QString& name) {
+    control->listen(name);
+}
+
+void HeadlessPlayer::playWhenReady() {
+    if (playlist.isEmpty()) {
+        playPending = true;
+    } else {
+        playRow(0);
+    }
+}
+
+void HeadlessPlayer::next() {
+    playEntry(queue.advance(true));
+}
+
+void HeadlessPlayer::previous() {
+    playEntry(queue.previous());
+}
+
+bool HeadlessPlayer::runCommand(const QString& line) {
+    const QString command = line.section(' ', 0, 0, QString::SectionSkipEmpty).toLower();
+    const QString argument = line.section(' ', 1, -1, QString::SectionSkipEmpty);
+
+    if (command == "play") {
+        play();
+    } else if (command == "pause") {
+        pause();
+    } else if (command == "stop") {
+        stop();
+    } else if (command == "next") {
+        next();
+    } else if (command == "prev") {
+        previous();
+    } else if (command == "shuffle" && (argument == "on" || argument == "off")) {
+        queue.setShuffle(argument == "on");
+    } else if (command == "repeat" && (argument == "off" || argument == "all" || argument == "one")) {
+        queue.setRepeat(argument == "one" ? PlayQueue::Repeat::One
+                        : argument == "all" ? PlayQueue::Repeat::All : PlayQueue::Repeat::Off);
+    } else if (command == "add" && !argument.isEmpty()) {
+        addPath(argument);
+    } else if (command == "list") {
+        QStringList rows;
+        rows.reserve(static_cast<qsizetype>(playlist.size()));
+        for (const TrackInfo& info : playlist.displayItems()) {
+            rows.append(QString("%1: %2").arg(rows.size() + 1).arg(info.displayName()));
+        }
+        emit statusChanged(rows.join('\n'));
+    } else if (command == "status") {
+        const int row = currentRow();
+        emit statusChanged(QString("%1 songs, %2: %3")
+                           .arg(playlist.size())
+                           .arg(isPlaying() ? "playing" : "not playing")
+                           .arg(row >= 0 ? playlist.getDisplayInfo(row).displayName() : "no song selected"));
+    } else if (command == "quit") {
+        QCoreApplication::quit();
+    } else {
+        // Blank lines are ignored
+        return command.isEmpty();
+    }
+    return true;
+}
+
+int HeadlessPlayer::currentRow() const {
+    return playlist.rowOf(currentEntry);
+}
+
+void HeadlessPlayer::playEntry(MusicPlaylist::EntryId id) {
+    const int row = playlist.rowOf(id);
+    if (row < 0) {
+        emit statusChanged("End of playlist");
+        return;
+    }
+    playRow(row);
+}
+
+void HeadlessPlayer::playRow(int row) {
+    if (row < 0 || row >= static_cast<int>(playlist.size())) {
+        emit statusChanged("Playlist is empty");
+        return;
+    }
+    setSource(playlist.getItem(row));
+    player->play();
+    emit statusChanged("Playing: " + playlist.getDisplayInfo(row).displayName());
+}
+
+bool HeadlessPlayer::removeRow(int row) {
+    const bool wasCurrent = row == currentRow();
+    if (!playlistModel->removeTrack(row)) {
+        return false;
+    }
+    if (wasCurrent) {
+        player->stop();
+        player->setSource(QUrl());
+        currentEntry = MusicPlaylist::InvalidId;
+    }
+    return true;
+}
+
+float HeadlessPlayer::trackGain(int row) const {
+    if (row < 0 || row >= static_cast<int>(playlist.size())) {
+        return 1.0f;
+    }
+
+    // Measured R128 loudness wins over tagged ReplayGain
+    const TrackInfo info = playlist.getDisplayInfo(row);
+    return info.hasLoudness ? info.loudnessGainFactor() : info.replayGainFactor();
+}
+
+void HeadlessPlayer::loadLibrary() {
+    try {
+        QElapsedTimer timer;
+        timer.start();
+
+        playlistModel->addTracks(library.load());
+        if (library.needsCompaction()) {
+            library.compact(playlist);
+        }
+        emit statusChanged(QString("Library: %1 songs loaded in %2 ms")
+                           .arg(playlist.size()).arg(timer.elapsed()));
+    } catch (const MusicPlayerException& e) {
+        emit errorOccurred("Library Error: " + QString(e.what()));
+    }
+
+    // Journal later changes so the window build sees them too
+    library.journalChanges(playlistModel, playlist, this, [this](const QString& message) {
+        emit errorOccurred("Library Error: " + message);
+    });
+}
+
+void HeadlessPlayer::addTracks(const QList<ScannedTrack>& tracks) {
+    try {
+        const int added = playlistModel->addTracks(tracks);
+        if (added > 0) {
+            emit statusChanged(QString("Added %1 songs").arg(added));
+        }
+        if (playPending && !playlist.isEmpty()) {
+            playPending = false;
+            playRow(0);
+        }
+    } catch (const std::exception& e) {
+        emit errorOccurred("Import Error: " + QString(e.what()));
+    }
+}
+
+void HeadlessPlayer::startNextPath() {
+    // Single files are added on the spot; a folder or playlist file holds
+    // the queue until its worker reports finished
+    while (!pendingPaths.isEmpty() && !readingPath) {
+        const QString path = pendingPaths.takeFirst();
+        const QFileInfo fileInfo(path);
+        if (fileInfo.isDir() || QDir::match(PlaylistImporter::playlistFilters(), fileInfo.fileName())) {
+            const bool started = fileInfo.isDir() ? scanner->scan(fileInfo.absoluteFilePath())
+                                                  : importer->import(fileInfo.absoluteFilePath());
+            if (!started) {
+                // readingPath holds the queue until the previous worker has
+                // returned, so this only happens if someone else started it
+                emit errorOccurred("Busy, cannot read: " + path);
+                continue;
+            }
+            readingPath = true;
+        } else {
+            const ScannedTrack track = LibraryScanner::validateFile(fileInfo.absoluteFilePath());
+            if (track.url.isEmpty()) {
+                emit errorOccurred("Cannot read: " + path);
+            } else {
+                addTracks({track});
+            }
+        }
+    }
+}
+
+void HeadlessPlayer::handleMediaStatus(QMediaPlayer::MediaStatus status) {
+    if (status == QMediaPlayer::EndOfMedia) {
+        playEntry(queue.advance(false));
+    }
+}
+
+void HeadlessPlayer::skipFailedTrack() {
+    if (++failedInARow > qMin(MaxFailedInARow, static_cast<int>(playlist.size()))) {
+        failedInARow = 0;
+        player->stop();
+        emit errorOccurred("Stopped: too many songs in a row could not be played");
+        return;
+    }
+    playEntry(queue.advance(true));
+}
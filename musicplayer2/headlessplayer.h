@@ -0,0 +1,98 @@
+#ifndef HEADLESSPLAYER_H
+#define HEADLESSPLAYER_H
+
+#include <QObject>
+#include <QMediaPlayer>
+#include <QAudioOutput>
+#include <QStringList>
+#include <QUrl>
+#include "controlserver.h"
+#include "iplayer.h"
+#include "libraryscanner.h"
+#include "librarystore.h"
+#include "playlistio.h"
+#include "playlistmodel.h"
+#include "playqueue.h"
+
+// Player for machines without a display: the same IPlayer operations and
+// playlist engine as the window, driven from the command line, text
+// commands or the local control socket, with status and errors reported
+// through signals. Shares the saved library with the window build (one of
+// them at a time) and advances through the playlist at the end of each
+// track. It builds without the widgets module; bench/startup/startup.sh
+// compares its startup time and peak RSS with the window build.
+class HeadlessPlayer : public QObject, public IPlayer {
+    Q_OBJECT
+
+public:
+    explicit HeadlessPlayer(QObject *parent = nullptr);
+    virtual ~HeadlessPlayer();
+
+    // Implement IPlayer interface methods
+    void play() override;
+    void pause() override;
+    void stop() override;
+    void setSource(const QUrl& source) override;
+    bool isPlaying() const override;
+
+    // Restore the saved library; call once the signals are connected
+    void loadLibrary();
+
+    // Queue an audio file, folder or playlist file for adding; folders and
+    // playlists are read in the background one at a time
+    void addPath(const QString& path);
+
+    // Accept control clients on the local socket name
+    void listen(const QString& name);
+
+    // Start the first track as soon as the playlist is non-empty
+    void playWhenReady();
+
+    void next();
+    void previous();
+
+    // Run one text command (play, pause, stop, next, prev, shuffle on|off,
+    // repeat off|all|one, add <path>, list, status, quit); returns false for
+    // unknown commands
+    bool runCommand(const QString& line);
+
+    const MusicPlaylist& tracks() const { return playlist; }
+
+signals:
+    void statusChanged(const QString& info);
+    void errorOccurred(const QString& error);
+
+private:
+    int currentRow() const;
+    void playEntry(MusicPlaylist::EntryId id);
+    void playRow(int row);
+    bool removeRow(int row);
+    float trackGain(int row) const;
+    void addTracks(const QList<ScannedTrack>& tracks);
+    void startNextPath();
+    void handleMediaStatus(QMediaPlayer::MediaStatus status);
+    void skipFailedTrack();
+
+    QMediaPlayer *player;
+    QAudioOutput *audioOutput;
+
+    MusicPlaylist playlist;
+    PlaylistModel *playlistModel;
+    LibraryStore library;
+
+    // Folders and playlist files wait here while another one is being read
+    LibraryScanner *scanner;
+    PlaylistImporter *importer;
+    QStringList pendingPaths;
+    bool readingPath;
+
+    MusicPlaylist::EntryId currentEntry;
+    PlayQueue queue;
+    bool playPending;
+    // Unplayable tracks skipped since something last played
+    int failedInARow;
+
+    ControlServer *control;
+};
+
+#endif // HEADLESSPLAYER_H
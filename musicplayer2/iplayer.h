@@ -0,0 +1,19 @@
+#ifndef IPLAYER_H
+#define IPLAYER_H
+
+#include <QUrl>
+
+// Abstract Player interface - defines pure virtual functions that any player must implement
+class IPlayer {
+public:
+    virtual ~IPlayer() {}
+    
+    // Pure virtual functions (abstract methods)
+    virtual void play() = 0;
+    virtual void pause() = 0;
+    virtual void stop() = 0;
+    virtual void setSource(const QUrl& source) = 0;
+    virtual bool isPlaying() const = 0;
+};
+
+#endif // IPLAYER_H
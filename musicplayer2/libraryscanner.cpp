@@ -0,0 +1,123 @@
+#include "libraryscanner.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <deque>
+
+LibraryScanner::LibraryScanner(QObject *parent)
+    : QObject(parent), cancelRequested(false) {
+    qRegisterMetaType<ScannedTrack>();
+    qRegisterMetaType<QList<ScannedTrack>>();
+    connect(&scanWatcher, &QFutureWatcher<bool>::finished, this, [this]() {
+        emit finished(scanTask.result());
+    });
+}
+
+LibraryScanner::~LibraryScanner() {
+    // The worker emits through this object, so it must stop before we go away
+    cancel();
+    scanTask.waitForFinished();
+    validationPool.waitForDone();
+}
+
+QStringList LibraryScanner::audioFilters() {
+    return {"*.mp3", "*.wav", "*.mp4", "*.m4a"};
+}
+
+QString LibraryScanner::audioDialogFilter() {
+    return "Audio (" + audioFilters().join(' ') + ")";
+}
+
+// Runs on the validation pool: the per-file stat is the slow part on
+// network shares, so it is spread over several threads
+ScannedTrack LibraryScanner::validateFile(const QString& path) {
+    QFileInfo fileInfo(path);
+    if (!fileInfo.exists() || !fileInfo.isReadable() || fileInfo.size() == 0) {
+        return ScannedTrack();
+    }
+    return ScannedTrack{QUrl::fromLocalFile(fileInfo.absoluteFilePath()), fileInfo.fileName()};
+}
+
+bool LibraryScanner::scan(const QString& rootPath) {
+    if (isRunning()) {
+        return false;
+    }
+    cancelRequested = false;
+    scanTask = QtConcurrent::run([this, rootPath]() { return run(rootPath); });
+    scanWatcher.setFuture(scanTask);
+    return true;
+}
+
+void LibraryScanner::cancel() {
+    cancelRequested = true;
+}
+
+bool LibraryScanner::isRunning() const {
+    return scanTask.isRunning();
+}
+
+bool LibraryScanner::run(const QString& rootPath) {
+    // Batches being validated, oldest first so results keep directory order
+    std::deque<QFuture<ScannedTrack>> pending;
+    const size_t maxPending = static_cast<size_t>(qMax(1, validationPool.maxThreadCount()));
+    int filesSeen = 0;
+    int tracksFound = 0;
+
+    // Wait for the oldest batch and hand its valid tracks to the GUI thread
+    auto flushOldest = [&]() {
+        QFuture<ScannedTrack> batch = pending.front();
+        pending.pop_front();
+        batch.waitForFinished();
+
+        QList<ScannedTrack> tracks;
+        const QList<ScannedTrack> results = batch.results();
+        for (const ScannedTrack& track : results) {
+            if (!track.url.isEmpty()) {
+                tracks.append(track);
+            }
+        }
+        tracksFound += tracks.size();
+        if (!tracks.isEmpty()) {
+            emit batchReady(tracks);
+        }
+        emit progress(filesSeen, tracksFound);
+    };
+
+    QStringList chunk;
+    chunk.reserve(BatchSize);
+
+    QDirIterator it(rootPath, audioFilters(), QDir::Files | QDir::NoDotAndDotDot,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext() && !cancelRequested) {
+        chunk.append(it.next());
+        ++filesSeen;
+
+        if (chunk.size() >= BatchSize) {
+            pending.push_back(QtConcurrent::mapped(&validationPool, chunk, validateFile));
+            chunk = QStringList();
+            chunk.reserve(BatchSize);
+            // Bound the work in flight so huge trees don't queue every path up front
+            if (pending.size() > maxPending) {
+                flushOldest();
+            }
+        }
+    }
+
+    if (!chunk.isEmpty() && !cancelRequested) {
+        pending.push_back(QtConcurrent::mapped(&validationPool, chunk, validateFile));
+    }
+
+    while (!pending.empty()) {
+        if (cancelRequested) {
+            pending.front().cancel();
+            pending.front().waitForFinished();
+            pending.pop_front();
+        } else {
+            flushOldest();
+        }
+    }
+
+    return cancelRequested;
+}
@@ -0,0 +1,68 @@
+#ifndef LIBRARYSCANNER_H
+#define LIBRARYSCANNER_H
+
+#include <QObject>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QUrl>
+#include <atomic>
+
+// A validated audio file found while scanning a folder
+struct ScannedTrack {
+    QUrl url;
+    QString name;
+    // Saved add-order position when restoring a library; 0 for new tracks
+    quint32 added = 0;
+};
+
+Q_DECLARE_METATYPE(ScannedTrack)
+
+// Walks a directory tree on a background thread, validates the audio files it
+// finds on a worker pool and reports them to the GUI thread in batches
+class LibraryScanner : public QObject {
+    Q_OBJECT
+
+public:
+    // Number of files validated and reported together
+    static constexpr int BatchSize = 256;
+
+    explicit LibraryScanner(QObject *parent = nullptr);
+    virtual ~LibraryScanner();
+
+    // Audio file patterns shared by the file dialog and the folder scan
+    static QStringList audioFilters();
+    static QString audioDialogFilter();
+
+    // The track for an existing, readable, non-empty file; empty url otherwise
+    static ScannedTrack validateFile(const QString& path);
+
+    // Start scanning rootPath recursively; ignored if a scan is running
+    bool scan(const QString& rootPath);
+
+    // Request cancellation; finished(true) is emitted once the worker stops.
+    // finished is emitted on this object's thread after the worker has
+    // returned, so isRunning() is already false in handlers connected to it.
+    void cancel();
+
+    bool isRunning() const;
+
+signals:
+    void batchReady(const QList<ScannedTrack>& tracks);
+    void progress(int filesSeen, int tracksFound);
+    void finished(bool cancelled);
+
+private:
+    // Returns whether the scan was cancelled
+    bool run(const QString& rootPath);
+
+    QFuture<bool> scanTask;
+    QFutureWatcher<bool> scanWatcher;
+    QThreadPool validationPool;
+    std::atomic<bool> cancelRequested;
+};
+
+#endif // LIBRARYSCANNER_H
@@ -0,0 +1,360 @@
+#include "librarystore.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QtEndian>
+#include <exception>
+
+namespace {
+
+const quint32 SnapshotMagic = 0x424C504D;   // "MPLB"
+const quint32 JournalMagic = 0x4A4C504D;    // "MPLJ"
+const quint32 SnapshotVersion = 2;
+const quint32 JournalVersion = 1;
+
+// Snapshot header: magic, version, generation, record count,
+// string table offset, string table length (QChars), checksum, reserved
+const qint64 HeaderSize = 8 * sizeof(quint32);
+// Record: path offset, path length, name offset, name length (in QChars),
+// add-order position (version 2; version 1 records stop before it)
+const qint64 RecordSize = 5 * sizeof(quint32);
+const qint64 RecordSizeV1 = 4 * sizeof(quint32);
+// Journal entry frame: payload size, payload checksum
+const qint64 EntryHeaderSize = sizeof(quint32) + sizeof(quint16);
+
+enum JournalOp : quint8 {
+    OpAdd = 1,
+    OpRemove = 2
+};
+
+quint32 readU32(const uchar* data, qint64 offset) {
+    return qFromLittleEndian<quint32>(data + offset);
+}
+
+void writeU32(QByteArray& buffer, qint64 offset, quint32 value) {
+    qToLittleEndian<quint32>(value, buffer.data() + offset);
+}
+
+} // namespace
+
+LibraryStore::LibraryStore(const QString& directory)
+    : directory(directory), lock(QDir(directory).filePath("library.lock")), generation(0), snapshotCount(0),
+      journalEntries(0) {
+    journal.setFileName(journalPath());
+}
+
+LibraryStore::~LibraryStore() {
+    journal.close();
+}
+
+QString LibraryStore::defaultLocation() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+}
+
+QString LibraryStore::snapshotPath() const {
+    return QDir(directory).filePath("library.bin");
+}
+
+QString LibraryStore::journalPath() const {
+    return QDir(directory).filePath("library.journal");
+}
+
+void LibraryStore::readSnapshot(QList<ScannedTrack>& tracks) {
+    // Map the whole file and read records in place
+    QFile snapshot(snapshotPath());
+    if (!snapshot.exists()) {
+        return;
+    }
+    if (!snapshot.open(QIODevice::ReadOnly)) {
+        throw MusicPlayerException("Cannot open library file: " + snapshot.errorString().toStdString());
+    }
+    const qint64 fileSize = snapshot.size();
+    const uchar* data = fileSize >= HeaderSize ? snapshot.map(0, fileSize) : nullptr;
+    const quint32 version = data ? readU32(data, 4) : 0;
+    if (!data || readU32(data, 0) != SnapshotMagic || (version != 1 && version != SnapshotVersion)) {
+        throw MusicPlayerException("Library file is not a valid playlist library");
+    }
+    const qint64 recordSize = version == 1 ? RecordSizeV1 : RecordSize;
+
+    const quint32 count = readU32(data, 12);
+    const quint64 stringsOffset = readU32(data, 16);
+    const quint64 stringsLength = readU32(data, 20);
+    if (stringsOffset != static_cast<quint64>(HeaderSize + count * recordSize)
+        || stringsOffset + stringsLength * sizeof(QChar) != static_cast<quint64>(fileSize)) {
+        throw MusicPlayerException("Library file is truncated");
+    }
+    const quint16 checksum = qChecksum(QByteArrayView(reinterpret_cast<const char*>(data) + HeaderSize,
+                                                      fileSize - HeaderSize));
+    if (checksum != readU32(data, 24)) {
+        throw MusicPlayerException("Library file is corrupt");
+    }
+
+    // The string table is stored as little-endian UTF-16, so on LE hosts
+    // QStrings are copied straight out of the mapping
+    const QChar* table = reinterpret_cast<const QChar*>(data + stringsOffset);
+    QList<QChar> swapped;
+    if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
+        swapped.reserve(static_cast<qsizetype>(stringsLength));
+        for (quint64 i = 0; i < stringsLength; ++i) {
+            swapped.append(QChar(qFromLittleEndian<quint16>(data + stringsOffset + i * sizeof(QChar))));
+        }
+        table = swapped.constData();
+    }
+    auto stringAt = [&](quint32 offset, quint32 length) {
+        if (static_cast<quint64>(offset) + length > stringsLength) {
+            throw MusicPlayerException("Library record points outside the string table");
+        }
+        return QString(table + offset, static_cast<qsizetype>(length));
+    };
+
+    tracks.reserve(static_cast<qsizetype>(count));
+    for (quint32 i = 0; i < count; ++i) {
+        const qint64 record = HeaderSize + i * recordSize;
+        QString path = stringAt(readU32(data, record), readU32(data, record + 4));
+        QString name = stringAt(readU32(data, record + 8), readU32(data, record + 12));
+        // Old libraries were always in add order
+        const quint32 added = version == 1 ? i + 1 : readU32(data, record + 16);
+        tracks.append(ScannedTrack{QUrl::fromLocalFile(path), name, added});
+    }
+
+    generation = readU32(data, 8);
+    snapshotCount = static_cast<int>(count);
+    snapshot.unmap(const_cast<uchar*>(data));
+    snapshot.close();
+}
+
+QList<ScannedTrack> LibraryStore::load() {
+    QList<ScannedTrack> tracks;
+    QDir().mkpath(directory);
+    journalEntries = 0;
+
+    // Two writers would interleave journal entries and overwrite each
+    // other's snapshots; a lock left by a crashed player is taken over
+    if (!lock.isLocked() && !lock.tryLock(0)) {
+        throw MusicPlayerException(lock.error() == QLockFile::LockFailedError
+                                       ? "Library is in use by another player; changes will not be saved"
+                                       : "Cannot lock library; changes will not be saved");
+    }
+
+    try {
+        readSnapshot(tracks);
+    } catch (const MusicPlayerException& e) {
+        // Keep the bad file for inspection and start an empty generation;
+        // its journal addresses rows of the lost snapshot, so it goes too
+        const QString aside = snapshotPath() + ".corrupt";
+        QFile::remove(aside);
+        const bool moved = QFile::rename(snapshotPath(), aside);
+        tracks.clear();
+        generation = 0;
+        snapshotCount = 0;
+        resetJournal();
+        throw MusicPlayerException(std::string(e.what()) + (moved ? "; moved to " + aside.toStdString() : "")
+                                   + "; starting an empty library");
+    }
+
+    // Journal: replay entries written since the snapshot
+    if (!journal.open(QIODevice::ReadWrite)) {
+        throw MusicPlayerException("Cannot open library journal: " + journal.errorString().toStdString()
+                                   + "; changes will not be saved");
+    }
+
+    QByteArray contents = journal.readAll();
+    const uchar* data = reinterpret_cast<const uchar*>(contents.constData());
+    if (contents.size() < 3 * static_cast<qint64>(sizeof(quint32))
+        || readU32(data, 0) != JournalMagic || readU32(data, 4) != JournalVersion
+        || readU32(data, 8) != generation) {
+        // Missing, foreign, or left over from before the last compaction
+        resetJournal();
+        return tracks;
+    }
+
+    qint64 offset = 3 * sizeof(quint32);
+    while (offset + EntryHeaderSize <= contents.size()) {
+        const quint32 size = readU32(data, offset);
+        const quint16 checksum = qFromLittleEndian<quint16>(data + offset + sizeof(quint32));
+        if (offset + EntryHeaderSize + size > contents.size()) {
+            break;  // Torn write at the end of the file
+        }
+        QByteArray payload = contents.mid(offset + EntryHeaderSize, size);
+        if (qChecksum(payload) != checksum) {
+            break;
+        }
+
+        QDataStream in(payload);
+        quint8 op;
+        in >> op;
+        if (op == OpAdd) {
+            QString path;
+            QString name;
+            in >> path >> name;
+            tracks.append(ScannedTrack{QUrl::fromLocalFile(path), name});
+        } else if (op == OpRemove) {
+            qint32 row;
+            in >> row;
+            if (row >= 0 && row < tracks.size()) {
+                tracks.removeAt(row);
+            }
+        }
+
+        offset += EntryHeaderSize + size;
+        ++journalEntries;
+    }
+
+    // Drop anything after the last complete entry so new entries follow it
+    journal.resize(offset);
+    journal.seek(offset);
+    return tracks;
+}
+
+void LibraryStore::appendEntries(const QList<QByteArray>& payloads) {
+    if (!journal.isOpen() || payloads.isEmpty()) {
+        return;
+    }
+
+    QByteArray frames;
+    for (const QByteArray& payload : payloads) {
+        QByteArray frame(EntryHeaderSize, Qt::Uninitialized);
+        writeU32(frame, 0, static_cast<quint32>(payload.size()));
+        qToLittleEndian<quint16>(qChecksum(payload), frame.data() + sizeof(quint32));
+        frames.append(frame);
+        frames.append(payload);
+    }
+
+    // One write and flush per batch; each entry keeps its own frame, so a
+    // crash leaves whole entries and at most one torn tail entry
+    if (journal.write(frames) != frames.size() || !journal.flush()) {
+        throw MusicPlayerException("Cannot write library journal: " + journal.errorString().toStdString());
+    }
+    journalEntries += static_cast<int>(payloads.size());
+}
+
+void LibraryStore::recordAdds(const MusicPlaylist& playlist, int first, int last) {
+    QList<QByteArray> payloads;
+    payloads.reserve(qMax(0, last - first + 1));
+    for (int row = first; row <= last; ++row) {
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out << static_cast<quint8>(OpAdd) << playlist.getItem(row).toLocalFile() << playlist.getDisplayInfo(row).fileName;
+        payloads.append(payload);
+    }
+    appendEntries(payloads);
+}
+
+void LibraryStore::recordRemoves(int row, int count) {
+    // Each removal shifts the rest down, so the same row repeats
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << static_cast<quint8>(OpRemove) << static_cast<qint32>(row);
+    appendEntries(QList<QByteArray>(count, payload));
+}
+
+void LibraryStore::journalChanges(const QAbstractItemModel *model, const MusicPlaylist& playlist,
+                                  const QObject *context, const std::function<void(const QString&)>& onError) {
+    auto guarded = [onError](const std::function<void()>& write) {
+        try {
+            write();
+        } catch (const std::exception& e) {
+            onError(QString(e.what()));
+        }
+    };
+
+    QObject::connect(model, &QAbstractItemModel::rowsInserted, context,
+                     [this, &playlist, guarded](const QModelIndex&, int first, int last) {
+        guarded([&]() { recordAdds(playlist, first, last); });
+    });
+    QObject::connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, context,
+                     [this, guarded](const QModelIndex&, int first, int last) {
+        guarded([&]() { recordRemoves(first, last - first + 1); });
+    });
+
+    // Journal entries address rows, so a new order needs a new snapshot;
+    // large scattered deletes reset the model, and a fresh snapshot is
+    // cheaper than journalling every row
+    auto snapshot = [this, &playlist, guarded]() {
+        guarded([&]() { compact(playlist); });
+    };
+    QObject::connect(model, &QAbstractItemModel::layoutChanged, context, snapshot);
+    QObject::connect(model, &QAbstractItemModel::modelReset, context, snapshot);
+}
+
+bool LibraryStore::needsCompaction() const {
+    return journalEntries > qMax(1024, snapshotCount / 4);
+}
+
+void LibraryStore::compact(const MusicPlaylist& playlist) {
+    if (!lock.isLocked()) {
+        return;
+    }
+    const quint32 count = static_cast<quint32>(playlist.size());
+
+    // Build the string table first so record offsets are known
+    QString strings;
+    QByteArray records(static_cast<qsizetype>(count * RecordSize), Qt::Uninitialized);
+    for (quint32 i = 0; i < count; ++i) {
+        const QString path = playlist.getItem(i).toLocalFile();
+        const QString name = playlist.getDisplayInfo(i).fileName;
+        const qint64 record = i * RecordSize;
+        writeU32(records, record, static_cast<quint32>(strings.size()));
+        writeU32(records, record + 4, static_cast<quint32>(path.size()));
+        strings.append(path);
+        writeU32(records, record + 8, static_cast<quint32>(strings.size()));
+        writeU32(records, record + 12, static_cast<quint32>(name.size()));
+        strings.append(name);
+        writeU32(records, record + 16, playlist.addedSequence(i));
+    }
+
+    QByteArray body = records;
+    const qsizetype recordBytes = body.size();
+    body.resize(recordBytes + strings.size() * static_cast<qsizetype>(sizeof(QChar)));
+    char* out = body.data() + recordBytes;
+    for (QChar c : std::as_const(strings)) {
+        qToLittleEndian<quint16>(c.unicode(), out);
+        out += sizeof(quint16);
+    }
+
+    const quint32 nextGeneration = generation + 1;
+    QByteArray header(HeaderSize, '\0');
+    writeU32(header, 0, SnapshotMagic);
+    writeU32(header, 4, SnapshotVersion);
+    writeU32(header, 8, nextGeneration);
+    writeU32(header, 12, count);
+    writeU32(header, 16, static_cast<quint32>(HeaderSize + recordBytes));
+    writeU32(header, 20, static_cast<quint32>(strings.size()));
+    writeU32(header, 24, qChecksum(body));
+
+    // QSaveFile writes to a temporary and renames, so readers only ever see
+    // the old or the new snapshot
+    QDir().mkpath(directory);
+    QSaveFile snapshot(snapshotPath());
+    if (!snapshot.open(QIODevice::WriteOnly)) {
+        throw MusicPlayerException("Cannot write library file: " + snapshot.errorString().toStdString());
+    }
+    snapshot.write(header);
+    snapshot.write(body);
+    if (!snapshot.commit()) {
+        throw MusicPlayerException("Cannot save library file: " + snapshot.errorString().toStdString());
+    }
+
+    // From here the new snapshot is authoritative; a crash before the journal
+    // is reset leaves a journal with the old generation, which load() ignores
+    generation = nextGeneration;
+    snapshotCount = static_cast<int>(count);
+    resetJournal();
+}
+
+void LibraryStore::resetJournal() {
+    journal.close();
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw MusicPlayerException("Cannot create library journal: " + journal.errorString().toStdString());
+    }
+    QByteArray header(3 * sizeof(quint32), '\0');
+    writeU32(header, 0, JournalMagic);
+    writeU32(header, 4, JournalVersion);
+    writeU32(header, 8, generation);
+    journal.write(header);
+    journal.flush();
+    journalEntries = 0;
+}
@@ -0,0 +1,73 @@
+#ifndef LIBRARYSTORE_H
+#define LIBRARYSTORE_H
+
+#include <QAbstractItemModel>
+#include <QFile>
+#include <QList>
+#include <QLockFile>
+#include <QString>
+#include <QUrl>
+#include <functional>
+#include "playlistmodel.h"
+
+// Persists the playlist between runs as two files:
+//  - library.bin: a snapshot with a fixed-width record table and a UTF-16
+//    string table, memory-mapped on load so no per-field parsing is needed
+//  - library.journal: an append-only log of adds/removes since the snapshot
+// Saves only append to the journal; compact() folds it into a new snapshot.
+// Both files carry a generation number so a crash between writing a new
+// snapshot and resetting the journal never replays stale entries.
+// library.lock keeps a second player (window and headless builds share the
+// directory) from writing the same files.
+class LibraryStore {
+public:
+    explicit LibraryStore(const QString& directory = defaultLocation());
+    ~LibraryStore();
+
+    // Per-user data directory used when none is given
+    static QString defaultLocation();
+
+    // Read the snapshot and replay the journal. A snapshot that cannot be
+    // read is renamed to library.bin.corrupt and an empty library started,
+    // so later changes are still saved; throws MusicPlayerException to
+    // report it, or if the journal cannot be opened (nothing is saved then).
+    // Also throws, without reading anything, if another player holds the
+    // library; this store then saves nothing.
+    QList<ScannedTrack> load();
+
+    // Journal the model's later changes to playlist: added and removed rows
+    // are appended, a reorder or reset writes a new snapshot. Call after
+    // load() so restored rows are not written back. Errors go to onError;
+    // the connections are dropped with context.
+    void journalChanges(const QAbstractItemModel *model, const MusicPlaylist& playlist, const QObject *context,
+                        const std::function<void(const QString&)>& onError);
+
+    // Journal playlist mutations: rows first..last added, or count rows
+    // removed at row. Each call is one write and one flush, however many
+    // rows it covers.
+    void recordAdds(const MusicPlaylist& playlist, int first, int last);
+    void recordRemoves(int row, int count);
+
+    // True once the journal has grown large relative to the snapshot
+    bool needsCompaction() const;
+
+    // Write a fresh snapshot of the playlist and start an empty journal;
+    // does nothing unless load() took the lock
+    void compact(const MusicPlaylist& playlist);
+
+private:
+    QString snapshotPath() const;
+    QString journalPath() const;
+    void readSnapshot(QList<ScannedTrack>& tracks);
+    void resetJournal();
+    void appendEntries(const QList<QByteArray>& payloads);
+
+    QString directory;
+    QLockFile lock;
+    QFile journal;
+    quint32 generation;
+    int snapshotCount;
+    int journalEntries;
+};
+
+#endif // LIBRARYSTORE_H
@@ -0,0 +1,180 @@
+#include "librarywatcher.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSettings>
+#include <QtConcurrent>
+
+namespace {
+
+const char* const RootsKey = "library/watchedFolders";
+
+} // namespace
+
+LibraryWatcher::LibraryWatcher(QObject *parent)
+    : QObject(parent) {
+    qRegisterMetaType<LibraryChanges>();
+
+    // Each event restarts the timer, so a burst is handled once it settles
+    settleTimer.setSingleShot(true);
+    settleTimer.setInterval(SettleMs);
+    connect(&watcher, &QFileSystemWatcher::directoryChanged, this, &LibraryWatcher::markDirty);
+    connect(&settleTimer, &QTimer::timeout, this, &LibraryWatcher::startRefresh);
+    connect(&refreshTask, &QFutureWatcher<Refresh>::finished, this, &LibraryWatcher::finishRefresh);
+}
+
+LibraryWatcher::~LibraryWatcher() {
+    refreshTask.waitForFinished();
+    for (QFutureWatcher<QStringList>* walk : std::as_const(walks)) {
+        walk->waitForFinished();
+    }
+}
+
+void LibraryWatcher::watch(const QString& root) {
+    const QString path = QDir::cleanPath(QFileInfo(root).absoluteFilePath());
+    for (const QString& existing : std::as_const(watchedRoots)) {
+        if (path == existing || path.startsWith(existing + '/')) {
+            return;
+        }
+    }
+    watchedRoots.append(path);
+    QSettings().setValue(RootsKey, watchedRoots);
+
+    // Listing directories is cheap next to the file scan, but still too
+    // slow for the GUI thread on large trees
+    QFutureWatcher<QStringList>* walk = new QFutureWatcher<QStringList>(this);
+    connect(walk, &QFutureWatcher<QStringList>::finished, this, [this, walk]() {
+        addDirectories(walk->result());
+        walks.removeOne(walk);
+        walk->deleteLater();
+    });
+    walk->setFuture(QtConcurrent::run(&LibraryWatcher::walkDirectories, path));
+    walks.append(walk);
+}
+
+void LibraryWatcher::restore() {
+    const QStringList saved = QSettings().value(RootsKey).toStringList();
+    for (const QString& root : saved) {
+        watch(root);
+    }
+}
+
+QStringList LibraryWatcher::roots() const {
+    return watchedRoots;
+}
+
+QStringList LibraryWatcher::walkDirectories(const QString& root) {
+    QStringList directories;
+    if (!QFileInfo(root).isDir()) {
+        return directories;
+    }
+    directories.append(root);
+    QDirIterator it(root, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        directories.append(it.next());
+    }
+    return directories;
+}
+
+void LibraryWatcher::addDirectories(const QStringList& directories) {
+    if (!directories.isEmpty()) {
+        // Paths the system refuses (watch limits, permissions) just go unwatched
+        watcher.addPaths(directories);
+    }
+}
+
+void LibraryWatcher::markDirty(const QString& directory) {
+    dirty.insert(directory);
+    settleTimer.start();
+}
+
+void LibraryWatcher::startRefresh() {
+    // A running refresh picks up the rest when it finishes
+    if (refreshTask.isRunning() || dirty.isEmpty()) {
+        return;
+    }
+    const QStringList paths = dirty.values();
+    dirty.clear();
+    const QStringList watchedList = watcher.directories();
+    const QSet<QString> watched(watchedList.begin(), watchedList.end());
+    refreshTask.setFuture(QtConcurrent::run(&LibraryWatcher::refresh, paths, watched));
+}
+
+LibraryWatcher::Refresh LibraryWatcher::refresh(const QStringList& dirty, const QSet<QString>& watched) {
+    Refresh result;
+    const QStringList filters = LibraryScanner::audioFilters();
+
+    auto listFiles = [&](const QString& directory) {
+        result.changes.listedDirectories.append(directory + '/');
+        const QDir dir(directory);
+        const QStringList names = dir.entryList(filters, QDir::Files);
+        for (const QString& name : names) {
+            ScannedTrack track = LibraryScanner::validateFile(dir.filePath(name));
+            if (!track.url.isEmpty()) {
+                result.changes.tracks.append(track);
+            }
+        }
+    };
+
+    for (const QString& directory : dirty) {
+        if (!QFileInfo(directory).isDir()) {
+            result.changes.removedDirectories.append(directory + '/');
+            continue;
+        }
+        listFiles(directory);
+
+        // Folders moved or copied in arrive as a single event on the parent
+        const QDir dir(directory);
+        const QStringList subdirectories = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        for (const QString& name : subdirectories) {
+            const QString path = dir.filePath(name);
+            if (!watched.contains(path)) {
+                const QStringList tree = walkDirectories(path);
+                for (const QString& added : tree) {
+                    result.newDirectories.append(added);
+                    listFiles(added);
+                }
+            }
+        }
+
+        // ...and folders moved out only show up as a change to the parent
+        for (const QString& path : watched) {
+            if (QFileInfo(path).path() == directory && !QFileInfo(path).isDir()) {
+                result.changes.removedDirectories.append(path + '/');
+            }
+        }
+    }
+
+    result.changes.removedDirectories.removeDuplicates();
+    return result;
+}
+
+void LibraryWatcher::finishRefresh() {
+    const Refresh result = refreshTask.result();
+    addDirectories(result.newDirectories);
+
+    // Stop watching whatever was below removed directories
+    QStringList stale;
+    const QStringList watchedList = watcher.directories();
+    for (const QString& path : watchedList) {
+        for (const QString& removed : result.changes.removedDirectories) {
+            if ((path + '/').startsWith(removed)) {
+                stale.append(path);
+                break;
+            }
+        }
+    }
+    if (!stale.isEmpty()) {
+        watcher.removePaths(stale);
+    }
+
+    if (!result.changes.listedDirectories.isEmpty() || !result.changes.removedDirectories.isEmpty()) {
+        emit changesReady(result.changes);
+    }
+
+    // Events that arrived while this refresh ran
+    if (!dirty.isEmpty()) {
+        settleTimer.start();
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef LIBRARYWATCHER_H
+#define LIBRARYWATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QList>
+#include <QMetaType>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include "libraryscanner.h"
+
+// What changed in a set of watched directories. Paths of directories end
+// in '/', matching how the playlist stores them.
+struct LibraryChanges {
+    // Directories re-listed in full; their audio files are all in tracks
+    QStringList listedDirectories;
+    // Valid audio files in the listed directories, including new subtrees
+    QList<ScannedTrack> tracks;
+    // Directories that no longer exist, along with everything below them
+    QStringList removedDirectories;
+};
+
+Q_DECLARE_METATYPE(LibraryChanges)
+
+// Keeps imported folders in sync with the disk. Every directory below a
+// watched root is registered with QFileSystemWatcher; change notifications
+// are collected until the tree has been quiet for SettleMs, then only the
+// touched directories are re-listed and validated on a background thread and
+// reported as one LibraryChanges. New subdirectories are walked and watched;
+// vanished ones are dropped. Roots are remembered in QSettings.
+//
+// Changes made while the player was not running are not detected; a folder
+// scan picks those up.
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    // Quiet period before a burst of events is processed
+    static constexpr int SettleMs = 500;
+
+    explicit LibraryWatcher(QObject *parent = nullptr);
+    virtual ~LibraryWatcher();
+
+    // Watch root and everything below it, and remember it for next time
+    void watch(const QString& root);
+
+    // Resume watching the roots saved by earlier runs
+    void restore();
+
+    QStringList roots() const;
+
+signals:
+    void changesReady(const LibraryChanges& changes);
+
+private:
+    struct Refresh {
+        LibraryChanges changes;
+        QStringList newDirectories;
+    };
+
+    void markDirty(const QString& directory);
+    void startRefresh();
+    void finishRefresh();
+    void addDirectories(const QStringList& directories);
+    static QStringList walkDirectories(const QString& root);
+    static Refresh refresh(const QStringList& dirty, const QSet<QString>& watched);
+
+    QFileSystemWatcher watcher;
+    QTimer settleTimer;
+    QSet<QString> dirty;
+    QStringList watchedRoots;
+    QFutureWatcher<Refresh> refreshTask;
+    QList<QFutureWatcher<QStringList>*> walks;
+};
+
+#endif // LIBRARYWATCHER_H
@@ -0,0 +1,158 @@
+#include "loudnessanalyzer.h"
+#include "loudnessmeter.h"
+#include "trace.h"
+
+#include <QAudioBuffer>
+#include <QAudioDecoder>
+#include <QAudioFormat>
+#include <QEventLoop>
+#include <QThread>
+#include <QTimer>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// How quickly a decode notices the run was cancelled
+const int CancelCheckMs = 100;
+
+} // namespace
+
+LoudnessAnalyzer::LoudnessAnalyzer(QObject *parent)
+    : QObject(parent), cancelRequested(false), remaining(0), completed(0), total(0) {
+    // Decoding and filtering are CPU bound: use every core
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+LoudnessAnalyzer::~LoudnessAnalyzer() {
+    cancelRequested = true;
+    pool.clear();
+    pool.waitForDone();
+}
+
+bool LoudnessAnalyzer::analyze(const QList<QUrl>& urls) {
+    if (isRunning() || urls.isEmpty()) {
+        return false;
+    }
+
+    cancelRequested = false;
+    completed = 0;
+    total = static_cast<int>(urls.size());
+    remaining = total;
+    for (const QUrl& url : urls) {
+        pool.start([this, url]() { analyzeFile(url); });
+    }
+    return true;
+}
+
+void LoudnessAnalyzer::cancel() {
+    cancelRequested = true;
+}
+
+bool LoudnessAnalyzer::isRunning() const {
+    return remaining > 0;
+}
+
+void LoudnessAnalyzer::finishOne() {
+    emit progress(++completed, total);
+    if (--remaining == 0) {
+        emit finished(cancelRequested);
+    }
+}
+
+void LoudnessAnalyzer::analyzeFile(const QUrl& url) {
+    if (cancelRequested) {
+        finishOne();
+        return;
+    }
+
+    TRACE_SCOPE("loudness: analyze");
+    const qint64 decodeStart = Trace::now();
+
+    // Ask for float; the meter handles any rate and channel count
+    QAudioFormat format;
+    format.setSampleFormat(QAudioFormat::Float);
+    format.setSampleRate(48000);
+    format.setChannelCount(2);
+
+    QAudioDecoder decoder;
+    decoder.setAudioFormat(format);
+    decoder.setSource(url);
+
+    std::unique_ptr<LoudnessMeter> meter;
+    std::vector<float> converted;
+    bool failed = false;
+    // Set by whichever handler ends the decode; the backend may report an
+    // error from inside start(), before the loop runs
+    bool done = false;
+
+    // The decoder reports through signals, so run a local loop on this worker
+    QEventLoop loop;
+    connect(&decoder, &QAudioDecoder::bufferReady, &loop, [&]() {
+        while (decoder.bufferAvailable() && !cancelRequested) {
+            const QAudioBuffer buffer = decoder.read();
+            const QAudioFormat bufferFormat = buffer.format();
+            const int channels = bufferFormat.channelCount();
+            const qint64 frames = buffer.frameCount();
+            if (frames <= 0 || channels <= 0) {
+                continue;
+            }
+            if (!meter) {
+                meter = std::make_unique<LoudnessMeter>(bufferFormat.sampleRate(), channels);
+            }
+
+            if (bufferFormat.sampleFormat() == QAudioFormat::Float) {
+                meter->addFrames(buffer.constData<float>(), frames);
+            } else {
+                const char* raw = buffer.constData<char>();
+                const int bytesPerSample = bufferFormat.bytesPerSample();
+                converted.resize(static_cast<size_t>(frames * channels));
+                for (size_t i = 0; i < converted.size(); ++i) {
+                    converted[i] = bufferFormat.normalizedSampleValue(raw + i * bytesPerSample);
+                }
+                meter->addFrames(converted.data(), frames);
+            }
+        }
+        if (cancelRequested) {
+            decoder.stop();
+            done = true;
+            loop.quit();
+        }
+    });
+    connect(&decoder, &QAudioDecoder::finished, &loop, [&]() {
+        done = true;
+        loop.quit();
+    });
+    connect(&decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), &loop,
+            [&](QAudioDecoder::Error) {
+        failed = true;
+        done = true;
+        loop.quit();
+    });
+    // Cancelling must not wait on a decoder that has stopped delivering buffers
+    QTimer cancelCheck;
+    cancelCheck.setInterval(CancelCheckMs);
+    connect(&cancelCheck, &QTimer::timeout, &loop, [&]() {
+        if (cancelRequested) {
+            decoder.stop();
+            done = true;
+            loop.quit();
+        }
+    });
+
+    decoder.start();
+    if (!done) {
+        cancelCheck.start();
+        loop.exec();
+    }
+    Trace::add(Trace::Counter::DecodeMs, (Trace::now() - decodeStart) / 1000000);
+
+    // Cancelled files are left unanalysed so a later run picks them up
+    if (!failed && !cancelRequested && meter) {
+        const double lufs = meter->hasGatedAudio() ? meter->integratedLoudness()
+                                                   : std::numeric_limits<double>::quiet_NaN();
+        emit trackAnalyzed(url, lufs, meter->truePeak());
+    }
+    finishOne();
+}
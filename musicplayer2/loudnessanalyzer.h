@@ -0,0 +1,47 @@
+#ifndef LOUDNESSANALYZER_H
+#define LOUDNESSANALYZER_H
+
+#include <QObject>
+#include <QList>
+#include <QThreadPool>
+#include <QUrl>
+#include <atomic>
+
+// Batch EBU R128 analysis: decodes files in parallel, one per core, and
+// reports integrated loudness and true peak per track. Results are meant to
+// be stored with the track (see TrackInfo) so playback applies the gain
+// without analysing anything at runtime.
+class LoudnessAnalyzer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LoudnessAnalyzer(QObject *parent = nullptr);
+    virtual ~LoudnessAnalyzer();
+
+    // Queue urls for analysis; returns false if a batch is already running
+    bool analyze(const QList<QUrl>& urls);
+
+    // Skip the files not started yet; finished(true) follows
+    void cancel();
+
+    bool isRunning() const;
+
+signals:
+    // integratedLufs is NaN for a track with nothing above the -70 LUFS gate:
+    // analysed, but there is no loudness to normalize
+    void trackAnalyzed(const QUrl& url, double integratedLufs, double truePeakDb);
+    void progress(int done, int total);
+    void finished(bool cancelled);
+
+private:
+    void analyzeFile(const QUrl& url);
+    void finishOne();
+
+    QThreadPool pool;
+    std::atomic<bool> cancelRequested;
+    std::atomic<int> remaining;
+    std::atomic<int> completed;
+    int total;
+};
+
+#endif // LOUDNESSANALYZER_H
@@ -0,0 +1,165 @@
+#include "loudnessmeter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double Pi = 3.14159265358979323846;
+
+// Absolute gate of the integrated loudness
+const double AbsoluteGateLufs = -70.0;
+
+double toLufs(double meanSquare) {
+    return -0.691 + 10.0 * std::log10(std::max(meanSquare, 1e-20));
+}
+
+// 4x oversampling, 12 taps per phase (48-tap windowed sinc)
+const int Oversample = 4;
+const int TapsPerPhase = 12;
+
+const std::vector<float>& interpolationTaps() {
+    static const std::vector<float> taps = [] {
+        const int length = Oversample * TapsPerPhase;
+        std::vector<float> values(length);
+        for (int i = 0; i < length; ++i) {
+            const double x = (i - (length - 1) / 2.0) / Oversample;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(Pi * x) / (Pi * x);
+            const double window = 0.5 - 0.5 * std::cos(2.0 * Pi * (i + 0.5) / length);
+            values[i] = static_cast<float>(sinc * window);
+        }
+        return values;
+    }();
+    return taps;
+}
+
+} // namespace
+
+LoudnessMeter::LoudnessMeter(int rate, int channelCount)
+    : sampleRate(rate), channels(channelCount), stepEnergy(0.0), stepPos(0), stepsSeen(0), peak(0.0) {
+    // K-weighting filter coefficients for any sample rate (BS.1770 stage 1
+    // high shelf and stage 2 RLB high-pass), derived from their analog prototypes
+    {
+        const double f0 = 1681.974450955533;
+        const double gain = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(Pi * f0 / sampleRate);
+        const double vh = std::pow(10.0, gain / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        shelf = {(vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0,
+                 (vh - vb * k / q + k * k) / a0, 2.0 * (k * k - 1.0) / a0,
+                 (1.0 - k / q + k * k) / a0};
+    }
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(Pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+        highpass = {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+    }
+
+    filterState.assign(static_cast<size_t>(channels) * 4, 0.0);
+    stepHistory.assign(4, 0.0);
+    stepFrames = std::max<qint64>(1, sampleRate / 10);
+    history.assign(static_cast<size_t>(channels) * TapsPerPhase, 0.0f);
+}
+
+void LoudnessMeter::addFrames(const float* samples, qint64 frames) {
+    const std::vector<float>& taps = interpolationTaps();
+
+    for (qint64 frame = 0; frame < frames; ++frame) {
+        double weighted = 0.0;
+        for (int channel = 0; channel < channels; ++channel) {
+            const float in = samples[frame * channels + channel];
+
+            // K-weighting: two biquads in direct form II transposed
+            double* z = filterState.data() + channel * 4;
+            const double s = shelf.b0 * in + z[0];
+            z[0] = shelf.b1 * in - shelf.a1 * s + z[1];
+            z[1] = shelf.b2 * in - shelf.a2 * s;
+            const double h = highpass.b0 * s + z[2];
+            z[2] = highpass.b1 * s - highpass.a1 * h + z[3];
+            z[3] = highpass.b2 * s - highpass.a2 * h;
+
+            // BS.1770 channel weights for a 5.1 layout (L R C LFE Ls Rs):
+            // the LFE is ignored and the surrounds count 1.41x
+            double weight = 1.0;
+            if (channels >= 6) {
+                weight = channel == 3 ? 0.0 : (channel >= 4 ? 1.41 : 1.0);
+            }
+            weighted += weight * h * h;
+
+            // True peak: shift the sample in and evaluate every polyphase branch
+            float* line = history.data() + channel * TapsPerPhase;
+            std::move(line + 1, line + TapsPerPhase, line);
+            line[TapsPerPhase - 1] = in;
+            for (int phase = 0; phase < Oversample; ++phase) {
+                float value = 0.0f;
+                for (int tap = 0; tap < TapsPerPhase; ++tap) {
+                    value += line[TapsPerPhase - 1 - tap] * taps[tap * Oversample + phase];
+                }
+                peak = std::max(peak, static_cast<double>(std::fabs(value)));
+            }
+            peak = std::max(peak, static_cast<double>(std::fabs(in)));
+        }
+        stepEnergy += weighted;
+
+        if (++stepPos == stepFrames) {
+            finishBlockStep();
+        }
+    }
+}
+
+void LoudnessMeter::finishBlockStep() {
+    // Gating blocks are 400 ms long with 75% overlap, i.e. four 100 ms steps
+    std::rotate(stepHistory.begin(), stepHistory.begin() + 1, stepHistory.end());
+    stepHistory.back() = stepEnergy / stepFrames;
+    stepEnergy = 0.0;
+    stepPos = 0;
+
+    if (++stepsSeen >= 4) {
+        double sum = 0.0;
+        for (double energy : stepHistory) {
+            sum += energy;
+        }
+        blockLoudness.push_back(sum / 4.0);
+    }
+}
+
+bool LoudnessMeter::hasGatedAudio() const {
+    return std::any_of(blockLoudness.begin(), blockLoudness.end(),
+                       [](double block) { return toLufs(block) > AbsoluteGateLufs; });
+}
+
+double LoudnessMeter::integratedLoudness() const {
+    // Absolute gate at -70 LUFS
+    double sum = 0.0;
+    size_t count = 0;
+    for (double block : blockLoudness) {
+        if (toLufs(block) > AbsoluteGateLufs) {
+            sum += block;
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return AbsoluteGateLufs;
+    }
+
+    // Relative gate 10 LU below the absolute-gated loudness
+    const double relativeGate = toLufs(sum / count) - 10.0;
+    double gatedSum = 0.0;
+    size_t gatedCount = 0;
+    for (double block : blockLoudness) {
+        const double lufs = toLufs(block);
+        if (lufs > AbsoluteGateLufs && lufs > relativeGate) {
+            gatedSum += block;
+            ++gatedCount;
+        }
+    }
+    return gatedCount > 0 ? toLufs(gatedSum / gatedCount) : AbsoluteGateLufs;
+}
+
+double LoudnessMeter::truePeak() const {
+    return 20.0 * std::log10(std::max(peak, 1e-10));
+}
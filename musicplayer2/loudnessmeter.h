@@ -0,0 +1,48 @@
+#ifndef LOUDNESSMETER_H
+#define LOUDNESSMETER_H
+
+#include <QtGlobal>
+#include <vector>
+
+// EBU R128 / ITU-R BS.1770-4 measurement of one track: integrated loudness
+// with K-weighting and two-stage gating, and true peak from 4x oversampling.
+// Feed interleaved float frames with addFrames(), then read the results.
+class LoudnessMeter {
+public:
+    LoudnessMeter(int sampleRate, int channels);
+
+    void addFrames(const float* samples, qint64 frames);
+
+    // Gated integrated loudness in LUFS; -70 or lower means silence
+    double integratedLoudness() const;
+    // Whether any block passed the absolute gate, i.e. there is a loudness
+    // to normalize at all
+    bool hasGatedAudio() const;
+    // Highest inter-sample peak in dBTP
+    double truePeak() const;
+
+private:
+    struct Biquad {
+        double b0, b1, b2, a1, a2;
+    };
+
+    void finishBlockStep();
+
+    int sampleRate;
+    int channels;
+    Biquad shelf;
+    Biquad highpass;
+    std::vector<double> filterState;    // 4 per channel per filter
+    double stepEnergy;                  // Weighted energy of the current 100 ms step
+    std::vector<double> stepHistory;    // Last 4 steps for the 400 ms window
+    std::vector<double> blockLoudness;  // Mean square per gating block
+    qint64 stepFrames;
+    qint64 stepPos;
+    int stepsSeen;
+
+    // True-peak interpolation
+    std::vector<float> history;         // Last taps per channel
+    double peak;
+};
+
+#endif // LOUDNESSMETER_H
@@ -1,11 +1,140 @@
+#ifdef MUSICPLAYER_HEADLESS
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include "eventlog.h"
+#include "headlessplayer.h"
+#include "trace.h"
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <unistd.h>
+#endif
+#else
 #include <QApplication>
 #include "mainwindow.h"  // this must match your header file name exactly
+#endif
+#include <QFile>
+#include <QTimer>
+#include <cstdio>
+
+namespace {
+
+// With MUSICPLAYER_STARTUP_PROBE set, quit as soon as the event loop runs
+// and print the peak resident set size on the way out, for
+// bench/startup/startup.sh to compare the two builds
+void startupProbe(QCoreApplication& app) {
+    if (!qEnvironmentVariableIsSet("MUSICPLAYER_STARTUP_PROBE")) {
+        return;
+    }
+    QTimer::singleShot(0, &app, [&app]() {
+        QFile status("/proc/self/status");
+        if (status.open(QIODevice::ReadOnly)) {
+            // /proc files report no size, so read them in one go
+            for (const QByteArray& line : status.readAll().split('\n')) {
+                if (line.startsWith("VmHWM:")) {
+                    fprintf(stderr, "startup-probe %s\n", line.constData());
+                }
+            }
+        }
+        app.quit();
+    });
+}
+
+} // namespace
+
+#ifdef MUSICPLAYER_HEADLESS
+
+// Display-less build: no widgets, commands come from the command line and,
+// one per line, from standard input
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("MusicPlayer");  // shares the library with the window build
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Music player without a display. Reads commands from standard input: "
+                                     "play, pause, stop, next, prev, shuffle on|off, repeat off|all|one, "
+                                     "add <path>, list, status, quit.");
+    parser.addHelpOption();
+    QCommandLineOption playOption(QStringList() << "p" << "play", "Start playing once the playlist has songs.");
+    parser.addOption(playOption);
+    QCommandLineOption socketOption(QStringList() << "s" << "socket",
+                                    "Local socket name for control clients.", "name", ControlServer::defaultName());
+    parser.addOption(socketOption);
+    QCommandLineOption logOption(QStringList() << "l" << "log-file",
+                                 "Also write events to this file, rotated at 1 MiB.", "path");
+    parser.addOption(logOption);
+    QCommandLineOption traceOption(QStringList() << "t" << "trace",
+                                   "On exit, write recent timings as a Chrome trace to this file.", "path");
+    parser.addOption(traceOption);
+    parser.addPositionalArgument("paths", "Audio files, folders or playlist files to add.", "[paths...]");
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    EventLog events;
+    events.setLogFile(parser.value(logOption));
+
+    HeadlessPlayer player;
+    QObject::connect(&player, &HeadlessPlayer::statusChanged, [&out](const QString& info) {
+        out << info << Qt::endl;
+    });
+    QObject::connect(&player, &HeadlessPlayer::errorOccurred, [&err, &events](const QString& error) {
+        err << error << Qt::endl;
+        events.record(EventLog::Level::Error, "player", error);
+    });
+
+    player.loadLibrary();
+    player.listen(parser.value(socketOption));
+    for (const QString& path : parser.positionalArguments()) {
+        player.addPath(path);
+    }
+    if (parser.isSet(playOption)) {
+        player.playWhenReady();
+    }
+    if (parser.isSet(traceOption)) {
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, [&]() {
+            try {
+                Trace::exportChromeTrace(parser.value(traceOption));
+            } catch (const MusicPlayerException& e) {
+                err << e.what() << Qt::endl;
+            }
+        });
+    }
+
+#ifdef Q_OS_UNIX
+    // Unbuffered so the notifier and the reads agree on what is pending
+    QFile input;
+    input.open(STDIN_FILENO, QIODevice::ReadOnly | QIODevice::Unbuffered);
+    QSocketNotifier inputNotifier(STDIN_FILENO, QSocketNotifier::Read);
+    QObject::connect(&inputNotifier, &QSocketNotifier::activated, [&]() {
+        const QByteArray line = input.readLine();
+        if (line.isEmpty()) {
+            // End of input (e.g. started from a service manager): keep playing
+            inputNotifier.setEnabled(false);
+            return;
+        }
+        if (!player.runCommand(QString::fromUtf8(line).trimmed())) {
+            err << "Unknown command: " << line.trimmed() << Qt::endl;
+        }
+    });
+#endif
+
+    startupProbe(app);
+    return app.exec();
+}
+
+#else
 
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
+    app.setApplicationName("MusicPlayer");  // names the per-user library directory
 
     MusicPlayer window;  // Make sure the class is called MusicPlayer in mainwindow.h
     window.show();
 
+    startupProbe(app);
     return app.exec();
 }
+
+#endif
@@ -6,32 +6,153 @@
 #include <QFileDialog>
 #include <QUrl>
 #include <QDialog>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QListView>
+#include <QLineEdit>
+#include <QComboBox>
 #include <QFileInfo>
-#include <QMessageBox>
+#include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QPlainTextEdit>
+#include <QProgressDialog>
+#include <QElapsedTimer>
+#include <QSlider>
+#include <QGridLayout>
+#include <QTimer>
 #include <exception>
+#include "crossfademixer.h"
+#include "notificationbar.h"
+#include "seekbar.h"
+#include "visualizerwidget.h"
+#include "waveformview.h"
+
+namespace {
+
+// Give up skipping after this many unplayable tracks in a row
+const int MaxFailedInARow = 20;
+
+} // namespace
 
 // Constructor - now using the interface methods
-MusicPlayer::MusicPlayer(QWidget *parent) : QMainWindow(parent) {
+MusicPlayer::MusicPlayer(QWidget *parent) : QMainWindow(parent), engine(nullptr), analyzer(nullptr), queue(playlist) {
+    // First, so every error below has somewhere to go
+    events = new EventLog(this);
+    notifications = nullptr;
+    eventLogDialog = nullptr;
+    performanceDialog = nullptr;
+    performanceTimer = nullptr;
+    failedInARow = 0;
+    connect(events, &EventLog::eventRecorded, this, &MusicPlayer::notifyEvent);
+    
     try {
-        // Initialize current song index
-        currentSongIndex = -1;
+        // No current song yet
+        currentEntry = MusicPlaylist::InvalidId;
+        equalizerDialog = nullptr;
+        analyzedSinceSave = 0;
+        scanProgress = nullptr;
+        scanAdded = 0;
+        importAdded = 0;
         
-        // Create media player with audio output
-        player = new QMediaPlayer(this);
-        if (!player) {
-            throw MusicPlayerException("Failed to create media player");
-        }
+        // Shared model over the playlist storage for all list views
+        playlistModel = new PlaylistModel(playlist, this);
+        // Sorting keeps the current track but changes the one that follows
+        connect(playlistModel, &PlaylistModel::layoutChanged, this, &MusicPlayer::prepareNextTrack);
+        // New entries join the shuffle order; removed ones just go stale
+        connect(playlistModel, &PlaylistModel::rowsInserted, this, [this](const QModelIndex&, int first, int last) {
+            if (queue.isShuffled()) {
+                for (int row = first; row <= last; ++row) {
+                    queue.added(playlist.idAt(row));
+                }
+            }
+        });
         
-        audioOutput = new QAudioOutput(this);
-        if (!audioOutput) {
-            throw MusicPlayerException("Failed to create audio output");
-        }
+        // Tag reading runs on the cache's own pool
+        metadata = new MetadataCache(MetadataCache::defaultLocation(), this);
+        connect(metadata, &MetadataCache::metadataReady, this, &MusicPlayer::applyMetadata);
         
-        player->setAudioOutput(audioOutput);
-        audioOutput->setVolume(0.7); // 70% volume
+        // Playback runs on the engine's own thread; this window only sends
+        // it commands and follows its track changes
+        analyzer = new SpectrumAnalyzer();
+        engine = new PlayerEngine(analyzer);
+        connect(engine, &PlayerEngine::trackChanged, this, &MusicPlayer::handleTrackChanged);
+        connect(engine, &PlayerEngine::endOfMedia, this, &MusicPlayer::handleEndOfMedia);
+        connect(engine, &PlayerEngine::mediaFailed, this, &MusicPlayer::handleMediaFailed);
+        connect(engine, &PlayerEngine::positionChanged, this, [this](qint64 ms) {
+            if (ms > 0) {
+                failedInARow = 0;
+            }
+        });
+        // Logged straight from the engine thread, stamped when it happened
+        connect(engine, &PlayerEngine::errorOccurred, this, [this](const QString& error) {
+            events->record(EventLog::Level::Error, "engine", error);
+        }, Qt::DirectConnection);
+        
+        // Waveform overviews are decoded once and then read from disk
+        waveforms = new WaveformCache(WaveformCache::defaultLocation(), this);
+        connect(waveforms, &WaveformCache::waveformReady, this, [this](const QUrl& url, const WaveformPtr& waveform) {
+            waveformView->setWaveform(url, waveform);
+        });
+        connect(waveforms, &WaveformCache::errorOccurred, this, [this](const QString& error) {
+            events->record(EventLog::Level::Warning, "waveform", error);
+        }, Qt::DirectConnection);
+        
+        // Loudness analysis runs on its own pool and reports per track
+        loudness = new LoudnessAnalyzer(this);
+        connect(loudness, &LoudnessAnalyzer::trackAnalyzed, this, &MusicPlayer::applyLoudness);
+        connect(loudness, &LoudnessAnalyzer::progress, this, [this](int done, int total) {
+            updateDisplay(QString("Analyzing loudness: %1/%2").arg(done).arg(total));
+        });
+        connect(loudness, &LoudnessAnalyzer::finished, this, &MusicPlayer::finishLoudnessAnalysis);
+        
+        // Folder scanner reports back to the GUI thread through queued signals
+        scanner = new LibraryScanner(this);
+        connect(scanner, &LibraryScanner::batchReady, this, &MusicPlayer::addScannedTracks);
+        connect(scanner, &LibraryScanner::progress, this, &MusicPlayer::updateScanProgress);
+        connect(scanner, &LibraryScanner::finished, this, &MusicPlayer::finishScan);
+        
+        // Folders scanned earlier are re-listed as they change on disk
+        watcher = new LibraryWatcher(this);
+        connect(watcher, &LibraryWatcher::changesReady, this, &MusicPlayer::applyLibraryChanges);
+        
+        // Playlist files are parsed off the GUI thread and added in batches
+        importer = new PlaylistImporter(this);
+        connect(importer, &PlaylistImporter::batchReady, this, [this](const QList<ScannedTrack>& tracks) {
+            try {
+                importAdded += playlistModel->addTracks(tracks);
+            } catch (const std::exception& e) {
+                importer->cancel();
+                handleError("Import Error: " + QString(e.what()));
+            }
+        });
+        connect(importer, &PlaylistImporter::progress, this, [this](qint64 bytesRead, qint64 totalBytes) {
+            if (totalBytes > 0) {
+                updateDisplay(QString("Importing playlist: %1%").arg(bytesRead * 100 / totalBytes));
+            }
+        });
+        connect(importer, &PlaylistImporter::finished, this, &MusicPlayer::finishImport);
         
         // Create UI elements through the interface method
         createControls();
+        
+        // Restore the saved playlist
+        loadLibrary();
+        watcher->restore();
+        
+        // Control clients are served on their own thread; only complete
+        // requests reach this one
+        control = new ControlServer(*this, playlist, this);
+        control->setPlaylistHandlers(
+            [this](const QString& path) { return addPath(path); },
+            [this](int row) { return removeSongs({row}); },
+            [this]() { return currentRow(); });
+        connect(control, &ControlServer::errorOccurred, this, [this](const QString& error) {
+            events->record(EventLog::Level::Warning, "control", error);
+        });
+        control->listen();
     } catch (const MusicPlayerException& e) {
         handleError("Music Player Error: " + QString(e.what()));
     } catch (const std::exception& e) {
@@ -42,28 +163,29 @@ MusicPlayer::MusicPlayer(QWidget *parent) : QMainWindow(parent) {
 // Implementation of IPlayer interface methods
 void MusicPlayer::play() {
     try {
-        player->play();
-        updateDisplay("Playing: " + (currentSongIndex >= 0 ? 
-                     playlist.getDisplayInfo(currentSongIndex) : "No song selected"));
+        TRACE_SCOPE("ui: play");
+        engine->play();
+        const int row = currentRow();
+        updateDisplay("Playing: " + (row >= 0 ? 
+                     playlist.getDisplayInfo(row).displayName() : "No song selected"));
     } catch (const std::exception& e) {
         handleError("Play error: " + QString(e.what()));
     }
 }
 
 void MusicPlayer::pause() {
-    player->pause();
+    engine->pause();
     updateDisplay("Paused");
 }
 
 void MusicPlayer::stop() {
     try {
-        // Stop playback
-        player->stop();
+        // Stop playback and rewind to the beginning
+        engine->stop();
         
-        // Reset position to beginning
-        if (currentSongIndex >= 0) {
-            player->setPosition(0);
-            updateDisplay("Stopped: " + playlist.getDisplayInfo(currentSongIndex));
+        const int row = currentRow();
+        if (row >= 0) {
+            updateDisplay("Stopped: " + playlist.getDisplayInfo(row).displayName());
         } else {
             updateDisplay("Stopped");
         }
@@ -74,17 +196,23 @@ void MusicPlayer::stop() {
 
 void MusicPlayer::setSource(const QUrl& source) {
     try {
-        player->setSource(source);
-        // Find the index of this song in the playlist
-        currentSongIndex = playlist.findItem(source);
-        updateDisplay("Ready to play: " + playlist.getDisplayInfo(currentSongIndex));
+        TRACE_SCOPE("ui: setSource");
+        // Find this song in the playlist
+        currentEntry = playlist.findId(source);
+        queue.setCurrent(currentEntry);
+        const int row = currentRow();
+        
+        engine->setSource(source, trackGain(row));
+        prepareNextTrack();
+        showWaveform(source);
+        updateDisplay("Ready to play: " + playlist.getDisplayInfo(row).displayName());
     } catch (const std::exception& e) {
         handleError("Error setting source: " + QString(e.what()));
     }
 }
 
 bool MusicPlayer::isPlaying() const {
-    return player->playbackState() == QMediaPlayer::PlayingState;
+    return engine->isPlaying();
 }
 
 // Implementation of IPlayerUI interface methods
@@ -95,17 +223,70 @@ void MusicPlayer::createControls() {
     
     // Create buttons
     loadButton = new QPushButton("Load Music");
+    scanButton = new QPushButton("Scan Folder");
     playButton = new QPushButton("Play");
     pauseButton = new QPushButton("Pause");
     stopButton = new QPushButton("Stop");
+    previousButton = new QPushButton("Previous");
+    nextButton = new QPushButton("Next");
+    shuffleCheck = new QCheckBox("Shuffle");
+    repeatCombo = new QComboBox();
+    repeatCombo->addItem("Repeat off", static_cast<int>(PlayQueue::Repeat::Off));
+    repeatCombo->addItem("Repeat all", static_cast<int>(PlayQueue::Repeat::All));
+    repeatCombo->addItem("Repeat one", static_cast<int>(PlayQueue::Repeat::One));
+    QHBoxLayout *queueRow = new QHBoxLayout();
+    queueRow->addWidget(previousButton);
+    queueRow->addWidget(nextButton);
+    queueRow->addWidget(shuffleCheck);
+    queueRow->addWidget(repeatCombo);
     playlistButton = new QPushButton("Song Playlist");
+    importButton = new QPushButton("Import Playlist...");
+    exportButton = new QPushButton("Export Playlist...");
+    gaplessCheck = new QCheckBox("Gapless playback");
+    replayGainCheck = new QCheckBox("ReplayGain");
+    loudnessCheck = new QCheckBox("Loudness normalize (R128)");
+    analyzeButton = new QPushButton("Analyze Loudness");
+    equalizerButton = new QPushButton("Equalizer...");
+    equalizerButton->setEnabled(engine->isMixerAvailable());
+    
+    // Crossfade length in seconds; 0 plays through QMediaPlayer
+    crossfadeSpin = new QSpinBox();
+    crossfadeSpin->setRange(0, CrossfadeMixer::MaxCrossfadeMs / 1000);
+    crossfadeSpin->setSuffix(" s");
+    crossfadeSpin->setEnabled(engine->isMixerAvailable());
+    QHBoxLayout *crossfadeRow = new QHBoxLayout();
+    crossfadeRow->addWidget(new QLabel("Crossfade"));
+    crossfadeRow->addWidget(crossfadeSpin);
+    
+    visualizer = new VisualizerWidget(analyzer);
+    waveformView = new WaveformView();
+    seekBar = new SeekBar();
+    notifications = new NotificationBar();
+    eventLogButton = new QPushButton("Event Log...");
+    performanceButton = new QPushButton("Performance...");
     
     // Add buttons to layout
+    layout->addWidget(notifications);
+    layout->addWidget(visualizer);
+    layout->addWidget(waveformView);
+    layout->addWidget(seekBar);
     layout->addWidget(loadButton);
+    layout->addWidget(scanButton);
     layout->addWidget(playButton);
     layout->addWidget(pauseButton);
     layout->addWidget(stopButton);
+    layout->addLayout(queueRow);
     layout->addWidget(playlistButton);
+    layout->addWidget(importButton);
+    layout->addWidget(exportButton);
+    layout->addWidget(gaplessCheck);
+    layout->addLayout(crossfadeRow);
+    layout->addWidget(replayGainCheck);
+    layout->addWidget(loudnessCheck);
+    layout->addWidget(analyzeButton);
+    layout->addWidget(equalizerButton);
+    layout->addWidget(eventLogButton);
+    layout->addWidget(performanceButton);
     // Setup main window
     setCentralWidget(central);
     setWindowTitle("Music Player");
@@ -113,14 +294,49 @@ void MusicPlayer::createControls() {
     
     // Connect button signals to functions
     connect(loadButton, &QPushButton::clicked, this, &MusicPlayer::loadSong);
+    connect(scanButton, &QPushButton::clicked, this, &MusicPlayer::scanFolder);
     connect(playButton, &QPushButton::clicked, this, &MusicPlayer::play);
     connect(pauseButton, &QPushButton::clicked, this, &MusicPlayer::pause);
     connect(stopButton, &QPushButton::clicked, this, &MusicPlayer::stop);
+    connect(previousButton, &QPushButton::clicked, this, &MusicPlayer::playPrevious);
+    connect(nextButton, &QPushButton::clicked, this, &MusicPlayer::playNext);
+    connect(shuffleCheck, &QCheckBox::toggled, this, [this](bool on) {
+        queue.setShuffle(on);
+        prepareNextTrack();
+    });
+    connect(repeatCombo, &QComboBox::currentIndexChanged, this, [this]() {
+        queue.setRepeat(static_cast<PlayQueue::Repeat>(repeatCombo->currentData().toInt()));
+        prepareNextTrack();
+    });
     connect(playlistButton, &QPushButton::clicked, this, &MusicPlayer::showPlaylist);
+    connect(importButton, &QPushButton::clicked, this, &MusicPlayer::importPlaylist);
+    connect(exportButton, &QPushButton::clicked, this, &MusicPlayer::exportPlaylist);
+    connect(gaplessCheck, &QCheckBox::toggled, this, [this](bool on) {
+        engine->setGapless(on);
+        prepareNextTrack();
+    });
+    connect(equalizerButton, &QPushButton::clicked, this, &MusicPlayer::showEqualizer);
+    connect(replayGainCheck, &QCheckBox::toggled, this, [this]() {
+        updateDisplay("ReplayGain applies from the next song");
+    });
+    connect(loudnessCheck, &QCheckBox::toggled, this, [this]() {
+        updateDisplay("Loudness normalization applies from the next song");
+    });
+    connect(analyzeButton, &QPushButton::clicked, this, &MusicPlayer::analyzeLoudness);
+    connect(crossfadeSpin, &QSpinBox::valueChanged, this, [this](int seconds) {
+        engine->setCrossfadeDuration(seconds * 1000);
+    });
+    connect(eventLogButton, &QPushButton::clicked, this, &MusicPlayer::showEventLog);
+    connect(performanceButton, &QPushButton::clicked, this, &MusicPlayer::showPerformance);
+    connect(notifications, &NotificationBar::detailsRequested, this, &MusicPlayer::showEventLog);
+    connect(seekBar, &SeekBar::seekRequested, engine, &PlayerEngine::seek, Qt::DirectConnection);
+    connect(engine, &PlayerEngine::positionChanged, seekBar, &SeekBar::setPosition);
+    connect(engine, &PlayerEngine::durationChanged, seekBar, &SeekBar::setDuration);
 }
 
 void MusicPlayer::showPlaylist() {
     try {
+        const qint64 openStart = Trace::now();
         // Create a simple dialog
         QDialog dialog(this);
         dialog.setWindowTitle("Song Playlist");
@@ -129,22 +345,79 @@ void MusicPlayer::showPlaylist() {
         // Create layout
         QVBoxLayout* layout = new QVBoxLayout(&dialog);
         
-        // Create list widget
-        QListWidget* list = new QListWidget(&dialog);
-        layout->addWidget(list);
+        // Filters the list as you type; an empty box shows the whole playlist
+        QLineEdit* searchBox = new QLineEdit(&dialog);
+        searchBox->setPlaceholderText("Search title, artist, album or file");
+        searchBox->setClearButtonEnabled(true);
+        layout->addWidget(searchBox);
         
-        // Get all song names from template
-        if (!playlist.isEmpty()) {
-            // Use template to get display items
-            std::vector<QString> displayItems = playlist.getAllDisplayItems();
-            for (const QString& name : displayItems) {
-                list->addItem(name);
-            }
-            
-            // Set current selection
-            if (currentSongIndex >= 0 && currentSongIndex < static_cast<int>(playlist.size())) {
-                list->setCurrentRow(currentSongIndex);
+        // Sort presets; later keys break ties of earlier ones
+        QHBoxLayout* sortRow = new QHBoxLayout();
+        sortRow->addWidget(new QLabel("Sort by", &dialog));
+        QComboBox* sortCombo = new QComboBox(&dialog);
+        sortCombo->addItem("Name");
+        sortCombo->addItem("Artist, album, name");
+        sortCombo->addItem("Album, name");
+        sortCombo->addItem("Duration");
+        sortCombo->addItem("Date added");
+        sortRow->addWidget(sortCombo, 1);
+        QCheckBox* descendingCheck = new QCheckBox("Descending", &dialog);
+        sortRow->addWidget(descendingCheck);
+        QPushButton* sortButton = new QPushButton("Sort", &dialog);
+        sortRow->addWidget(sortButton);
+        layout->addLayout(sortRow);
+        
+        connect(sortButton, &QPushButton::clicked, &dialog, [this, sortCombo, descendingCheck]() {
+            try {
+                static const QList<QList<SortField>> presets = {
+                    {SortField::Name},
+                    {SortField::Artist, SortField::Album, SortField::Name},
+                    {SortField::Album, SortField::Name},
+                    {SortField::Duration, SortField::Name},
+                    {SortField::DateAdded}
+                };
+                QList<SortKey> keys;
+                for (SortField field : presets.value(sortCombo->currentIndex())) {
+                    keys.append(SortKey{field, !descendingCheck->isChecked()});
+                }
+                
+                QElapsedTimer timer;
+                timer.start();
+                playlistModel->sortTracks(keys);
+                // In playlist order a different song now follows
+                prepareNextTrack();
+                updateDisplay(QString("Sorted %1 songs in %2 ms").arg(playlist.size()).arg(timer.elapsed()));
+            } catch (const std::exception& e) {
+                handleError("Sort Error: " + QString(e.what()));
             }
+        });
+        
+        // Shown instead of rows while the playlist is empty
+        QLabel* emptyLabel = new QLabel("No songs added yet", &dialog);
+        layout->addWidget(emptyLabel);
+        
+        // The view reads rows straight from the shared model; with uniform
+        // item sizes it only queries the rows that are visible
+        QListView* list = new QListView(&dialog);
+        list->setModel(playlistModel);
+        list->setUniformItemSizes(true);
+        list->setSelectionMode(QAbstractItemView::ExtendedSelection);
+        layout->addWidget(list);
+        
+        PlaylistSearchModel* results = new PlaylistSearchModel(playlistModel, &dialog);
+        connect(searchBox, &QLineEdit::textChanged, &dialog, [list, results, this](const QString& text) {
+            results->setQuery(text);
+            list->setModel(text.isEmpty() ? static_cast<QAbstractItemModel*>(playlistModel) : results);
+        });
+        
+        // Playlist row of a view row, whichever model the view shows
+        auto sourceRow = [list, results](int row) {
+            return list->model() == results ? results->sourceRow(row) : row;
+        };
+        
+        // Set current selection
+        if (currentRow() >= 0) {
+            list->setCurrentIndex(playlistModel->index(currentRow()));
         }
         
         // Add Play button
@@ -155,17 +428,21 @@ void MusicPlayer::showPlaylist() {
         QPushButton* deleteButton = new QPushButton("Delete Selected", &dialog);
         layout->addWidget(deleteButton);
         
-        // Disable play button if no songs
-        if (playlist.isEmpty()) {
-            list->addItem("No songs added yet");
-            playButton->setEnabled(false);
-            deleteButton->setEnabled(false);
-        }
+        // Disable buttons while there are no songs
+        auto updateEmptyState = [this, emptyLabel, playButton, deleteButton]() {
+            bool empty = playlist.isEmpty();
+            emptyLabel->setVisible(empty);
+            playButton->setEnabled(!empty);
+            deleteButton->setEnabled(!empty);
+        };
+        updateEmptyState();
+        connect(playlistModel, &PlaylistModel::rowsRemoved, &dialog, updateEmptyState);
+        connect(playlistModel, &PlaylistModel::rowsInserted, &dialog, updateEmptyState);
         
         // Connect play button - with exception handling
-        connect(playButton, &QPushButton::clicked, &dialog, [this, list, &dialog]() {
+        connect(playButton, &QPushButton::clicked, &dialog, [this, list, sourceRow, &dialog]() {
             try {
-                int row = list->currentRow();
+                int row = sourceRow(list->currentIndex().row());
                 if (row >= 0 && row < static_cast<int>(playlist.size())) {
                     // Use template to get the media item
                     QUrl mediaUrl = playlist.getItem(row);
@@ -180,38 +457,18 @@ void MusicPlayer::showPlaylist() {
             }
         });
         
-        // Connect delete button - delete the selected song
-        connect(deleteButton, &QPushButton::clicked, &dialog, [this, list, &dialog]() {
-            try {
-                int row = list->currentRow();
-                if (row >= 0 && row < static_cast<int>(playlist.size())) {
-                    // Get the song name before removing
-                    QString songName = playlist.getDisplayInfo(row);
-                    
-                    // Remove from playlist
-                    playlist.removeAt(row);
-                    
-                    // Update current song index if needed
-                    if (row == currentSongIndex) {
-                        // Song being played was deleted
-                        player->stop();
-                        currentSongIndex = -1;
-                    } else if (row < currentSongIndex) {
-                        // A song before current was deleted, adjust index
-                        currentSongIndex--;
-                    }
-                    
-                    updateDisplay("Deleted: " + songName);
-                    
-                    // Refresh the playlist dialog
-                    dialog.accept();
-                    showPlaylist();
-                }
-            } catch (const std::exception& e) {
-                handleError("Error deleting song: " + QString(e.what()));
+        // Connect delete button - the model removes the rows from the open view
+        connect(deleteButton, &QPushButton::clicked, &dialog, [this, list, sourceRow]() {
+            std::vector<int> rows;
+            for (const QModelIndex& index : list->selectionModel()->selectedIndexes()) {
+                rows.push_back(sourceRow(index.row()));
             }
+            removeSongs(rows);
         });
         
+        // Time to build the view; the modal loop itself is not counted
+        Trace::record("ui: open playlist", openStart, Trace::now() - openStart);
+        
         // Show dialog
         dialog.exec();
     } catch (const std::exception& e) {
@@ -224,8 +481,105 @@ void MusicPlayer::updateDisplay(const QString& info) {
 }
 
 void MusicPlayer::handleError(const QString& error) {
-    QMessageBox::critical(this, "Error", error);
-    updateDisplay("Error: " + error);
+    // Never a modal box: an unattended player must not wait for a click
+    events->record(EventLog::Level::Error, "player", error);
+}
+
+void MusicPlayer::notifyEvent(const EventLog::Event& event) {
+    if (event.level == EventLog::Level::Info || !notifications) {
+        return;
+    }
+    notifications->notify(event);
+    updateDisplay((event.level == EventLog::Level::Error ? "Error: " : "Warning: ") + event.message);
+}
+
+void MusicPlayer::showEventLog() {
+    // Built once; stays up to date while open
+    if (!eventLogDialog) {
+        eventLogDialog = new QDialog(this);
+        eventLogDialog->setWindowTitle("Event Log");
+        eventLogDialog->resize(600, 300);
+        
+        QVBoxLayout* layout = new QVBoxLayout(eventLogDialog);
+        QPlainTextEdit* text = new QPlainTextEdit(eventLogDialog);
+        text->setReadOnly(true);
+        text->setMaximumBlockCount(static_cast<int>(EventLog::HistorySize));
+        for (const EventLog::Event& event : events->events()) {
+            text->appendPlainText(EventLog::format(event));
+        }
+        layout->addWidget(text);
+        connect(events, &EventLog::eventRecorded, text, [text](const EventLog::Event& event) {
+            text->appendPlainText(EventLog::format(event));
+        });
+        
+        QCheckBox* fileCheck = new QCheckBox("Also write to " + EventLog::defaultLogFile(), eventLogDialog);
+        layout->addWidget(fileCheck);
+        connect(fileCheck, &QCheckBox::toggled, this, [this](bool on) {
+            events->setLogFile(on ? EventLog::defaultLogFile() : QString());
+        });
+    }
+    
+    eventLogDialog->show();
+    eventLogDialog->raise();
+}
+
+void MusicPlayer::showPerformance() {
+    // Built once; refreshed only while visible
+    if (!performanceDialog) {
+        performanceDialog = new QDialog(this);
+        performanceDialog->setWindowTitle("Performance");
+        
+        QGridLayout* grid = new QGridLayout(performanceDialog);
+        const char* const names[] = {"Tracks loaded", "Decode time", "Underruns", "Time to first audio"};
+        for (int i = 0; i < static_cast<int>(Trace::Counter::Count); ++i) {
+            counterLabels[i] = new QLabel(performanceDialog);
+            grid->addWidget(new QLabel(names[i], performanceDialog), i, 0);
+            grid->addWidget(counterLabels[i], i, 1, Qt::AlignRight);
+        }
+        
+        QPushButton* exportButton = new QPushButton("Export Trace...", performanceDialog);
+        exportButton->setEnabled(Trace::Enabled);
+        grid->addWidget(exportButton, grid->rowCount(), 0, 1, 2);
+        connect(exportButton, &QPushButton::clicked, this, &MusicPlayer::exportTrace);
+        
+        performanceTimer = new QTimer(performanceDialog);
+        performanceTimer->setInterval(500);
+        connect(performanceTimer, &QTimer::timeout, this, &MusicPlayer::updatePerformance);
+        connect(performanceDialog, &QDialog::finished, performanceTimer, &QTimer::stop);
+    }
+    
+    updatePerformance();
+    performanceTimer->start();
+    performanceDialog->show();
+    performanceDialog->raise();
+}
+
+void MusicPlayer::updatePerformance() {
+    using Trace::Counter;
+    counterLabels[static_cast<int>(Counter::TracksLoaded)]->setText(
+        QString::number(Trace::value(Counter::TracksLoaded)));
+    counterLabels[static_cast<int>(Counter::DecodeMs)]->setText(
+        QString::number(Trace::value(Counter::DecodeMs) / 1000.0, 'f', 1) + " s");
+    counterLabels[static_cast<int>(Counter::Underruns)]->setText(
+        QString::number(Trace::value(Counter::Underruns)));
+    counterLabels[static_cast<int>(Counter::TimeToFirstAudioMs)]->setText(
+        QString::number(Trace::value(Counter::TimeToFirstAudioMs)) + " ms");
+}
+
+void MusicPlayer::exportTrace() {
+    QString file = QFileDialog::getSaveFileName(performanceDialog,
+        "Export Trace",
+        "musicplayer-trace.json",
+        "Chrome trace (*.json)");
+    if (file.isEmpty()) {
+        return;
+    }
+    try {
+        Trace::exportChromeTrace(file);
+        updateDisplay("Trace written to " + QFileInfo(file).fileName());
+    } catch (const MusicPlayerException& e) {
+        handleError("Trace Export Error: " + QString(e.what()));
+    }
 }
 
 void MusicPlayer::loadSong() {
@@ -234,7 +588,7 @@ void MusicPlayer::loadSong() {
         QString file = QFileDialog::getOpenFileName(this, 
             "Select Music File", 
             "", 
-            "Audio (*.mp3 *.wav *.mp4 *.m4a)");
+            LibraryScanner::audioDialogFilter());
         
         // If a file was selected
         if (!file.isEmpty()) {
@@ -251,10 +605,10 @@ void MusicPlayer::loadSong() {
                 // Get filename for display
                 QString name = fileInfo.fileName();
                 
-                // Add to playlist using template method
-                if (playlist.addItem(url, name)) {
-                    // If new song added, update current index
-                    currentSongIndex = playlist.findItem(url);
+                // Add to playlist through the model so open views update
+                if (playlistModel->addTrack(url, name)) {
+                    // If new song added, make it current
+                    currentEntry = playlist.findId(url);
                 }
                 
                 // Set as current source
@@ -275,6 +629,7 @@ void MusicPlayer::loadSong() {
 
 void MusicPlayer::deleteSong() {
     try {
+        const qint64 openStart = Trace::now();
         // If no songs in playlist, nothing to delete
         if (playlist.isEmpty()) {
             updateDisplay("No songs to delete");
@@ -289,19 +644,15 @@ void MusicPlayer::deleteSong() {
         // Create layout
         QVBoxLayout* layout = new QVBoxLayout(&dialog);
         
-        // Create list widget
-        QListWidget* list = new QListWidget(&dialog);
+        // List view over the shared playlist model
+        QListView* list = new QListView(&dialog);
+        list->setModel(playlistModel);
+        list->setUniformItemSizes(true);
         layout->addWidget(list);
         
-        // Get all song names from template
-        std::vector<QString> displayItems = playlist.getAllDisplayItems();
-        for (const QString& name : displayItems) {
-            list->addItem(name);
-        }
-        
         // Set current selection if exists
-        if (currentSongIndex >= 0 && currentSongIndex < static_cast<int>(playlist.size())) {
-            list->setCurrentRow(currentSongIndex);
+        if (currentRow() >= 0) {
+            list->setCurrentIndex(playlistModel->index(currentRow()));
         }
         
         // Add Delete button
@@ -310,36 +661,517 @@ void MusicPlayer::deleteSong() {
         
         // Connect delete button
         connect(deleteButton, &QPushButton::clicked, &dialog, [this, list, &dialog]() {
-            int row = list->currentRow();
-            if (row >= 0 && row < static_cast<int>(playlist.size())) {
-                try {
-                    // Get the song name before removing
-                    QString songName = playlist.getDisplayInfo(row);
-                    
-                    // Remove from playlist
-                    playlist.removeAt(row);
-                    
-                    // Update current song index if needed
-                    if (row == currentSongIndex) {
-                        // Song being played was deleted
-                        player->stop();
-                        currentSongIndex = -1;
-                    } else if (row < currentSongIndex) {
-                        // A song before current was deleted, adjust index
-                        currentSongIndex--;
-                    }
-                    
-                    updateDisplay("Deleted: " + songName);
-                    dialog.accept();
-                } catch (const std::exception& e) {
-                    handleError("Error deleting song: " + QString(e.what()));
-                }
+            if (removeSongs({list->currentIndex().row()})) {
+                dialog.accept();
             }
         });
         
+        Trace::record("ui: open delete dialog", openStart, Trace::now() - openStart);
+        
         // Show dialog
         dialog.exec();
     } catch (const std::exception& e) {
         handleError("Error showing delete dialog: " + QString(e.what()));
     }
 }
+
+int MusicPlayer::currentRow() const {
+    return playlist.rowOf(currentEntry);
+}
+
+bool MusicPlayer::removeSongs(const std::vector<int>& rows) {
+    try {
+        TRACE_SCOPE("ui: removeSongs");
+        if (rows.empty()) {
+            return false;
+        }
+        
+        // Get the song name before removing
+        QString songName;
+        if (rows.size() == 1) {
+            if (rows.front() < 0 || rows.front() >= static_cast<int>(playlist.size())) {
+                return false;
+            }
+            songName = playlist.getDisplayInfo(rows.front()).displayName();
+        }
+        
+        // Remove through the model so open views drop just these rows
+        const int removed = playlistModel->removeTracks(rows);
+        if (removed == 0) {
+            return false;
+        }
+        
+        // The current song keeps its id, so only its own removal matters
+        if (currentEntry != MusicPlaylist::InvalidId && !playlist.isValid(currentEntry)) {
+            engine->clear();
+            currentEntry = MusicPlaylist::InvalidId;
+        }
+        
+        // The pre-rolled next song may have been one of those removed
+        prepareNextTrack();
+        
+        updateDisplay(songName.isEmpty() ? QString("Deleted %1 songs").arg(removed) : "Deleted: " + songName);
+        return true;
+    } catch (const std::exception& e) {
+        handleError("Error deleting song: " + QString(e.what()));
+    }
+    return false;
+}
+
+void MusicPlayer::prepareNextTrack() {
+    try {
+        // The engine pre-rolls (or crossfades into) whatever the queue
+        // plays next, so its decoder is already open when the current
+        // track ends
+        const MusicPlaylist::EntryId next = queue.peekNext();
+        const int row = playlist.rowOf(next);
+        engine->setNextSource(row >= 0 ? playlist.getItem(row) : QUrl(), trackGain(row));
+    } catch (const std::exception& e) {
+        handleError("Error preparing next song: " + QString(e.what()));
+    }
+}
+
+void MusicPlayer::handleEndOfMedia() {
+    // Nothing was pre-rolled, e.g. the playlist changed since; switch the
+    // normal way
+    playEntry(queue.advance(false));
+}
+
+void MusicPlayer::handleTrackChanged(const QUrl& source) {
+    try {
+        // The engine moved on to what the queue promised; anything else
+        // (a stale pre-roll) becomes the current entry as is
+        const MusicPlaylist::EntryId id = playlist.findId(source);
+        if (id != MusicPlaylist::InvalidId && id == queue.peekNext()) {
+            queue.advance(false);
+        } else {
+            queue.setCurrent(id);
+        }
+        currentEntry = id;
+        prepareNextTrack();
+        showWaveform(source);
+        const int row = currentRow();
+        if (row >= 0) {
+            updateDisplay("Playing: " + playlist.getDisplayInfo(row).displayName());
+        }
+    } catch (const std::exception& e) {
+        handleError("Error advancing playlist: " + QString(e.what()));
+    }
+}
+
+void MusicPlayer::showWaveform(const QUrl& source) {
+    waveformView->setSource(source);
+    waveforms->request(source);
+}
+
+void MusicPlayer::handleMediaFailed(const QUrl& source) {
+    // The error itself is already logged; move past the track unless every
+    // recent one failed too (e.g. the output device went away)
+    if (playlist.findId(source) != currentEntry) {
+        return;
+    }
+    if (++failedInARow > qMin(MaxFailedInARow, static_cast<int>(playlist.size()))) {
+        failedInARow = 0;
+        events->record(EventLog::Level::Warning, "player", "Stopped: too many songs in a row could not be played");
+        return;
+    }
+    playEntry(queue.advance(true));
+}
+
+void MusicPlayer::playNext() {
+    playEntry(queue.advance(true));
+}
+
+void MusicPlayer::playPrevious() {
+    playEntry(queue.previous());
+}
+
+void MusicPlayer::playEntry(MusicPlaylist::EntryId id) {
+    try {
+        const int row = playlist.rowOf(id);
+        if (row < 0) {
+            updateDisplay("End of playlist");
+            return;
+        }
+        setSource(playlist.getItem(row));
+        play();
+    } catch (const std::exception& e) {
+        handleError("Error advancing playlist: " + QString(e.what()));
+    }
+}
+
+float MusicPlayer::trackGain(int index) const {
+    if (index < 0 || index >= static_cast<int>(playlist.size())) {
+        return 1.0f;
+    }
+    
+    // Measured R128 loudness wins over tagged ReplayGain
+    const TrackInfo info = playlist.getDisplayInfo(index);
+    if (loudnessCheck->isChecked() && info.hasLoudness) {
+        return info.loudnessGainFactor();
+    }
+    if (replayGainCheck->isChecked()) {
+        return info.replayGainFactor();
+    }
+    return 1.0f;
+}
+
+void MusicPlayer::analyzeLoudness() {
+    try {
+        if (loudness->isRunning()) {
+            loudness->cancel();
+            return;
+        }
+        
+        // Only tracks without results; results for changed files were
+        // dropped with their cached tags, so this also resumes a cancelled run
+        QList<QUrl> urls;
+        for (size_t i = 0; i < playlist.size(); ++i) {
+            if (!playlist.getDisplayInfo(i).hasLoudness) {
+                urls.append(playlist.getItem(i));
+            }
+        }
+        
+        if (urls.isEmpty()) {
+            updateDisplay("All songs already analyzed");
+            return;
+        }
+        
+        loudness->analyze(urls);
+        analyzeButton->setText("Cancel Analysis");
+    } catch (const std::exception& e) {
+        handleError("Loudness Analysis Error: " + QString(e.what()));
+    }
+}
+
+void MusicPlayer::applyLoudness(const QUrl& url, double integratedLufs, double truePeakDb) {
+    try {
+        int row = playlist.findItem(url);
+        if (row < 0) {
+            return;
+        }
+        
+        TrackInfo info = playlist.getDisplayInfo(row);
+        info.hasLoudness = true;
+        info.loudnessLufs = static_cast<float>(integratedLufs);
+        info.truePeakDb = static_cast<float>(truePeakDb);
+        playlistModel->setTrackInfo(row, info);
+        metadata->store(url, info);
+        
+        // Save now and then so an interrupted run resumes close to where it stopped
+        if (++analyzedSinceSave >= 100) {
+            analyzedSinceSave = 0;
+            metadata->save();
+        }
+    } catch (const std::exception& e) {
+        handleError("Loudness Analysis Error: " + QString(e.what()));
+    }
+}
+
+void MusicPlayer::finishLoudnessAnalysis(bool cancelled) {
+    analyzeButton->setText("Analyze Loudness");
+    try {
+        analyzedSinceSave = 0;
+        metadata->save();
+    } catch (const std::exception& e) {
+        handleError("Loudness Analysis Error: " + QString(e.what()));
+    }
+    updateDisplay(cancelled ? "Loudness analysis cancelled" : "Loudness analysis finished");
+}
+
+void MusicPlayer::showEqualizer() {
+    // Built once and kept around so the settings survive closing it
+    if (!equalizerDialog) {
+        TRACE_SCOPE("ui: build equalizer");
+        equalizerDialog = new QDialog(this);
+        equalizerDialog->setWindowTitle("Equalizer");
+        
+        QVBoxLayout* layout = new QVBoxLayout(equalizerDialog);
+        QCheckBox* enableCheck = new QCheckBox("Enable equalizer", equalizerDialog);
+        layout->addWidget(enableCheck);
+        
+        // One vertical slider per band plus the preamp, in dB
+        QGridLayout* grid = new QGridLayout();
+        auto addSlider = [&](int column, const QString& label, float value) {
+            QSlider* slider = new QSlider(Qt::Vertical, equalizerDialog);
+            slider->setRange(static_cast<int>(-EqualizerStage::MaxGainDb), static_cast<int>(EqualizerStage::MaxGainDb));
+            slider->setValue(static_cast<int>(value));
+            grid->addWidget(slider, 0, column, Qt::AlignHCenter);
+            grid->addWidget(new QLabel(label, equalizerDialog), 1, column, Qt::AlignHCenter);
+            return slider;
+        };
+        
+        QSlider* preampSlider = addSlider(0, "Pre", engine->preamp()->gain());
+        connect(preampSlider, &QSlider::valueChanged, this, [this](int db) {
+            engine->preamp()->setGainDb(static_cast<float>(db));
+        });
+        for (int band = 0; band < EqualizerStage::BandCount; ++band) {
+            const float hz = EqualizerStage::frequencies()[band];
+            QString label = hz >= 1000.0f ? QString("%1k").arg(hz / 1000.0f) : QString::number(hz);
+            QSlider* slider = addSlider(band + 1, label, engine->equalizer()->bandGain(band));
+            connect(slider, &QSlider::valueChanged, this, [this, band](int db) {
+                engine->equalizer()->setBandGain(band, static_cast<float>(db));
+            });
+        }
+        layout->addLayout(grid);
+        
+        connect(enableCheck, &QCheckBox::toggled, this, [this](bool on) {
+            engine->equalizer()->setEnabled(on);
+            // Turning it on for a song playing through QMediaPlayer needs
+            // the decoded path, which is picked per song
+            if (on && !engine->usesMixer()) {
+                updateDisplay("Equalizer applies from the next song");
+            }
+        });
+    }
+    
+    equalizerDialog->show();
+    equalizerDialog->raise();
+}
+
+void MusicPlayer::loadLibrary() {
+    try {
+        QElapsedTimer timer;
+        timer.start();
+        
+        playlistModel->addTracks(library.load());
+        if (library.needsCompaction()) {
+            library.compact(playlist);
+        }
+        
+        // Cached tags come back without touching unchanged files
+        QList<QUrl> urls;
+        urls.reserve(static_cast<qsizetype>(playlist.size()));
+        for (size_t i = 0; i < playlist.size(); ++i) {
+            urls.append(playlist.getItem(i));
+        }
+        metadata->request(urls);
+        
+        const size_t bytesPerSong = playlist.isEmpty() ? 0 : playlist.memoryUsage() / playlist.size();
+        updateDisplay(QString("Library: %1 songs loaded in %2 ms (%3 bytes per song)")
+                      .arg(playlist.size()).arg(timer.elapsed()).arg(bytesPerSong));
+    } catch (const MusicPlayerException& e) {
+        handleError("Library Error: " + QString(e.what()));
+    }
+    
+    // Journal every later mutation
+    library.journalChanges(playlistModel, playlist, this, [this](const QString& message) {
+        handleError("Library Error: " + message);
+    });
+
+    // New rows need their tags read
+    connect(playlistModel, &PlaylistModel::rowsInserted, this, [this](const QModelIndex&, int first, int last) {
+        QList<QUrl> urls;
+        for (int row = first; row <= last; ++row) {
+            urls.append(playlist.getItem(row));
+        }
+        metadata->request(urls);
+    });
+}
+
+void MusicPlayer::applyMetadata(const QList<TrackMetadata>& results) {
+    for (const TrackMetadata& result : results) {
+        // The track may have been removed while its tags were being read
+        int row = playlist.findItem(result.url);
+        if (row >= 0) {
+            playlistModel->setTrackInfo(row, result.info);
+        }
+    }
+}
+
+void MusicPlayer::scanFolder() {
+    try {
+        if (scanner->isRunning()) {
+            updateDisplay("A folder scan is already running");
+            return;
+        }
+
+        QString folder = QFileDialog::getExistingDirectory(this, "Select Music Folder");
+        if (folder.isEmpty()) {
+            return;
+        }
+
+        scanAdded = 0;
+
+        // Non-modal progress so the window stays usable while the scan runs;
+        // the worker does not know the total up front, so show a busy bar
+        scanProgress = new QProgressDialog("Scanning " + folder + "...", "Cancel", 0, 0, this);
+        scanProgress->setWindowTitle("Scan Folder");
+        scanProgress->setAttribute(Qt::WA_DeleteOnClose);
+        scanProgress->setMinimumDuration(0);
+        connect(scanProgress, &QProgressDialog::canceled, scanner, &LibraryScanner::cancel);
+        scanProgress->show();
+
+        scanButton->setEnabled(false);
+        scanner->scan(folder);
+        watcher->watch(folder);
+        updateDisplay("Scanning: " + folder);
+    } catch (const std::exception& e) {
+        handleError("Folder Scan Error: " + QString(e.what()));
+    }
+}
+
+void MusicPlayer::addScannedTracks(const QList<ScannedTrack>& tracks) {
+    try {
+        scanAdded += playlistModel->addTracks(tracks);
+    } catch (const std::exception& e) {
+        scanner->cancel();
+        handleError("Import Error: " + QString(e.what()));
+    }
+}
+
+void MusicPlayer::updateScanProgress(int filesSeen, int tracksFound) {
+    if (scanProgress) {
+        scanProgress->setLabelText(QString("Checked %1 files, found %2 tracks").arg(filesSeen).arg(tracksFound));
+    }
+}
+
+void MusicPlayer::finishScan(bool cancelled) {
+    if (scanProgress) {
+        scanProgress->close();
+        scanProgress = nullptr;
+    }
+    scanButton->setEnabled(true);
+
+    QString summary = QString("Imported %1 new songs").arg(scanAdded);
+    updateDisplay(cancelled ? "Scan cancelled. " + summary : summary);
+}
+
+void MusicPlayer::applyLibraryChanges(const LibraryChanges& changes) {
+    try {
+        const TrackStorage& columns = playlist.entries();
+        const QStringList filters = LibraryScanner::audioFilters();
+        
+        // File names still present in each re-listed directory the playlist knows
+        QHash<std::uint32_t, QSet<QString>> present;
+        for (const QString& directory : changes.listedDirectories) {
+            const std::uint32_t id = columns.findDirectory(directory);
+            if (id != TrackStorage::NoDirectory) {
+                present.insert(id, QSet<QString>());
+            }
+        }
+        for (const ScannedTrack& track : changes.tracks) {
+            const QString path = track.url.toLocalFile();
+            const qsizetype cut = path.lastIndexOf('/') + 1;
+            auto it = present.find(columns.findDirectory(path.left(cut)));
+            if (it != present.end()) {
+                it->insert(path.mid(cut));
+            }
+        }
+        QSet<std::uint32_t> removed;
+        for (const QString& directory : changes.removedDirectories) {
+            for (std::uint32_t id : columns.directoriesUnder(directory)) {
+                removed.insert(id);
+            }
+        }
+        
+        // One pass over the directory column finds every entry to drop; files
+        // the listing does not cover (other extensions) are left alone
+        std::vector<int> gone;
+        for (size_t row = 0; row < playlist.size(); ++row) {
+            const std::uint32_t slot = playlist.slotAt(row);
+            const std::uint32_t directory = columns.directoryOf(slot);
+            if (removed.contains(directory)) {
+                gone.push_back(static_cast<int>(row));
+                continue;
+            }
+            auto it = present.constFind(directory);
+            if (it != present.constEnd()) {
+                const QString name = columns.pathName(slot).toString();
+                if (!it->contains(name) && QDir::match(filters, name)) {
+                    gone.push_back(static_cast<int>(row));
+                }
+            }
+        }
+        
+        // The current song is tracked by id, so removals elsewhere leave it be
+        if (!gone.empty()) {
+            removeSongs(gone);
+        }
+        const int added = playlistModel->addTracks(changes.tracks);
+        if (added > 0 || !gone.empty()) {
+            updateDisplay(QString("Library updated: %1 added, %2 removed").arg(added).arg(gone.size()));
+        }
+    } catch (const std::exception& e) {
+        handleError("Library Update Error: " + QString(e.what()));
+    }
+}
+
+bool MusicPlayer::addPath(const QString& path) {
+    // Folders and playlist files start the same background jobs as the
+    // buttons; a single file is added on the spot
+    const QFileInfo fileInfo(path);
+    if (fileInfo.isDir()) {
+        if (!scanner->scan(fileInfo.absoluteFilePath())) {
+            return false;
+        }
+        scanAdded = 0;
+        scanButton->setEnabled(false);
+        watcher->watch(fileInfo.absoluteFilePath());
+        updateDisplay("Scanning: " + fileInfo.absoluteFilePath());
+        return true;
+    }
+    if (QDir::match(PlaylistImporter::playlistFilters(), fileInfo.fileName())) {
+        if (!importer->import(fileInfo.absoluteFilePath())) {
+            return false;
+        }
+        importAdded = 0;
+        importButton->setEnabled(false);
+        updateDisplay("Importing: " + fileInfo.fileName());
+        return true;
+    }
+    
+    const ScannedTrack track = LibraryScanner::validateFile(fileInfo.absoluteFilePath());
+    return !track.url.isEmpty() && playlistModel->addTrack(track.url, track.name);
+}
+
+void MusicPlayer::importPlaylist() {
+    try {
+        if (importer->isRunning()) {
+            updateDisplay("A playlist import is already running");
+            return;
+        }
+        
+        QString file = QFileDialog::getOpenFileName(this, "Import Playlist", "", PlaylistImporter::dialogFilter());
+        if (file.isEmpty()) {
+            return;
+        }
+        
+        importAdded = 0;
+        importButton->setEnabled(false);
+        importer->import(file);
+        updateDisplay("Importing: " + QFileInfo(file).fileName());
+    } catch (const std::exception& e) {
+        handleError("Playlist Import Error: " + QString(e.what()));
+    }
+}
+
+void MusicPlayer::finishImport(int entriesRead, bool cancelled, const QString& error) {
+    importButton->setEnabled(true);
+    if (!error.isEmpty()) {
+        handleError(error);
+    }
+    
+    QString summary = QString("Imported %1 new songs from %2 entries").arg(importAdded).arg(entriesRead);
+    updateDisplay(cancelled ? "Import cancelled. " + summary : summary);
+}
+
+void MusicPlayer::exportPlaylist() {
+    try {
+        if (playlist.isEmpty()) {
+            updateDisplay("No songs to export");
+            return;
+        }
+        
+        QString file = QFileDialog::getSaveFileName(this, "Export Playlist", "playlist.m3u8",
+                                                    "M3U8 (*.m3u8);;M3U (*.m3u);;PLS (*.pls);;XSPF (*.xspf)");
+        if (file.isEmpty()) {
+            return;
+        }
+        
+        PlaylistExporter::write(file, playlist);
+        updateDisplay(QString("Exported %1 songs to %2").arg(playlist.size()).arg(QFileInfo(file).fileName()));
+    } catch (const MusicPlayerException& e) {
+        handleError("Playlist Export Error: " + QString(e.what()));
+    }
+}
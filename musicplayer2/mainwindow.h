@@ -2,117 +2,39 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QMediaPlayer>
-#include <QAudioOutput>
 #include <QUrl>
-#include <QListWidget>
-#include <exception>
-#include <string>
-#include <vector>
-#include <algorithm>
+#include "iplayer.h"
+#include "libraryscanner.h"
+#include "playlistmodel.h"
+#include "librarystore.h"
+#include "metadatacache.h"
+#include "loudnessanalyzer.h"
+#include "playlistio.h"
+#include "librarywatcher.h"
+#include "controlserver.h"
+#include "playerengine.h"
+#include "playqueue.h"
+#include "spectrumanalyzer.h"
+#include "waveformcache.h"
+#include "eventlog.h"
+#include "trace.h"
+#include <array>
 
 QT_BEGIN_NAMESPACE
+class QComboBox;
 class QPushButton;
+class QProgressDialog;
+class QCheckBox;
+class QSpinBox;
+class QDialog;
+class QLabel;
+class QTimer;
 QT_END_NAMESPACE
 
-// Custom exception class for music player errors
-class MusicPlayerException : public std::exception {
-private:
-    std::string message;
-
-public:
-    MusicPlayerException(const std::string& msg) : message(msg) {}
-    
-    virtual const char* what() const noexcept override {
-        return message.c_str();
-    }
-};
-
-// Template class for managing playlists of different media types
-template <typename MediaItem, typename DisplayInfo>
-class PlaylistManager {
-private:
-    std::vector<MediaItem> items;
-    std::vector<DisplayInfo> displayItems;
-
-public:
-    PlaylistManager() {}
-    
-    // Add an item if it doesn't already exist
-    bool addItem(const MediaItem& item, const DisplayInfo& display) {
-        // Check if item already exists
-        auto it = std::find(items.begin(), items.end(), item);
-        if (it == items.end()) {
-            items.push_back(item);
-            displayItems.push_back(display);
-            return true;
-        }
-        return false;
-    }
-    
-    // Get item at specified index
-    MediaItem getItem(size_t index) const {
-        if (index < items.size()) {
-            return items[index];
-        }
-        throw MusicPlayerException("Playlist index out of bounds");
-    }
-    
-    // Get display info at specified index
-    DisplayInfo getDisplayInfo(size_t index) const {
-        if (index < displayItems.size()) {
-            return displayItems[index];
-        }
-        throw MusicPlayerException("Playlist index out of bounds");
-    }
-    
-    // Get number of items
-    size_t size() const {
-        return items.size();
-    }
-    
-    // Check if playlist is empty
-    bool isEmpty() const {
-        return items.empty();
-    }
-    
-    // Get all display items for UI listing
-    std::vector<DisplayInfo> getAllDisplayItems() const {
-        return displayItems;
-    }
-    
-    // Find index of item
-    int findItem(const MediaItem& item) const {
-        auto it = std::find(items.begin(), items.end(), item);
-        if (it != items.end()) {
-            return static_cast<int>(std::distance(items.begin(), it));
-        }
-        return -1;
-    }
-    
-    // Remove item at index
-    bool removeAt(size_t index) {
-        if (index < items.size()) {
-            items.erase(items.begin() + index);
-            displayItems.erase(displayItems.begin() + index);
-            return true;
-        }
-        return false;
-    }
-};
-
-// Abstract Player interface - defines pure virtual functions that any player must implement
-class IPlayer {
-public:
-    virtual ~IPlayer() {}
-    
-    // Pure virtual functions (abstract methods)
-    virtual void play() = 0;
-    virtual void pause() = 0;
-    virtual void stop() = 0;
-    virtual void setSource(const QUrl& source) = 0;
-    virtual bool isPlaying() const = 0;
-};
+class NotificationBar;
+class SeekBar;
+class VisualizerWidget;
+class WaveformView;
 
 // Abstract UI interface - defines the UI operations
 class IPlayerUI {
@@ -133,8 +55,15 @@ class MusicPlayer : public QMainWindow, public IPlayer, public IPlayerUI {
 public:
     explicit MusicPlayer(QWidget *parent = nullptr);
     virtual ~MusicPlayer() {
+        // Stops playback and joins the engine thread, then the analyzer
+        // it was feeding
+        delete engine;
+        delete analyzer;
         try {
-            // Clean up resources if needed
+            // Fold a long journal into a fresh library snapshot
+            if (library.needsCompaction()) {
+                library.compact(playlist);
+            }
         } catch (...) {
             // Catch any exceptions in destructor to prevent undefined behavior
         }
@@ -154,24 +83,124 @@ public:
     void handleError(const QString& error) override;
 
 private:
-    QMediaPlayer *player;
-    QAudioOutput *audioOutput;
-    QListWidget *songListWidget;
+    // Errors and warnings from every thread; shown without blocking
+    EventLog *events;
+    NotificationBar *notifications;
+    QPushButton *eventLogButton;
+    QDialog *eventLogDialog;
+    // Unplayable tracks skipped since something last played
+    int failedInARow;
+
+    // Live counters and trace export
+    QPushButton *performanceButton;
+    QDialog *performanceDialog;
+    QTimer *performanceTimer;
+    std::array<QLabel*, static_cast<int>(Trace::Counter::Count)> counterLabels;
+
+    // Playback on its own thread; the window only sends it commands
+    PlayerEngine *engine;
+    QCheckBox *gaplessCheck;
+    QSpinBox *crossfadeSpin;
+
+    // Position readout and scrubbing; seeks are coalesced before the engine
+    SeekBar *seekBar;
+
+    // Spectrum/waveform of what plays, analyzed on its own thread
+    SpectrumAnalyzer *analyzer;
+    VisualizerWidget *visualizer;
+
+    // Overview of the current track, built once per file in the background
+    WaveformCache *waveforms;
+    WaveformView *waveformView;
+    
+    // EQ and preamp live in the engine's DSP chain
+    QPushButton *equalizerButton;
+    QDialog *equalizerDialog;
+    QCheckBox *replayGainCheck;
+    
+    // Offline R128 analysis of the whole playlist
+    LoudnessAnalyzer *loudness;
+    QPushButton *analyzeButton;
+    QCheckBox *loudnessCheck;
+    int analyzedSinceSave;
     QPushButton *loadButton;
+    QPushButton *scanButton;
     QPushButton *playButton;
     QPushButton *pauseButton;
     QPushButton *stopButton;
+    QPushButton *previousButton;
+    QPushButton *nextButton;
+    QCheckBox *shuffleCheck;
+    QComboBox *repeatCombo;
     QPushButton *playlistButton;
     QPushButton *deleteButton;
     
     // Use our template class for playlist management
-    PlaylistManager<QUrl, QString> playlist;
+    MusicPlaylist playlist;
+    PlaylistModel *playlistModel;
+    
+    // On-disk copy of the playlist, updated incrementally via its journal
+    LibraryStore library;
     
-    // Current song index
-    int currentSongIndex;
+    // Tags read in the background for the playlist entries
+    MetadataCache *metadata;
+    
+    // Entry being played; stays valid while other rows move or go away
+    MusicPlaylist::EntryId currentEntry;
+    
+    // Next/previous, shuffle and repeat over the playlist
+    PlayQueue queue;
+
+    // Background folder import
+    LibraryScanner *scanner;
+    QProgressDialog *scanProgress;
+    int scanAdded;
+
+    // Keeps scanned folders in sync with the disk
+    LibraryWatcher *watcher;
+
+    // Playlist file import/export
+    PlaylistImporter *importer;
+    QPushButton *importButton;
+    QPushButton *exportButton;
+    int importAdded;
+
+    // Local socket for scripting the player from other processes
+    ControlServer *control;
 
+    int currentRow() const;
     void loadSong();
+    void loadLibrary();
+    void prepareNextTrack();
+    void handleEndOfMedia();
+    void handleTrackChanged(const QUrl& source);
+    void handleMediaFailed(const QUrl& source);
+    void notifyEvent(const EventLog::Event& event);
+    void showEventLog();
+    void showPerformance();
+    void updatePerformance();
+    void exportTrace();
+    void showWaveform(const QUrl& source);
+    void playNext();
+    void playPrevious();
+    void playEntry(MusicPlaylist::EntryId id);
+    void showEqualizer();
+    float trackGain(int index) const;
+    void analyzeLoudness();
+    void applyLoudness(const QUrl& url, double integratedLufs, double truePeakDb);
+    void finishLoudnessAnalysis(bool cancelled);
+    void applyMetadata(const QList<TrackMetadata>& results);
     void deleteSong();
+    bool removeSongs(const std::vector<int>& rows);
+    void scanFolder();
+    void addScannedTracks(const QList<ScannedTrack>& tracks);
+    void updateScanProgress(int filesSeen, int tracksFound);
+    void finishScan(bool cancelled);
+    void applyLibraryChanges(const LibraryChanges& changes);
+    bool addPath(const QString& path);
+    void importPlaylist();
+    void exportPlaylist();
+    void finishImport(int entriesRead, bool cancelled, const QString& error);
 };
 
 #endif // MAINWINDOW_H
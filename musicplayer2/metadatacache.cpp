@@ -0,0 +1,174 @@
+#include "metadatacache.h"
+#include "tagreader.h"
+#include "playlistmanager.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+
+namespace {
+
+const quint32 CacheMagic = 0x434D504D;   // "MPMC"
+const quint32 CacheVersion = 3;
+
+} // namespace
+
+MetadataCache::MetadataCache(const QString& cacheFile, QObject *parent)
+    : QObject(parent), cacheFile(cacheFile), shuttingDown(false), dirty(false) {
+    qRegisterMetaType<TrackMetadata>();
+    qRegisterMetaType<QList<TrackMetadata>>();
+
+    // Tag reads are small and I/O bound; keep a couple of them off the GUI thread
+    pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount() / 2, 4));
+
+    connect(this, &MetadataCache::metadataReady, this, [this](const QList<TrackMetadata>& results) {
+        for (const TrackMetadata& result : results) {
+            pending.remove(result.url.toLocalFile());
+        }
+    });
+
+    load();
+}
+
+MetadataCache::~MetadataCache() {
+    shuttingDown = true;
+    pool.clear();
+    pool.waitForDone();
+    try {
+        save();
+    } catch (...) {
+        // Losing the cache only costs a re-parse next time
+    }
+}
+
+QString MetadataCache::defaultLocation() {
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("metadata.cache");
+}
+
+void MetadataCache::request(const QList<QUrl>& urls) {
+    QList<QUrl> batch;
+    batch.reserve(BatchSize);
+    for (const QUrl& url : urls) {
+        const QString path = url.toLocalFile();
+        if (pending.contains(path)) {
+            continue;
+        }
+        pending.insert(path);
+        batch.append(url);
+
+        if (batch.size() == BatchSize) {
+            pool.start([this, batch]() { process(batch); });
+            batch.clear();
+        }
+    }
+    if (!batch.isEmpty()) {
+        pool.start([this, batch]() { process(batch); });
+    }
+}
+
+void MetadataCache::process(const QList<QUrl>& urls) {
+    QList<TrackMetadata> results;
+    results.reserve(urls.size());
+
+    for (const QUrl& url : urls) {
+        if (shuttingDown) {
+            return;
+        }
+        const QString path = url.toLocalFile();
+        QFileInfo fileInfo(path);
+        const qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+        const qint64 size = fileInfo.size();
+
+        {
+            QMutexLocker locker(&mutex);
+            auto it = entries.constFind(path);
+            if (it != entries.constEnd() && it->modified == modified && it->size == size) {
+                results.append(TrackMetadata{url, it->info});
+                continue;
+            }
+        }
+
+        // Parse outside the lock; another worker never gets the same path
+        TrackInfo info = TagReader::read(path);
+        {
+            QMutexLocker locker(&mutex);
+            entries.insert(path, CacheEntry{modified, size, info});
+            dirty = true;
+        }
+        results.append(TrackMetadata{url, info});
+    }
+
+    emit metadataReady(results);
+}
+
+void MetadataCache::store(const QUrl& url, const TrackInfo& info) {
+    QMutexLocker locker(&mutex);
+    auto it = entries.find(url.toLocalFile());
+    if (it != entries.end()) {
+        it->info = info;
+        dirty = true;
+    }
+}
+
+void MetadataCache::load() {
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream in(&file);
+    quint32 magic;
+    quint32 version;
+    qint32 count;
+    in >> magic >> version >> count;
+    if (magic != CacheMagic || version != CacheVersion || count < 0) {
+        return;  // Unknown format; it gets rebuilt
+    }
+
+    QMutexLocker locker(&mutex);
+    entries.reserve(count);
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        CacheEntry entry;
+        in >> path >> entry.modified >> entry.size
+           >> entry.info.fileName >> entry.info.title >> entry.info.artist
+           >> entry.info.album >> entry.info.durationMs
+           >> entry.info.hasReplayGain >> entry.info.replayGainDb >> entry.info.replayGainPeak
+           >> entry.info.hasLoudness >> entry.info.loudnessLufs >> entry.info.truePeakDb;
+        if (in.status() == QDataStream::Ok) {
+            entries.insert(path, entry);
+        }
+    }
+}
+
+void MetadataCache::save() {
+    QMutexLocker locker(&mutex);
+    if (!dirty) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        throw MusicPlayerException("Cannot write metadata cache: " + file.errorString().toStdString());
+    }
+
+    QDataStream out(&file);
+    out << CacheMagic << CacheVersion << static_cast<qint32>(entries.size());
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        out << it.key() << it->modified << it->size
+            << it->info.fileName << it->info.title << it->info.artist
+            << it->info.album << it->info.durationMs
+            << it->info.hasReplayGain << it->info.replayGainDb << it->info.replayGainPeak
+            << it->info.hasLoudness << it->info.loudnessLufs << it->info.truePeakDb;
+    }
+    if (!file.commit()) {
+        throw MusicPlayerException("Cannot save metadata cache: " + file.errorString().toStdString());
+    }
+    dirty = false;
+}
@@ -0,0 +1,75 @@
+#ifndef METADATACACHE_H
+#define METADATACACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QUrl>
+#include <atomic>
+#include "trackinfo.h"
+
+// Result of reading one file's tags
+struct TrackMetadata {
+    QUrl url;
+    TrackInfo info;
+};
+
+Q_DECLARE_METATYPE(TrackMetadata)
+
+// Reads track tags on a worker pool and remembers them on disk keyed by path,
+// modification time and size, so unchanged files are never parsed twice.
+// Requests for a file that is already queued are ignored.
+class MetadataCache : public QObject {
+    Q_OBJECT
+
+public:
+    // Files handled per worker job and per metadataReady batch
+    static constexpr int BatchSize = 64;
+
+    explicit MetadataCache(const QString& cacheFile = defaultLocation(), QObject *parent = nullptr);
+    virtual ~MetadataCache();
+
+    // Per-user cache file used when none is given
+    static QString defaultLocation();
+
+    // Queue files for reading; results arrive through metadataReady
+    void request(const QList<QUrl>& urls);
+
+    // Replace the cached record of a file already in the cache, e.g. after
+    // loudness analysis; ignored for files that were never read
+    void store(const QUrl& url, const TrackInfo& info);
+
+    // Write the cache to disk if anything changed
+    void save();
+
+signals:
+    void metadataReady(const QList<TrackMetadata>& results);
+
+private:
+    struct CacheEntry {
+        qint64 modified;
+        qint64 size;
+        TrackInfo info;
+    };
+
+    void load();
+    void process(const QList<QUrl>& urls);
+
+    QString cacheFile;
+    QThreadPool pool;
+    std::atomic<bool> shuttingDown;
+
+    // Shared with the workers
+    QMutex mutex;
+    QHash<QString, CacheEntry> entries;
+    bool dirty;
+
+    // GUI thread only: paths queued but not reported yet
+    QSet<QString> pending;
+};
+
+#endif // METADATACACHE_H
@@ -1,24 +1,114 @@
 QT       += core gui
-QT         += multimedia
+QT         += multimedia concurrent network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
+# Build the DSP kernels with AVX2 instead of the baseline SSE: qmake CONFIG+=avx2
+avx2 {
+    msvc: QMAKE_CXXFLAGS += /arch:AVX2
+    else: QMAKE_CXXFLAGS += -mavx2 -mfma
+}
+
+# Compile out the latency tracing and counters: qmake CONFIG+=notrace
+notrace: DEFINES += MUSICPLAYER_NO_TRACE
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    controlserver.cpp \
+    crossfademixer.cpp \
+    dspchain.cpp \
+    eventlog.cpp \
+    headlessplayer.cpp \
+    libraryscanner.cpp \
+    librarystore.cpp \
+    librarywatcher.cpp \
+    loudnessanalyzer.cpp \
+    loudnessmeter.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    metadatacache.cpp \
+    notificationbar.cpp \
+    playerengine.cpp \
+    playlistio.cpp \
+    playlistmodel.cpp \
+    playqueue.cpp \
+    playlistsorter.cpp \
+    searchindex.cpp \
+    seekbar.cpp \
+    spectrumanalyzer.cpp \
+    tagreader.cpp \
+    trace.cpp \
+    trackstorage.cpp \
+    visualizerwidget.cpp \
+    waveformcache.cpp \
+    waveformpyramid.cpp \
+    waveformview.cpp
 
 HEADERS += \
-    mainwindow.h
+    commandqueue.h \
+    controlserver.h \
+    crossfademixer.h \
+    dspchain.h \
+    dspkernels.h \
+    eventlog.h \
+    headlessplayer.h \
+    iplayer.h \
+    libraryscanner.h \
+    librarystore.h \
+    librarywatcher.h \
+    loudnessanalyzer.h \
+    loudnessmeter.h \
+    mainwindow.h \
+    metadatacache.h \
+    notificationbar.h \
+    playerengine.h \
+    playlistio.h \
+    playlistmanager.h \
+    playlistmodel.h \
+    playqueue.h \
+    playlistsorter.h \
+    searchindex.h \
+    seekbar.h \
+    spectrumanalyzer.h \
+    tagreader.h \
+    trace.h \
+    trackinfo.h \
+    trackstorage.h \
+    visualizerwidget.h \
+    waveformcache.h \
+    waveformpyramid.h \
+    waveformview.h
 
 FORMS += \
     mainwindow.ui
 
+# Display-less build for rack players: qmake CONFIG+=headless
+# Runs on QCoreApplication with HeadlessPlayer; the window and the
+# decode/mix, tag and analysis code it alone uses are left out.
+# bench/startup/startup.sh compares startup time and peak RSS of both builds.
+headless {
+    QT -= gui widgets
+    DEFINES += MUSICPLAYER_HEADLESS
+    TARGET = musicplayer2-headless
+    SOURCES -= mainwindow.cpp crossfademixer.cpp dspchain.cpp librarywatcher.cpp \
+               loudnessanalyzer.cpp loudnessmeter.cpp metadatacache.cpp notificationbar.cpp playerengine.cpp \
+               seekbar.cpp spectrumanalyzer.cpp tagreader.cpp visualizerwidget.cpp \
+               waveformcache.cpp waveformpyramid.cpp waveformview.cpp
+    HEADERS -= mainwindow.h crossfademixer.h dspchain.h dspkernels.h librarywatcher.h \
+               loudnessanalyzer.h loudnessmeter.h metadatacache.h notificationbar.h playerengine.h \
+               seekbar.h spectrumanalyzer.h tagreader.h visualizerwidget.h \
+               waveformcache.h waveformpyramid.h waveformview.h
+    FORMS -= mainwindow.ui
+} else {
+    SOURCES -= headlessplayer.cpp
+    HEADERS -= headlessplayer.h
+}
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
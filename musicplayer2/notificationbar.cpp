@@ -0,0 +1,53 @@
+#include "notificationbar.h"
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+
+NotificationBar::NotificationBar(QWidget *parent) : QFrame(parent), shownCount(0) {
+    setFrameShape(QFrame::StyledPanel);
+    setAutoFillBackground(true);
+
+    textLabel = new QLabel();
+    textLabel->setWordWrap(true);
+    detailsButton = new QPushButton("Details...");
+    closeButton = new QPushButton("Dismiss");
+
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->addWidget(textLabel, 1);
+    layout->addWidget(detailsButton);
+    layout->addWidget(closeButton);
+
+    hideTimer = new QTimer(this);
+    hideTimer->setSingleShot(true);
+    hideTimer->setInterval(ShowMs);
+    connect(hideTimer, &QTimer::timeout, this, &NotificationBar::dismiss);
+    connect(closeButton, &QPushButton::clicked, this, &NotificationBar::dismiss);
+    connect(detailsButton, &QPushButton::clicked, this, &NotificationBar::detailsRequested);
+
+    hide();
+}
+
+void NotificationBar::notify(const EventLog::Event& event) {
+    ++shownCount;
+    QString text = event.message;
+    if (shownCount > 1) {
+        text += QString(" (%1 more)").arg(shownCount - 1);
+    }
+    textLabel->setText(text);
+
+    QPalette colors = palette();
+    colors.setColor(QPalette::Window, event.level == EventLog::Level::Error ? QColor(255, 220, 220)
+                                                                           : QColor(255, 245, 205));
+    colors.setColor(QPalette::WindowText, Qt::black);
+    setPalette(colors);
+
+    show();
+    hideTimer->start();
+}
+
+void NotificationBar::dismiss() {
+    hideTimer->stop();
+    shownCount = 0;
+    hide();
+}
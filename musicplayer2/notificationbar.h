@@ -0,0 +1,40 @@
+#ifndef NOTIFICATIONBAR_H
+#define NOTIFICATIONBAR_H
+
+#include <QFrame>
+#include "eventlog.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QPushButton;
+class QTimer;
+QT_END_NAMESPACE
+
+// Non-modal replacement for error message boxes: shows the latest warning
+// or error above the controls while playback carries on. Messages arriving
+// while it is up are counted, and it hides itself after ShowMs or when
+// dismissed. Details asks the owner to show the full event log.
+class NotificationBar : public QFrame {
+    Q_OBJECT
+
+public:
+    static constexpr int ShowMs = 8000;
+
+    explicit NotificationBar(QWidget *parent = nullptr);
+
+    void notify(const EventLog::Event& event);
+
+signals:
+    void detailsRequested();
+
+private:
+    void dismiss();
+
+    QLabel *textLabel;
+    QPushButton *detailsButton;
+    QPushButton *closeButton;
+    QTimer *hideTimer;
+    int shownCount;
+};
+
+#endif // NOTIFICATIONBAR_H
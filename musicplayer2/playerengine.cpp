@@ -0,0 +1,397 @@
+#include "playerengine.h"
+#include <QAudioOutput>
+#include <QTimer>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+#include <QAudioBufferOutput>
+#endif
+#include "crossfademixer.h"
+#include "spectrumanalyzer.h"
+#include "trace.h"
+
+namespace {
+
+// Output volume before any per-track gain
+const float DefaultVolume = 0.7f;
+
+// Trace names of the commands, by Command::Type
+const char* const CommandNames[] = {
+    "engine: play", "engine: pause", "engine: stop", "engine: clear", "engine: setSource",
+    "engine: setNextSource", "engine: setCrossfade", "engine: setGapless", "engine: seek"
+};
+
+} // namespace
+
+PlayerEngine::PlayerEngine(SpectrumAnalyzer *analyzer)
+    : wakePending(false), seekTarget(-1), playing(false), mixerActive(false), mixerAvailable(false),
+      equalizerStage(nullptr), preampStage(nullptr), analyzer(analyzer), player(nullptr),
+      audioOutput(nullptr), nextPlayer(nullptr), nextAudioOutput(nullptr), mixer(nullptr), crossfadeMs(0),
+      gapless(false), positionTimer(nullptr), mixerDuration(-1), firstAudioStart(-1) {
+    // Media objects are created on the engine thread so all their timers
+    // and callbacks run there; waiting once here makes the DSP handles and
+    // mixer availability readable as soon as the constructor returns
+    thread.setObjectName("PlayerEngine");
+    moveToThread(&thread);
+    thread.start(QThread::HighPriority);
+    QMetaObject::invokeMethod(this, &PlayerEngine::initialize, Qt::BlockingQueuedConnection);
+}
+
+PlayerEngine::~PlayerEngine() {
+    QMetaObject::invokeMethod(this, &PlayerEngine::shutdown, Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+}
+
+void PlayerEngine::play() {
+    post({Command::Play});
+}
+
+void PlayerEngine::pause() {
+    post({Command::Pause});
+}
+
+void PlayerEngine::stop() {
+    post({Command::Stop});
+}
+
+void PlayerEngine::setSource(const QUrl& source) {
+    setSource(source, 1.0f);
+}
+
+void PlayerEngine::setSource(const QUrl& source, float gain) {
+    post({Command::SetSource, source, gain});
+}
+
+bool PlayerEngine::isPlaying() const {
+    return playing.load(std::memory_order_acquire);
+}
+
+void PlayerEngine::setNextSource(const QUrl& source, float gain) {
+    post({Command::SetNextSource, source, gain});
+}
+
+void PlayerEngine::clear() {
+    post({Command::Clear});
+}
+
+void PlayerEngine::setCrossfadeDuration(int ms) {
+    post({Command::SetCrossfade, QUrl(), 1.0f, ms});
+}
+
+void PlayerEngine::setGapless(bool on) {
+    post({Command::SetGapless, QUrl(), 1.0f, on ? 1 : 0});
+}
+
+void PlayerEngine::seek(qint64 ms) {
+    // Only the request that finds no seek pending queues a command; the
+    // rest just move its target
+    if (seekTarget.exchange(qMax<qint64>(0, ms), std::memory_order_acq_rel) < 0) {
+        post({Command::Seek});
+    }
+}
+
+void PlayerEngine::post(Command command) {
+    // The queue only fills if the engine thread is stuck; wait it out
+    // rather than drop a command. A failed push leaves command intact.
+    while (!commands.push(std::move(command))) {
+        QThread::yieldCurrentThread();
+    }
+    // One wake-up covers everything queued until the engine starts draining
+    if (!wakePending.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &PlayerEngine::drainCommands, Qt::QueuedConnection);
+    }
+}
+
+void PlayerEngine::initialize() {
+    player = new QMediaPlayer(this);
+    audioOutput = new QAudioOutput(this);
+    player->setAudioOutput(audioOutput);
+    audioOutput->setVolume(DefaultVolume);
+
+    // Second player that holds the next track pre-rolled in gapless mode;
+    // the two swap roles at every track change
+    nextPlayer = new QMediaPlayer(this);
+    nextAudioOutput = new QAudioOutput(this);
+    nextPlayer->setAudioOutput(nextAudioOutput);
+    nextAudioOutput->setVolume(DefaultVolume);
+
+    // Crossfades need real mixing, so they go through the decoder/sink path
+    mixer = new CrossfadeMixer(this);
+    mixer->setVolume(DefaultVolume);
+    mixerAvailable = mixer->isAvailable();
+    connect(mixer, &CrossfadeMixer::trackChanged, this, [this](const QUrl& source) {
+        mixerDuration = -1;
+        emit trackChanged(source);
+    });
+    connect(mixer, &CrossfadeMixer::finished, this, [this]() {
+        mixer->stop();
+        updatePlaying();
+        emit endOfMedia(QUrl());
+    });
+    connect(mixer, &CrossfadeMixer::trackFailed, this, [this](const QUrl& source) {
+        // Same path as a QMediaPlayer error, so the owner's skip limit applies
+        mixer->stop();
+        updatePlaying();
+        emit mediaFailed(source);
+    });
+    connect(mixer, &CrossfadeMixer::errorOccurred, this, &PlayerEngine::errorOccurred);
+
+    // The mixer has no position signal; ask it while it plays
+    positionTimer = new QTimer(this);
+    positionTimer->setInterval(PositionIntervalMs);
+    connect(positionTimer, &QTimer::timeout, this, &PlayerEngine::pollMixer);
+
+    // Decode -> mix -> EQ -> preamp -> (analyzer) -> sink
+    equalizerStage = mixer->dspChain().addStage(std::make_unique<EqualizerStage>());
+    preampStage = mixer->dspChain().addStage(std::make_unique<GainStage>());
+    if (analyzer) {
+        mixer->dspChain().addStage(std::make_unique<AnalyzerTap>(analyzer));
+    }
+
+    // Only the player currently in front drives track changes
+    for (QMediaPlayer* p : {player, nextPlayer}) {
+        connect(p, &QMediaPlayer::mediaStatusChanged, this, [this, p](QMediaPlayer::MediaStatus status) {
+            if (p == player) {
+                handleMediaStatus(status);
+            }
+        });
+        connect(p, &QMediaPlayer::playbackStateChanged, this, [this, p]() {
+            if (p == player) {
+                updatePlaying();
+            }
+        });
+        connect(p, &QMediaPlayer::errorOccurred, this, [this, p](QMediaPlayer::Error, const QString& message) {
+            // The standby player's errors surface if it ever gets to the front
+            if (p == player && !mixerActive.load(std::memory_order_relaxed)) {
+                const QUrl failed = player->source();
+                updatePlaying();
+                emit errorOccurred("Cannot play " + failed.fileName() + ": " + message);
+                emit mediaFailed(failed);
+            }
+        });
+        connect(p, &QMediaPlayer::positionChanged, this, [this, p](qint64 ms) {
+            if (p == player && !mixerActive.load(std::memory_order_relaxed)) {
+                noteAudioStarted(ms);
+                publishPosition(ms, false);
+            }
+        });
+        connect(p, &QMediaPlayer::durationChanged, this, [this, p](qint64 ms) {
+            if (p == player && !mixerActive.load(std::memory_order_relaxed)) {
+                emit durationChanged(ms);
+            }
+        });
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+        // Decoded copies of what the front player sends to its sink
+        if (analyzer) {
+            QAudioBufferOutput *bufferOutput = new QAudioBufferOutput(p);
+            p->setAudioBufferOutput(bufferOutput);
+            connect(bufferOutput, &QAudioBufferOutput::audioBufferReceived, this, [this, p](const QAudioBuffer& buffer) {
+                if (p == player && !mixerActive.load(std::memory_order_relaxed)) {
+                    analyzer->write(buffer);
+                }
+            });
+        }
+#endif
+    }
+}
+
+void PlayerEngine::shutdown() {
+    // Audio objects and timers go away on the thread they were made on
+    delete positionTimer;
+    positionTimer = nullptr;
+    delete mixer;
+    delete player;
+    delete nextPlayer;
+    delete audioOutput;
+    delete nextAudioOutput;
+    mixer = nullptr;
+    player = nextPlayer = nullptr;
+    audioOutput = nextAudioOutput = nullptr;
+}
+
+void PlayerEngine::drainCommands() {
+    // Cleared first so a command pushed while draining wakes us again
+    wakePending.store(false, std::memory_order_release);
+    Command command;
+    while (commands.pop(command)) {
+        execute(command);
+    }
+}
+
+void PlayerEngine::execute(const Command& command) {
+    TRACE_SCOPE(CommandNames[command.type]);
+    switch (command.type) {
+    case Command::Play:
+        // Time to first audio counts from here when a new track waits
+        if (firstAudioStart >= 0) {
+            firstAudioStart = Trace::now();
+        }
+        if (mixerActive) {
+            mixer->play();
+        } else {
+            player->play();
+        }
+        break;
+    case Command::Pause:
+        if (mixerActive) {
+            mixer->pause();
+        } else {
+            player->pause();
+        }
+        break;
+    case Command::Stop:
+        if (mixerActive) {
+            // Rewinds both decks to the start of their tracks
+            mixer->stop();
+        } else {
+            player->stop();
+            player->setPosition(0);
+        }
+        publishPosition(0, true);
+        break;
+    case Command::Clear:
+        player->stop();
+        nextPlayer->setSource(QUrl());
+        mixer->clear();
+        nextSource = QUrl();
+        break;
+    case Command::SetSource: {
+        // Crossfade and EQ need the decoded path, and gapless changes are
+        // only sample-accurate there; otherwise use QMediaPlayer
+        const bool useMixer = (crossfadeMs > 0 || gapless || equalizerStage->isEnabled()) && mixerAvailable;
+        mixerActive.store(useMixer, std::memory_order_release);
+        if (useMixer) {
+            player->stop();
+            mixer->setCrossfadeDuration(crossfadeMs);
+            mixer->setSource(command.source, command.gain);
+        } else {
+            mixer->clear();
+            player->setSource(command.source);
+            audioOutput->setVolume(DefaultVolume * command.gain);
+        }
+        mixerDuration = -1;
+        publishPosition(0, true);
+        Trace::add(Trace::Counter::TracksLoaded, 1);
+        firstAudioStart = Trace::now();
+        break;
+    }
+    case Command::SetNextSource:
+        nextSource = command.source;
+        if (mixerActive) {
+            // The mixer always continues into the next song, crossfading it in
+            nextPlayer->setSource(QUrl());
+            mixer->setNextSource(command.source, command.gain);
+        } else if (!gapless || command.source.isEmpty()) {
+            nextPlayer->setSource(QUrl());
+        } else {
+            // Load (but don't start) it so its decoder is already open when
+            // the current track ends
+            if (nextPlayer->source() != command.source) {
+                nextPlayer->setSource(command.source);
+            }
+            nextAudioOutput->setVolume(DefaultVolume * command.gain);
+        }
+        break;
+    case Command::SetCrossfade:
+        crossfadeMs = command.value;
+        // Length changes apply at once (zero is a gapless cut); switching
+        // paths waits for the next song
+        if (mixerActive) {
+            mixer->setCrossfadeDuration(crossfadeMs);
+        }
+        break;
+    case Command::SetGapless:
+        gapless = command.value != 0;
+        // Like crossfades, moving to or off the mixer waits for the next song
+        if (!gapless && !mixerActive) {
+            nextPlayer->setSource(QUrl());
+        }
+        break;
+    case Command::Seek: {
+        const qint64 target = seekTarget.exchange(-1, std::memory_order_acq_rel);
+        if (target < 0) {
+            break;
+        }
+        if (mixerActive) {
+            mixer->seek(target);
+        } else {
+            player->setPosition(target);
+        }
+        publishPosition(target, true);
+        break;
+    }
+    }
+    updatePlaying();
+}
+
+void PlayerEngine::handleMediaStatus(QMediaPlayer::MediaStatus status) {
+    if (status != QMediaPlayer::EndOfMedia) {
+        return;
+    }
+
+    // Only reached without the mixer: the swap starts the next player when
+    // the end is reported, so a short gap remains
+    const QUrl finished = player->source();
+    if (gapless && !nextSource.isEmpty() && nextPlayer->source() == nextSource
+        && nextPlayer->mediaStatus() != QMediaPlayer::InvalidMedia) {
+        // Start the pre-rolled player first, then swap roles
+        nextPlayer->play();
+        std::swap(player, nextPlayer);
+        std::swap(audioOutput, nextAudioOutput);
+
+        // The finished player becomes the standby for the track after,
+        // which the owner sends once it hears about the change
+        nextPlayer->stop();
+        nextSource = QUrl();
+        updatePlaying();
+        emit durationChanged(player->duration());
+        publishPosition(player->position(), true);
+        emit trackChanged(player->source());
+        return;
+    }
+
+    updatePlaying();
+    emit endOfMedia(finished);
+}
+
+void PlayerEngine::updatePlaying() {
+    const bool now = mixerActive ? mixer->isPlaying() : player->playbackState() == QMediaPlayer::PlayingState;
+    playing.store(now, std::memory_order_release);
+    if (mixerActive && now) {
+        if (!positionTimer->isActive()) {
+            positionTimer->start();
+        }
+    } else {
+        positionTimer->stop();
+    }
+}
+
+void PlayerEngine::publishPosition(qint64 ms, bool force) {
+    // Backends report many times a second; the GUI needs far fewer
+    if (!force && positionClock.isValid() && positionClock.elapsed() < PositionIntervalMs) {
+        return;
+    }
+    positionClock.start();
+    emit positionChanged(ms);
+}
+
+void PlayerEngine::pollMixer() {
+    const qint64 duration = mixer->duration();
+    if (duration != mixerDuration) {
+        mixerDuration = duration;
+        emit durationChanged(duration);
+    }
+    const qint64 position = mixer->position();
+    noteAudioStarted(position);
+    publishPosition(position, true);
+}
+
+void PlayerEngine::noteAudioStarted(qint64 ms) {
+    // The first position past zero after a track start means it is audible
+    if (firstAudioStart < 0 || ms <= 0) {
+        return;
+    }
+    const qint64 elapsed = Trace::now() - firstAudioStart;
+    Trace::record("time to first audio", firstAudioStart, elapsed);
+    Trace::set(Trace::Counter::TimeToFirstAudioMs, elapsed / 1000000);
+    firstAudioStart = -1;
+}
@@ -0,0 +1,153 @@
+#ifndef PLAYERENGINE_H
+#define PLAYERENGINE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMediaPlayer>
+#include <QThread>
+#include <QUrl>
+#include <atomic>
+#include "commandqueue.h"
+#include "dspchain.h"
+#include "iplayer.h"
+
+QT_BEGIN_NAMESPACE
+class QAudioOutput;
+class QTimer;
+QT_END_NAMESPACE
+
+class CrossfadeMixer;
+class SpectrumAnalyzer;
+
+// Playback on a thread of its own, away from file dialogs and list repaints.
+// Owns the CrossfadeMixer with its DSP chain, which plays crossfades, EQ and
+// gapless changes, and a front/standby QMediaPlayer pair that covers gapless
+// changes when the mixer is not available. Control calls may come from any thread:
+// they only push a command onto a lock-free queue and wake the engine, which
+// drains the queue in order. State the caller reads back (isPlaying and
+// friends) is published through atomics; events arrive as queued signals.
+// The engine never looks at the playlist - the owner tells it which track
+// to play and which to queue behind it.
+class PlayerEngine : public QObject, public IPlayer {
+    Q_OBJECT
+
+public:
+    // Commands that may be pending before the engine catches up
+    static constexpr std::size_t QueueCapacity = 256;
+    static constexpr int PositionIntervalMs = 100;
+
+    // Starts the engine thread and creates the playback objects on it;
+    // whatever plays is also fed to analyzer, if given
+    explicit PlayerEngine(SpectrumAnalyzer *analyzer = nullptr);
+    virtual ~PlayerEngine();
+
+    // Implement IPlayer interface methods
+    void play() override;
+    void pause() override;
+    void stop() override;
+    void setSource(const QUrl& source) override;
+    bool isPlaying() const override;
+
+    // Load source with a gain factor (ReplayGain/R128) on top of the volume
+    void setSource(const QUrl& source, float gain);
+    // Track to continue into when the current one ends; empty clears it
+    void setNextSource(const QUrl& source, float gain);
+    // Stop and drop the current and next tracks
+    void clear();
+
+    // Jump to ms in the current track. Targets that arrive before the
+    // engine gets to them replace each other, so a burst of requests from
+    // scrubbing costs one backend seek.
+    void seek(qint64 ms);
+
+    // Crossfades, gapless mode and the equalizer use the decoded mixer
+    // path; the choice is made per track in setSource
+    void setCrossfadeDuration(int ms);
+    void setGapless(bool on);
+
+    // Fixed once the engine has started
+    bool isMixerAvailable() const { return mixerAvailable; }
+    // True while the current track plays through the mixer
+    bool usesMixer() const { return mixerActive.load(std::memory_order_acquire); }
+
+    // DSP parameters are atomics, so these may be adjusted from any thread
+    EqualizerStage* equalizer() const { return equalizerStage; }
+    GainStage* preamp() const { return preampStage; }
+
+signals:
+    // The engine moved on to source by itself (gapless swap or crossfade)
+    void trackChanged(const QUrl& source);
+    // The current track ended with nothing pre-rolled to follow it
+    void endOfMedia(const QUrl& source);
+    // Playback position, at most every PositionIntervalMs (and after seeks)
+    void positionChanged(qint64 ms);
+    void durationChanged(qint64 ms);
+    void errorOccurred(const QString& error);
+    // The current track cannot be played; playback has stopped on it
+    void mediaFailed(const QUrl& source);
+
+private:
+    struct Command {
+        enum Type : quint8 {
+            Play,
+            Pause,
+            Stop,
+            Clear,
+            SetSource,
+            SetNextSource,
+            SetCrossfade,
+            SetGapless,
+            Seek
+        };
+
+        Type type = Play;
+        QUrl source;
+        float gain = 1.0f;
+        int value = 0;
+    };
+
+    void post(Command command);
+    void initialize();
+    void shutdown();
+    void drainCommands();
+    void execute(const Command& command);
+    void handleMediaStatus(QMediaPlayer::MediaStatus status);
+    void updatePlaying();
+    void publishPosition(qint64 ms, bool force);
+    void pollMixer();
+    void noteAudioStarted(qint64 ms);
+
+    QThread thread;
+    CommandQueue<Command, QueueCapacity> commands;
+    std::atomic<bool> wakePending;
+    // Latest seek not yet carried out; -1 if none
+    std::atomic<qint64> seekTarget;
+
+    // Published to other threads
+    std::atomic<bool> playing;
+    std::atomic<bool> mixerActive;
+    bool mixerAvailable;
+    EqualizerStage *equalizerStage;
+    GainStage *preampStage;
+
+    // Engine thread only
+    SpectrumAnalyzer *analyzer;
+    QMediaPlayer *player;
+    QAudioOutput *audioOutput;
+    QMediaPlayer *nextPlayer;
+    QAudioOutput *nextAudioOutput;
+    CrossfadeMixer *mixer;
+    QUrl nextSource;
+    int crossfadeMs;
+    bool gapless;
+
+    // Position reports: throttled, and polled from the mixer while it plays
+    QTimer *positionTimer;
+    QElapsedTimer positionClock;
+    qint64 mixerDuration;
+
+    // Start of the track start being timed (Trace clock); -1 if none
+    qint64 firstAudioStart;
+};
+
+#endif // PLAYERENGINE_H
@@ -0,0 +1,345 @@
+#include "playlistio.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringDecoder>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QtConcurrent>
+
+namespace {
+
+// Bytes read per chunk, and buffered before each write when exporting
+const qint64 ChunkSize = 64 * 1024;
+
+enum class PlaylistFormat {
+    M3U,
+    PLS,
+    XSPF
+};
+
+PlaylistFormat formatOf(const QString& path) {
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "pls") {
+        return PlaylistFormat::PLS;
+    }
+    if (suffix == "xspf") {
+        return PlaylistFormat::XSPF;
+    }
+    return PlaylistFormat::M3U;
+}
+
+// Plain .m3u predates UTF-8 playlists and is in the local 8-bit encoding
+// unless it starts with a BOM; .m3u8 and everything else is UTF-8
+QStringDecoder::Encoding textEncodingOf(const QString& path) {
+    return QFileInfo(path).suffix().compare("m3u", Qt::CaseInsensitive) == 0 ? QStringDecoder::System
+                                                                            : QStringDecoder::Utf8;
+}
+
+// Splits a file into lines while reading it a chunk at a time. Decoding is
+// stateful, so multi-byte characters split across chunks survive. A byte
+// order mark at the start overrides the given encoding.
+class LineReader {
+public:
+    LineReader(QFile& file, QStringDecoder::Encoding encoding)
+        : file(file), encoding(encoding), position(0) {}
+
+    bool readLine(QString& line) {
+        for (;;) {
+            const qsizetype end = buffer.indexOf('\n', position);
+            if (end >= 0) {
+                line = QStringView(buffer).mid(position, end - position).trimmed().toString();
+                position = end + 1;
+                return true;
+            }
+            if (file.atEnd()) {
+                // Last line without a terminator
+                if (position >= buffer.size()) {
+                    return false;
+                }
+                line = QStringView(buffer).mid(position).trimmed().toString();
+                position = buffer.size();
+                return true;
+            }
+            buffer.remove(0, position);
+            position = 0;
+            const QByteArray chunk = file.read(ChunkSize);
+            if (!decoder.isValid()) {
+                decoder = QStringDecoder(QStringConverter::encodingForData(chunk).value_or(encoding));
+            }
+            buffer.append(decoder.decode(chunk));
+        }
+    }
+
+private:
+    QFile& file;
+    QStringDecoder::Encoding encoding;
+    QStringDecoder decoder;    // Chosen on the first chunk
+    QString buffer;
+    qsizetype position;
+};
+
+// Local path for a playlist entry, or empty for remote or unusable entries
+QString resolveEntry(const QString& entry, const QDir& base) {
+    if (entry.isEmpty()) {
+        return QString();
+    }
+    if (entry.startsWith("file:", Qt::CaseInsensitive)) {
+        return QDir::cleanPath(QUrl(entry).toLocalFile());
+    }
+    // Any other scheme ("http://", "rtsp://", ...) is a stream
+    const qsizetype scheme = entry.indexOf("://");
+    if (scheme > 1) {
+        return QString();
+    }
+    // Playlists written on Windows use backslashes even for relative paths
+    const QString path = QString(entry).replace('\\', '/');
+    return QDir::cleanPath(base.absoluteFilePath(path));
+}
+
+ScannedTrack trackFor(const QString& path) {
+    return ScannedTrack{QUrl::fromLocalFile(path), path.mid(path.lastIndexOf('/') + 1)};
+}
+
+QString relativeEntry(const QUrl& url, const QDir& base) {
+    // Streams are written as they are
+    if (!url.isLocalFile()) {
+        return url.toString(QUrl::FullyEncoded);
+    }
+    const QString path = url.toLocalFile();
+    const QString relative = base.relativeFilePath(path);
+    return relative.startsWith("../") || QDir::isAbsolutePath(relative) ? path : relative;
+}
+
+// Accumulates output and writes it in ChunkSize pieces
+class ChunkWriter {
+public:
+    explicit ChunkWriter(QSaveFile& file) : file(file) {}
+
+    void append(const QString& text) {
+        buffer.append(text.toUtf8());
+        if (buffer.size() >= ChunkSize) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (file.write(buffer) != buffer.size()) {
+            throw MusicPlayerException("Cannot write playlist: " + file.errorString().toStdString());
+        }
+        buffer.clear();
+    }
+
+private:
+    QSaveFile& file;
+    QByteArray buffer;
+};
+
+} // namespace
+
+PlaylistImporter::PlaylistImporter(QObject *parent)
+    : QObject(parent), cancelRequested(false) {
+    qRegisterMetaType<ScannedTrack>();
+    qRegisterMetaType<QList<ScannedTrack>>();
+    connect(&importWatcher, &QFutureWatcher<Outcome>::finished, this, [this]() {
+        const Outcome outcome = importTask.result();
+        emit finished(outcome.entriesRead, outcome.cancelled, outcome.error);
+    });
+}
+
+PlaylistImporter::~PlaylistImporter() {
+    // The worker emits through this object, so it must stop before we go away
+    cancel();
+    importTask.waitForFinished();
+}
+
+QStringList PlaylistImporter::playlistFilters() {
+    return {"*.m3u", "*.m3u8", "*.pls", "*.xspf"};
+}
+
+QString PlaylistImporter::dialogFilter() {
+    return "Playlists (" + playlistFilters().join(' ') + ")";
+}
+
+bool PlaylistImporter::import(const QString& path) {
+    if (isRunning()) {
+        return false;
+    }
+    cancelRequested = false;
+    importTask = QtConcurrent::run([this, path]() { return run(path); });
+    importWatcher.setFuture(importTask);
+    return true;
+}
+
+void PlaylistImporter::cancel() {
+    cancelRequested = true;
+}
+
+bool PlaylistImporter::isRunning() const {
+    return importTask.isRunning();
+}
+
+PlaylistImporter::Outcome PlaylistImporter::run(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return Outcome{0, false, "Cannot open playlist: " + file.errorString()};
+    }
+
+    const QDir base = QFileInfo(path).absoluteDir();
+    const qint64 totalBytes = file.size();
+    int entriesRead = 0;
+    QList<ScannedTrack> batch;
+    batch.reserve(BatchSize);
+
+    auto addEntry = [&](const QString& entry) {
+        const QString resolved = resolveEntry(entry, base);
+        if (resolved.isEmpty()) {
+            return;
+        }
+        batch.append(trackFor(resolved));
+        ++entriesRead;
+        if (batch.size() >= BatchSize) {
+            emit batchReady(batch);
+            emit progress(file.pos(), totalBytes);
+            batch.clear();
+            batch.reserve(BatchSize);
+        }
+    };
+
+    QString error;
+    switch (formatOf(path)) {
+    case PlaylistFormat::M3U: {
+        // Comments and #EXT directives are skipped; tags come from the files
+        LineReader reader(file, textEncodingOf(path));
+        QString line;
+        while (!cancelRequested && reader.readLine(line)) {
+            if (!line.isEmpty() && !line.startsWith('#')) {
+                addEntry(line);
+            }
+        }
+        break;
+    }
+    case PlaylistFormat::PLS: {
+        // Only the FileN= keys matter; entries are kept in file order
+        LineReader reader(file, textEncodingOf(path));
+        QString line;
+        while (!cancelRequested && reader.readLine(line)) {
+            if (line.startsWith("file", Qt::CaseInsensitive)) {
+                const qsizetype equals = line.indexOf('=');
+                if (equals > 4) {
+                    addEntry(line.mid(equals + 1).trimmed());
+                }
+            }
+        }
+        break;
+    }
+    case PlaylistFormat::XSPF: {
+        // Locations are URIs; relative ones resolve against the playlist
+        const QUrl baseUrl = QUrl::fromLocalFile(base.absolutePath() + '/');
+        QXmlStreamReader xml(&file);
+        while (!cancelRequested && !xml.atEnd()) {
+            if (xml.readNext() == QXmlStreamReader::StartElement && xml.name() == QLatin1String("location")) {
+                const QUrl location = baseUrl.resolved(QUrl(xml.readElementText().trimmed()));
+                if (location.isLocalFile()) {
+                    addEntry(location.toString());
+                }
+            }
+        }
+        if (xml.hasError()) {
+            error = QString("Invalid XSPF playlist at line %1: %2").arg(xml.lineNumber()).arg(xml.errorString());
+        }
+        break;
+    }
+    }
+
+    if (!batch.isEmpty()) {
+        emit batchReady(batch);
+    }
+    return Outcome{entriesRead, cancelRequested, error};
+}
+
+void PlaylistExporter::write(const QString& path, const MusicPlaylist& playlist) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        throw MusicPlayerException("Cannot create playlist: " + file.errorString().toStdString());
+    }
+
+    const QDir base = QFileInfo(path).absoluteDir();
+    const size_t count = playlist.size();
+
+    switch (formatOf(path)) {
+    case PlaylistFormat::M3U: {
+        ChunkWriter out(file);
+        // Output is UTF-8; a plain .m3u gets a BOM so readers (this one
+        // included) don't take it for the local 8-bit encoding
+        if (textEncodingOf(path) != QStringDecoder::Utf8) {
+            out.append(QString(QChar::ByteOrderMark));
+        }
+        out.append("#EXTM3U\n");
+        for (size_t i = 0; i < count; ++i) {
+            const TrackInfo info = playlist.getDisplayInfo(i);
+            // Length in whole seconds, -1 when unknown
+            const qint64 seconds = info.durationMs > 0 ? info.durationMs / 1000 : -1;
+            out.append(QString("#EXTINF:%1,%2\n").arg(seconds).arg(info.displayName()));
+            out.append(relativeEntry(playlist.getItem(i), base) + '\n');
+        }
+        out.flush();
+        break;
+    }
+    case PlaylistFormat::PLS: {
+        ChunkWriter out(file);
+        out.append("[playlist]\n");
+        for (size_t i = 0; i < count; ++i) {
+            const TrackInfo info = playlist.getDisplayInfo(i);
+            const size_t n = i + 1;
+            out.append(QString("File%1=%2\n").arg(n).arg(relativeEntry(playlist.getItem(i), base)));
+            out.append(QString("Title%1=%2\n").arg(n).arg(info.displayName()));
+            out.append(QString("Length%1=%2\n").arg(n).arg(info.durationMs > 0 ? info.durationMs / 1000 : -1));
+        }
+        out.append(QString("NumberOfEntries=%1\nVersion=2\n").arg(count));
+        out.flush();
+        break;
+    }
+    case PlaylistFormat::XSPF: {
+        // The writer streams straight into the buffered file
+        QXmlStreamWriter xml(&file);
+        xml.setAutoFormatting(true);
+        xml.writeStartDocument();
+        xml.writeStartElement("playlist");
+        xml.writeAttribute("version", "1");
+        xml.writeDefaultNamespace("http://xspf.org/ns/0/");
+        xml.writeStartElement("trackList");
+        for (size_t i = 0; i < count; ++i) {
+            const TrackInfo info = playlist.getDisplayInfo(i);
+            xml.writeStartElement("track");
+            xml.writeTextElement("location", playlist.getItem(i).toString(QUrl::FullyEncoded));
+            if (!info.title.isEmpty()) {
+                xml.writeTextElement("title", info.title);
+            }
+            if (!info.artist.isEmpty()) {
+                xml.writeTextElement("creator", info.artist);
+            }
+            if (!info.album.isEmpty()) {
+                xml.writeTextElement("album", info.album);
+            }
+            if (info.durationMs > 0) {
+                xml.writeTextElement("duration", QString::number(info.durationMs));
+            }
+            xml.writeEndElement();
+        }
+        xml.writeEndElement();
+        xml.writeEndElement();
+        xml.writeEndDocument();
+        if (xml.hasError()) {
+            throw MusicPlayerException("Cannot write playlist: " + file.errorString().toStdString());
+        }
+        break;
+    }
+    }
+
+    if (!file.commit()) {
+        throw MusicPlayerException("Cannot save playlist: " + file.errorString().toStdString());
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef PLAYLISTIO_H
+#define PLAYLISTIO_H
+
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include "libraryscanner.h"
+#include "playlistmodel.h"
+
+// Reads M3U/M3U8, PLS and XSPF playlists on a background thread. Files are
+// read in fixed-size chunks (XSPF through a streaming XML reader), so memory
+// use does not grow with the playlist. Relative entries are resolved against
+// the playlist's folder; remote streams are skipped. Entries reach the GUI
+// thread in batches and are de-duplicated by the playlist when added.
+class PlaylistImporter : public QObject {
+    Q_OBJECT
+
+public:
+    // Number of entries reported together
+    static constexpr int BatchSize = 4096;
+
+    explicit PlaylistImporter(QObject *parent = nullptr);
+    virtual ~PlaylistImporter();
+
+    // Playlist file patterns, also for file dialogs
+    static QStringList playlistFilters();
+    static QString dialogFilter();
+
+    // Start reading path; ignored if an import is running
+    bool import(const QString& path);
+
+    // Request cancellation; finished() is emitted once the worker stops.
+    // finished is emitted on this object's thread after the worker has
+    // returned, so isRunning() is already false in handlers connected to it.
+    void cancel();
+
+    bool isRunning() const;
+
+signals:
+    void batchReady(const QList<ScannedTrack>& tracks);
+    void progress(qint64 bytesRead, qint64 totalBytes);
+    // error is empty on success
+    void finished(int entriesRead, bool cancelled, const QString& error);
+
+private:
+    // What finished() reports, handed over from the worker
+    struct Outcome {
+        int entriesRead;
+        bool cancelled;
+        QString error;
+    };
+
+    Outcome run(const QString& path);
+
+    QFuture<Outcome> importTask;
+    QFutureWatcher<Outcome> importWatcher;
+    std::atomic<bool> cancelRequested;
+};
+
+// Writes the playlist as M3U8 (also for .m3u), PLS or XSPF, chosen by the
+// file suffix. Paths under the playlist's folder are written relative to
+// it. The file is replaced atomically; throws MusicPlayerException.
+class PlaylistExporter {
+public:
+    static void write(const QString& path, const MusicPlaylist& playlist);
+};
+
+#endif // PLAYLISTIO_H
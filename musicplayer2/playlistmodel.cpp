@@ -0,0 +1,317 @@
+#include "playlistmodel.h"
+#include "trace.h"
+
+#include <QSet>
+#include <QTimer>
+#include <algorithm>
+
+namespace {
+
+// Above this many separate ranges a reset is cheaper for attached views
+const size_t MaxRemoveRanges = 32;
+
+} // namespace
+
+// Announces rows to views and ends the insert however the scope is left.
+// Views then expect every announced row, so if adding threw part way they
+// are reset to read the playlist as it actually is.
+class PlaylistModel::InsertGuard {
+public:
+    InsertGuard(PlaylistModel* model, int first, int last) : model(model), expectedRows(last + 1) {
+        model->beginInsertRows(QModelIndex(), first, last);
+    }
+
+    ~InsertGuard() {
+        model->endInsertRows();
+        if (model->rowCount() != expectedRows) {
+            model->beginResetModel();
+            model->endResetModel();
+        }
+    }
+
+    InsertGuard(const InsertGuard&) = delete;
+    InsertGuard& operator=(const InsertGuard&) = delete;
+
+private:
+    PlaylistModel* model;
+    int expectedRows;
+};
+
+PlaylistModel::PlaylistModel(MusicPlaylist& playlist, QObject *parent)
+    : QAbstractListModel(parent), playlist(playlist) {
+}
+
+int PlaylistModel::rowCount(const QModelIndex& parent) const {
+    // Flat list: only the invisible root has children
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(playlist.size());
+}
+
+QVariant PlaylistModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(playlist.size())) {
+        return QVariant();
+    }
+
+    const size_t row = static_cast<size_t>(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        // Painted for every visible row, so avoid unpacking the whole record
+        return playlist.entries().displayName(playlist.slotAt(row));
+    case Qt::ToolTipRole: {
+        const TrackInfo info = playlist.getDisplayInfo(row);
+        QString tip = playlist.getItem(row).toLocalFile();
+        if (!info.album.isEmpty()) {
+            tip += "\nAlbum: " + info.album;
+        }
+        if (info.durationMs > 0) {
+            tip += "\nLength: " + info.durationText();
+        }
+        return tip;
+    }
+    // Single fields come straight from the storage columns
+    case ArtistRole:
+        return playlist.entries().artist(playlist.slotAt(row)).toString();
+    case AlbumRole:
+        return playlist.entries().album(playlist.slotAt(row)).toString();
+    case DurationRole:
+        return playlist.entries().durationMs(playlist.slotAt(row));
+    default:
+        return QVariant();
+    }
+}
+
+bool PlaylistModel::addTrack(const QUrl& url, const QString& name) {
+    if (playlist.contains(url)) {
+        return false;
+    }
+
+    const TrackInfo info(name);
+    const int row = static_cast<int>(playlist.size());
+    InsertGuard insert(this, row, row);
+    playlist.addItem(url, info);
+    searchIndex.add(playlist.idAt(static_cast<size_t>(row)), info.searchText());
+    return true;
+}
+
+int PlaylistModel::addTracks(const QList<ScannedTrack>& tracks) {
+    TRACE_SCOPE("PlaylistModel::addTracks");
+    // Views need the exact row count before the insert, so drop tracks that
+    // are already in the playlist (or repeated within the batch) first
+    QList<const ScannedTrack*> fresh;
+    fresh.reserve(tracks.size());
+    QSet<QUrl> seen;
+    for (const ScannedTrack& track : tracks) {
+        if (!playlist.contains(track.url) && !seen.contains(track.url)) {
+            seen.insert(track.url);
+            fresh.append(&track);
+        }
+    }
+
+    if (fresh.isEmpty()) {
+        return 0;
+    }
+
+    // Grow first, so running out of memory here leaves views untouched
+    playlist.reserve(playlist.size() + static_cast<size_t>(fresh.size()));
+    searchIndex.reserve(playlist.size() + static_cast<size_t>(fresh.size()));
+
+    const int first = static_cast<int>(playlist.size());
+    InsertGuard insert(this, first, first + static_cast<int>(fresh.size()) - 1);
+    for (const ScannedTrack* track : fresh) {
+        const TrackInfo info(track->name);
+        playlist.addItem(track->url, info, track->added);
+        searchIndex.add(playlist.idAt(playlist.size() - 1), info.searchText());
+    }
+    return static_cast<int>(fresh.size());
+}
+
+bool PlaylistModel::removeTrack(int row) {
+    if (row < 0 || row >= static_cast<int>(playlist.size())) {
+        return false;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    searchIndex.remove(playlist.idAt(static_cast<size_t>(row)));
+    sorter.invalidate(playlist.idAt(static_cast<size_t>(row)));
+    playlist.removeAt(static_cast<size_t>(row));
+    endRemoveRows();
+    return true;
+}
+
+int PlaylistModel::removeTracks(const std::vector<int>& rows) {
+    TRACE_SCOPE("PlaylistModel::removeTracks");
+    std::vector<size_t> valid;
+    valid.reserve(rows.size());
+    for (int row : rows) {
+        if (row >= 0 && row < static_cast<int>(playlist.size())) {
+            valid.push_back(static_cast<size_t>(row));
+        }
+    }
+    std::sort(valid.begin(), valid.end());
+    valid.erase(std::unique(valid.begin(), valid.end()), valid.end());
+    if (valid.empty()) {
+        return 0;
+    }
+
+    // Contiguous runs as [first, last] pairs
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (size_t row : valid) {
+        if (!ranges.empty() && ranges.back().second + 1 == row) {
+            ranges.back().second = row;
+        } else {
+            ranges.emplace_back(row, row);
+        }
+    }
+
+    for (size_t row : valid) {
+        searchIndex.remove(playlist.idAt(row));
+        sorter.invalidate(playlist.idAt(row));
+    }
+
+    if (ranges.size() > MaxRemoveRanges) {
+        beginResetModel();
+        playlist.removeRows(valid);
+        endResetModel();
+    } else {
+        // Back to front so earlier ranges keep their row numbers
+        for (auto it = ranges.rbegin(); it != ranges.rend(); ++it) {
+            beginRemoveRows(QModelIndex(), static_cast<int>(it->first), static_cast<int>(it->second));
+            std::vector<size_t> range;
+            for (size_t row = it->first; row <= it->second; ++row) {
+                range.push_back(row);
+            }
+            playlist.removeRows(range);
+            endRemoveRows();
+        }
+    }
+    return static_cast<int>(valid.size());
+}
+
+void PlaylistModel::setTrackInfo(int row, const TrackInfo& info) {
+    if (row < 0 || row >= static_cast<int>(playlist.size())) {
+        return;
+    }
+
+    // Loudness results and the like leave the searchable text untouched
+    const QString text = info.searchText();
+    if (playlist.getDisplayInfo(static_cast<size_t>(row)).searchText() != text) {
+        searchIndex.update(playlist.idAt(static_cast<size_t>(row)), text);
+        sorter.invalidate(playlist.idAt(static_cast<size_t>(row)));
+    }
+
+    playlist.setDisplayInfo(static_cast<size_t>(row), info);
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed);
+}
+
+std::vector<int> PlaylistModel::search(const QString& query) const {
+    std::vector<int> rows;
+    const std::vector<quint64> matches = searchIndex.search(query);
+    rows.reserve(matches.size());
+    for (quint64 id : matches) {
+        const int row = playlist.rowOf(id);
+        if (row >= 0) {
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+void PlaylistModel::sortTracks(const QList<SortKey>& keys) {
+    TRACE_SCOPE("PlaylistModel::sortTracks");
+    if (keys.isEmpty() || playlist.size() < 2) {
+        return;
+    }
+
+    std::vector<SortEntry> entries;
+    entries.reserve(playlist.size());
+    const TrackStorage& columns = playlist.entries();
+    for (size_t row = 0; row < playlist.size(); ++row) {
+        const std::uint32_t slot = playlist.slotAt(row);
+        entries.push_back(SortEntry{playlist.idAt(row), columns.durationMs(slot), playlist.addedSequence(row)});
+    }
+
+    // Sort by title, falling back to the file name for untagged tracks
+    const std::vector<size_t> rows = sorter.order(entries, keys, [this, &columns](size_t row) {
+        const std::uint32_t slot = playlist.slotAt(row);
+        const QStringView title = columns.title(slot);
+        return SortText{(title.isEmpty() ? columns.fileName(slot) : title).toString(),
+                        columns.artist(slot).toString(), columns.album(slot).toString()};
+    });
+
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    playlist.reorder(rows);
+
+    // Keep selections and current items of attached views on their tracks
+    std::vector<int> newRow(rows.size());
+    for (size_t row = 0; row < rows.size(); ++row) {
+        newRow[rows[row]] = static_cast<int>(row);
+    }
+    const QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    to.reserve(from.size());
+    for (const QModelIndex& index : from) {
+        to.append(index.isValid() ? this->index(newRow[static_cast<size_t>(index.row())]) : QModelIndex());
+    }
+    changePersistentIndexList(from, to);
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+PlaylistSearchModel::PlaylistSearchModel(PlaylistModel *source, QObject *parent)
+    : QAbstractListModel(parent), source(source), refreshPending(false) {
+    // Removals shift the rows we point at, so re-query right away; appends
+    // and tag updates (which arrive in bulk) fold into one deferred refresh
+    connect(source, &QAbstractItemModel::rowsRemoved, this, [this]() {
+        if (!currentQuery.isEmpty()) {
+            refresh();
+        }
+    });
+    connect(source, &QAbstractItemModel::modelReset, this, &PlaylistSearchModel::refresh);
+    connect(source, &QAbstractItemModel::layoutChanged, this, &PlaylistSearchModel::refresh);
+    connect(source, &QAbstractItemModel::rowsInserted, this, &PlaylistSearchModel::scheduleRefresh);
+    connect(source, &QAbstractItemModel::dataChanged, this, &PlaylistSearchModel::scheduleRefresh);
+}
+
+int PlaylistSearchModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(rows.size());
+}
+
+QVariant PlaylistSearchModel::data(const QModelIndex& index, int role) const {
+    const int row = index.isValid() ? sourceRow(index.row()) : -1;
+    if (row < 0) {
+        return QVariant();
+    }
+    return source->data(source->index(row), role);
+}
+
+void PlaylistSearchModel::setQuery(const QString& query) {
+    currentQuery = query;
+    refresh();
+}
+
+int PlaylistSearchModel::sourceRow(int row) const {
+    if (row < 0 || row >= static_cast<int>(rows.size())) {
+        return -1;
+    }
+    return rows[static_cast<size_t>(row)];
+}
+
+void PlaylistSearchModel::scheduleRefresh() {
+    if (refreshPending || currentQuery.isEmpty()) {
+        return;
+    }
+    refreshPending = true;
+    QTimer::singleShot(100, this, &PlaylistSearchModel::refresh);
+}
+
+void PlaylistSearchModel::refresh() {
+    refreshPending = false;
+    beginResetModel();
+    rows = source->search(currentQuery);
+    endResetModel();
+}
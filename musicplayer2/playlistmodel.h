@@ -0,0 +1,97 @@
+#ifndef PLAYLISTMODEL_H
+#define PLAYLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QString>
+#include <QUrl>
+#include <vector>
+#include "playlistmanager.h"
+#include "playlistsorter.h"
+#include "libraryscanner.h"
+#include "searchindex.h"
+#include "trackinfo.h"
+#include "trackstorage.h"
+
+// The playlist type used by the player: local file URLs with their tag
+// records, packed column-wise by TrackStorage
+using MusicPlaylist = PlaylistManager<QUrl, TrackInfo, QtHasher<QUrl>, TrackStorage>;
+
+// List model that reads rows straight out of the PlaylistManager storage, so
+// views only materialize the rows they actually paint. All playlist mutations
+// should go through this model so attached views receive row signals.
+class PlaylistModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    // Extra roles exposing the individual tag fields
+    enum TrackRoles {
+        ArtistRole = Qt::UserRole + 1,
+        AlbumRole,
+        DurationRole
+    };
+
+    explicit PlaylistModel(MusicPlaylist& playlist, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    // Add a single track; returns false if it is already in the playlist
+    bool addTrack(const QUrl& url, const QString& name);
+
+    // Add a batch with one row insertion; returns the number of new tracks
+    int addTracks(const QList<ScannedTrack>& tracks);
+
+    // Remove the track at row
+    bool removeTrack(int row);
+
+    // Remove many rows at once; returns the number removed. Scattered
+    // selections reset the model instead of signalling every range.
+    int removeTracks(const std::vector<int>& rows);
+
+    // Replace the tag record shown for row
+    void setTrackInfo(int row, const TrackInfo& info);
+
+    // Rows whose text matches query, best match first
+    std::vector<int> search(const QString& query) const;
+
+    // Reorder the playlist by keys (stable); entry ids are unaffected
+    void sortTracks(const QList<SortKey>& keys);
+
+private:
+    class InsertGuard;
+
+    MusicPlaylist& playlist;
+    SearchIndex searchIndex;
+    PlaylistSorter sorter;
+};
+
+// Read-only view of the playlist rows matching a search query. Results are
+// recomputed from the index when the query changes; playlist changes while
+// a query is active are coalesced into one refresh.
+class PlaylistSearchModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit PlaylistSearchModel(PlaylistModel *source, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    void setQuery(const QString& query);
+    QString query() const { return currentQuery; }
+
+    // Playlist row shown at row, or -1
+    int sourceRow(int row) const;
+
+private:
+    void scheduleRefresh();
+    void refresh();
+
+    PlaylistModel *source;
+    QString currentQuery;
+    std::vector<int> rows;
+    bool refreshPending;
+};
+
+#endif // PLAYLISTMODEL_H
@@ -0,0 +1,151 @@
+#include "playlistsorter.h"
+
+#include <QCollator>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <optional>
+
+namespace {
+
+// Below this many rows the thread hand-off costs more than it saves
+const size_t ParallelThreshold = 16384;
+
+// Entries per collation task; each task builds its own QCollator
+const size_t CollationChunk = 2048;
+
+template <typename Less>
+void parallelStableSort(std::vector<quint32>& values, Less less) {
+    const size_t count = values.size();
+    const size_t threads = static_cast<size_t>(qMax(1, QThread::idealThreadCount()));
+    if (count < ParallelThreshold || threads < 2) {
+        std::stable_sort(values.begin(), values.end(), less);
+        return;
+    }
+
+    // Sorted runs as [begin, end)
+    std::vector<std::pair<size_t, size_t>> runs;
+    const size_t runLength = (count + threads - 1) / threads;
+    for (size_t begin = 0; begin < count; begin += runLength) {
+        runs.emplace_back(begin, std::min(count, begin + runLength));
+    }
+    QtConcurrent::blockingMap(runs, [&values, &less](const std::pair<size_t, size_t>& run) {
+        std::stable_sort(values.begin() + run.first, values.begin() + run.second, less);
+    });
+
+    // Merge neighbouring runs until one is left; std::merge prefers the left
+    // run on ties, which keeps the result stable
+    std::vector<quint32> buffer(count);
+    struct Merge {
+        size_t begin;
+        size_t middle;
+        size_t end;
+    };
+    while (runs.size() > 1) {
+        std::vector<Merge> merges;
+        std::vector<std::pair<size_t, size_t>> merged;
+        for (size_t i = 0; i < runs.size(); i += 2) {
+            const size_t end = i + 1 < runs.size() ? runs[i + 1].second : runs[i].second;
+            merges.push_back(Merge{runs[i].first, runs[i].second, end});
+            merged.emplace_back(runs[i].first, end);
+        }
+        QtConcurrent::blockingMap(merges, [&values, &buffer, &less](const Merge& merge) {
+            std::merge(values.begin() + merge.begin, values.begin() + merge.middle,
+                       values.begin() + merge.middle, values.begin() + merge.end,
+                       buffer.begin() + merge.begin, less);
+        });
+        values.swap(buffer);
+        runs.swap(merged);
+    }
+}
+
+} // namespace
+
+std::vector<size_t> PlaylistSorter::order(const std::vector<SortEntry>& entries, const QList<SortKey>& keys,
+                                          const TextProvider& textOf) {
+    const bool needsText = std::any_of(keys.begin(), keys.end(), [](const SortKey& key) {
+        return key.field == SortField::Name || key.field == SortField::Artist || key.field == SortField::Album;
+    });
+
+    // Collation keys for entries sorted for the first time (or retagged)
+    std::vector<const CollationKeys*> collated(entries.size(), nullptr);
+    if (needsText) {
+        std::vector<size_t> missing;
+        std::vector<SortText> texts;
+        for (size_t row = 0; row < entries.size(); ++row) {
+            if (cache.find(entries[row].id) == cache.end()) {
+                missing.push_back(row);
+                texts.push_back(textOf(row));
+            }
+        }
+
+        std::vector<std::optional<CollationKeys>> built(missing.size());
+        std::vector<std::pair<size_t, size_t>> chunks;
+        for (size_t begin = 0; begin < missing.size(); begin += CollationChunk) {
+            chunks.emplace_back(begin, std::min(missing.size(), begin + CollationChunk));
+        }
+        QtConcurrent::blockingMap(chunks, [&texts, &built](const std::pair<size_t, size_t>& chunk) {
+            // QCollator is not thread-safe, so every task gets its own
+            QCollator collator;
+            collator.setNumericMode(true);
+            collator.setCaseSensitivity(Qt::CaseInsensitive);
+            for (size_t i = chunk.first; i < chunk.second; ++i) {
+                built[i].emplace(CollationKeys{collator.sortKey(texts[i].name),
+                                               collator.sortKey(texts[i].artist),
+                                               collator.sortKey(texts[i].album)});
+            }
+        });
+
+        cache.reserve(cache.size() + missing.size());
+        for (size_t i = 0; i < missing.size(); ++i) {
+            cache.emplace(entries[missing[i]].id, std::move(*built[i]));
+        }
+        for (size_t row = 0; row < entries.size(); ++row) {
+            collated[row] = &cache.find(entries[row].id)->second;
+        }
+    }
+
+    auto less = [&entries, &collated, &keys](quint32 a, quint32 b) {
+        for (const SortKey& key : keys) {
+            int result = 0;
+            switch (key.field) {
+            case SortField::Name:
+                result = collated[a]->name.compare(collated[b]->name);
+                break;
+            case SortField::Artist:
+                result = collated[a]->artist.compare(collated[b]->artist);
+                break;
+            case SortField::Album:
+                result = collated[a]->album.compare(collated[b]->album);
+                break;
+            case SortField::Duration:
+                result = entries[a].durationMs < entries[b].durationMs ? -1
+                       : entries[a].durationMs > entries[b].durationMs ? 1 : 0;
+                break;
+            case SortField::DateAdded:
+                result = entries[a].added < entries[b].added ? -1
+                       : entries[a].added > entries[b].added ? 1 : 0;
+                break;
+            }
+            if (result != 0) {
+                return key.ascending ? result < 0 : result > 0;
+            }
+        }
+        return false;
+    };
+
+    std::vector<quint32> rows(entries.size());
+    for (size_t row = 0; row < rows.size(); ++row) {
+        rows[row] = static_cast<quint32>(row);
+    }
+    parallelStableSort(rows, less);
+    return std::vector<size_t>(rows.begin(), rows.end());
+}
+
+void PlaylistSorter::invalidate(quint64 id) {
+    cache.erase(id);
+}
+
+void PlaylistSorter::clear() {
+    cache.clear();
+}
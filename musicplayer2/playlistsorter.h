@@ -0,0 +1,68 @@
+#ifndef PLAYLISTSORTER_H
+#define PLAYLISTSORTER_H
+
+#include <QCollatorSortKey>
+#include <QList>
+#include <QString>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Fields the playlist can be sorted on
+enum class SortField {
+    Name,
+    Artist,
+    Album,
+    Duration,
+    DateAdded
+};
+
+// One level of a multi-key sort; later keys only break ties of earlier ones
+struct SortKey {
+    SortField field;
+    bool ascending = true;
+};
+
+// What the sorter needs to know about each playlist row
+struct SortEntry {
+    quint64 id;
+    qint64 durationMs;
+    quint32 added;
+};
+
+// Text fields collated for an entry
+struct SortText {
+    QString name;
+    QString artist;
+    QString album;
+};
+
+// Computes stable multi-key orderings of the playlist. Locale-aware
+// collation keys are built once per entry (in parallel) and cached by entry
+// id, so re-sorting only compares precomputed keys. The sort itself is a
+// parallel merge sort: chunks are stable-sorted on the global thread pool
+// and merged pairwise in parallel rounds.
+class PlaylistSorter {
+public:
+    using TextProvider = std::function<SortText(size_t row)>;
+
+    // Rows in sorted order, suitable for PlaylistManager::reorder. textOf is
+    // only called, on this thread, for rows without cached keys.
+    std::vector<size_t> order(const std::vector<SortEntry>& entries, const QList<SortKey>& keys,
+                              const TextProvider& textOf);
+
+    // Forget the cached keys of an entry whose text changed or was removed
+    void invalidate(quint64 id);
+    void clear();
+
+private:
+    struct CollationKeys {
+        QCollatorSortKey name;
+        QCollatorSortKey artist;
+        QCollatorSortKey album;
+    };
+
+    std::unordered_map<quint64, CollationKeys> cache;
+};
+
+#endif // PLAYLISTSORTER_H
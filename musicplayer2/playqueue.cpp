@@ -0,0 +1,248 @@
+#include "playqueue.h"
+#include <algorithm>
+#include <utility>
+
+PlayQueue::PlayQueue(const MusicPlaylist& playlist)
+    : playlist(playlist), currentId(MusicPlaylist::InvalidId), lastRow(-1), repeat(Repeat::Off), shuffled(false),
+      cursor(NoPosition), random(QRandomGenerator::global()->generate()) {
+}
+
+void PlayQueue::setShuffle(bool on) {
+    if (on == shuffled) {
+        return;
+    }
+    shuffled = on;
+    if (!on) {
+        std::vector<EntryId>().swap(order);
+        std::vector<std::uint32_t>().swap(positions);
+        cursor = NoPosition;
+        return;
+    }
+
+    // The permutation starts at the entry playing now
+    shuffleAll();
+    const std::uint32_t position = positionOf(currentId);
+    if (position != NoPosition) {
+        swapPositions(position, 0);
+        cursor = 0;
+    }
+}
+
+void PlayQueue::setCurrent(EntryId id) {
+    moveTo(id);
+    if (!shuffled || !playlist.isValid(id)) {
+        return;
+    }
+
+    std::uint32_t position = positionOf(id);
+    if (position == NoPosition) {
+        added(id);
+        position = positionOf(id);
+    }
+    const std::uint32_t target = cursor == NoPosition ? 0 : cursor + 1;
+    if (position >= target) {
+        // Pull it forward so the rest of the round stays unplayed
+        swapPositions(position, target);
+        cursor = target;
+    } else {
+        // Already played this round: it takes the old current entry's place
+        swapPositions(position, cursor);
+    }
+}
+
+PlayQueue::EntryId PlayQueue::peekNext() const {
+    if (repeat == Repeat::One && playlist.isValid(currentId)) {
+        return currentId;
+    }
+    const bool wrap = repeat != Repeat::Off;
+    if (!shuffled) {
+        return linearNext(wrap);
+    }
+    const std::uint32_t position = nextPosition(wrap);
+    return position != NoPosition ? order[position] : MusicPlaylist::InvalidId;
+}
+
+PlayQueue::EntryId PlayQueue::advance(bool skip) {
+    if (repeat == Repeat::One && !skip && playlist.isValid(currentId)) {
+        return currentId;
+    }
+    // Skipping out of a repeated track carries on like repeat-all
+    const bool wrap = repeat != Repeat::Off;
+    if (!shuffled) {
+        const EntryId next = linearNext(wrap);
+        if (next != MusicPlaylist::InvalidId) {
+            moveTo(next);
+        }
+        return next;
+    }
+
+    if (order.size() > 2 * playlist.size() + 64) {
+        compact();
+    }
+    const std::uint32_t position = nextPosition(wrap);
+    if (position == NoPosition) {
+        return MusicPlaylist::InvalidId;
+    }
+    if (cursor != NoPosition && position <= cursor) {
+        // A new round gets a fresh permutation; the entry peekNext already
+        // promised (and may have pre-rolled) goes first
+        const EntryId next = order[position];
+        shuffleAll();
+        swapPositions(positionOf(next), 0);
+        cursor = 0;
+    } else {
+        cursor = position;
+    }
+    moveTo(order[cursor]);
+    return currentId;
+}
+
+PlayQueue::EntryId PlayQueue::previous() {
+    if (!shuffled) {
+        // A removed current entry sits between the rows around its old one
+        const int row = currentRow();
+        const int before = row >= 0 ? row - 1 : std::min(lastRow, static_cast<int>(playlist.size())) - 1;
+        if (before >= 0) {
+            moveTo(playlist.idAt(static_cast<size_t>(before)));
+        } else if (!playlist.isEmpty() && (row < 0 || repeat != Repeat::Off)) {
+            moveTo(playlist.idAt(row < 0 ? 0 : playlist.size() - 1));
+        }
+        return playlist.isValid(currentId) ? currentId : MusicPlaylist::InvalidId;
+    }
+
+    // Step back through what was played this round
+    if (cursor != NoPosition) {
+        for (std::uint32_t position = cursor; position-- > 0;) {
+            if (isLive(position)) {
+                cursor = position;
+                moveTo(order[cursor]);
+                return currentId;
+            }
+        }
+    }
+    // Nothing before it: start the current entry over
+    return playlist.isValid(currentId) ? currentId : advance(true);
+}
+
+void PlayQueue::added(EntryId id) {
+    if (!shuffled) {
+        return;
+    }
+    if (order.size() > 2 * playlist.size() + 64) {
+        compact();
+    }
+
+    // Inside-out Fisher-Yates over the unplayed part of the round
+    const std::uint32_t last = static_cast<std::uint32_t>(order.size());
+    order.push_back(id);
+    place(last, id);
+    const std::uint32_t first = cursor == NoPosition ? 0 : cursor + 1;
+    swapPositions(last, first + random.bounded(last - first + 1));
+}
+
+void PlayQueue::moveTo(EntryId id) {
+    currentId = id;
+    lastRow = playlist.rowOf(id);
+}
+
+int PlayQueue::currentRow() const {
+    // Rows shift as others are removed or moved, so look again each time
+    const int row = playlist.rowOf(currentId);
+    if (row >= 0) {
+        lastRow = row;
+    }
+    return row;
+}
+
+bool PlayQueue::isLive(std::uint32_t position) const {
+    return playlist.isValid(order[position]);
+}
+
+std::uint32_t PlayQueue::positionOf(EntryId id) const {
+    const std::uint32_t slot = MusicPlaylist::slotOf(id);
+    if (slot >= positions.size()) {
+        return NoPosition;
+    }
+    const std::uint32_t position = positions[slot];
+    return position < order.size() && order[position] == id ? position : NoPosition;
+}
+
+void PlayQueue::place(std::uint32_t position, EntryId id) {
+    order[position] = id;
+    const std::uint32_t slot = MusicPlaylist::slotOf(id);
+    if (slot >= positions.size()) {
+        positions.resize(slot + 1, NoPosition);
+    }
+    positions[slot] = position;
+}
+
+void PlayQueue::swapPositions(std::uint32_t a, std::uint32_t b) {
+    const EntryId first = order[a];
+    const EntryId second = order[b];
+    place(a, second);
+    place(b, first);
+}
+
+PlayQueue::EntryId PlayQueue::linearNext(bool wrap) const {
+    // A removed current entry continues with the one that followed it
+    const int row = currentRow();
+    const size_t next = static_cast<size_t>(row >= 0 ? row + 1 : std::max(lastRow, 0));
+    if (next < playlist.size()) {
+        return playlist.idAt(next);
+    }
+    return wrap && !playlist.isEmpty() ? playlist.idAt(0) : MusicPlaylist::InvalidId;
+}
+
+std::uint32_t PlayQueue::nextPosition(bool wrap) const {
+    const std::uint32_t size = static_cast<std::uint32_t>(order.size());
+    const std::uint32_t start = cursor == NoPosition ? 0 : cursor + 1;
+    for (std::uint32_t position = start; position < size; ++position) {
+        if (isLive(position)) {
+            return position;
+        }
+    }
+    if (wrap) {
+        for (std::uint32_t position = 0; position < start && position < size; ++position) {
+            if (isLive(position)) {
+                return position;
+            }
+        }
+    }
+    return NoPosition;
+}
+
+void PlayQueue::shuffleAll() {
+    const std::vector<EntryId>& ids = playlist.ids();
+    order.assign(ids.begin(), ids.end());
+    for (size_t i = order.size(); i > 1; --i) {
+        const size_t j = random.bounded(static_cast<quint32>(i));
+        std::swap(order[i - 1], order[j]);
+    }
+    positions.assign(positions.size(), NoPosition);
+    for (size_t position = 0; position < order.size(); ++position) {
+        place(static_cast<std::uint32_t>(position), order[position]);
+    }
+    cursor = NoPosition;
+}
+
+void PlayQueue::compact() {
+    // Drop stale ids, keeping the order of the rest and the current position
+    std::vector<EntryId> live;
+    live.reserve(playlist.size());
+    std::uint32_t newCursor = NoPosition;
+    for (std::uint32_t position = 0; position < order.size(); ++position) {
+        if (!isLive(position)) {
+            continue;
+        }
+        if (cursor != NoPosition && position <= cursor) {
+            newCursor = static_cast<std::uint32_t>(live.size());
+        }
+        live.push_back(order[position]);
+    }
+    order.swap(live);
+    positions.assign(positions.size(), NoPosition);
+    for (size_t position = 0; position < order.size(); ++position) {
+        place(static_cast<std::uint32_t>(position), order[position]);
+    }
+    cursor = newCursor;
+}
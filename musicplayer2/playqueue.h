@@ -0,0 +1,87 @@
+#ifndef PLAYQUEUE_H
+#define PLAYQUEUE_H
+
+#include <QRandomGenerator>
+#include <cstdint>
+#include <vector>
+#include "playlistmodel.h"
+
+// Decides what plays after (or before) the current entry: in playlist order,
+// or through a shuffled permutation, with repeat-one/all. Entries are held
+// by id, so sorting or deleting rows never confuses it. When the current
+// entry itself is removed, playlist order continues with the entry that
+// followed it.
+//
+// The shuffle order is a Fisher-Yates permutation built once when shuffle is
+// switched on. New entries are swapped into a random upcoming position (one
+// inside-out Fisher-Yates step), so the unplayed part stays uniformly
+// shuffled. Removed entries are not looked for: their ids go stale and are
+// skipped, and the order is compacted once they make up half of it. A
+// per-slot position table makes finding an entry O(1), so advancing is O(1)
+// amortized however long the playlist is.
+class PlayQueue {
+public:
+    using EntryId = MusicPlaylist::EntryId;
+
+    enum class Repeat {
+        Off,
+        All,
+        One
+    };
+
+    explicit PlayQueue(const MusicPlaylist& playlist);
+
+    bool isShuffled() const { return shuffled; }
+    void setShuffle(bool on);
+
+    Repeat repeatMode() const { return repeat; }
+    void setRepeat(Repeat mode) { repeat = mode; }
+
+    // The entry now playing, e.g. picked by the user; a shuffle continues
+    // from it without replaying what came before
+    void setCurrent(EntryId id);
+    EntryId current() const { return currentId; }
+
+    // What follows the current entry when it ends, without moving there;
+    // InvalidId at the end of the playlist
+    EntryId peekNext() const;
+
+    // Move on and return the new current entry (InvalidId at the end).
+    // A skip is the user pressing Next, which leaves a repeated track.
+    EntryId advance(bool skip);
+    EntryId previous();
+
+    // Call for each entry added to the playlist; removals need no call
+    void added(EntryId id);
+
+private:
+    static constexpr std::uint32_t NoPosition = 0xffffffffu;
+
+    void moveTo(EntryId id);
+    int currentRow() const;
+    bool isLive(std::uint32_t position) const;
+    std::uint32_t positionOf(EntryId id) const;
+    void place(std::uint32_t position, EntryId id);
+    void swapPositions(std::uint32_t a, std::uint32_t b);
+    EntryId linearNext(bool wrap) const;
+    std::uint32_t nextPosition(bool wrap) const;
+    void shuffleAll();
+    void compact();
+
+    const MusicPlaylist& playlist;
+    EntryId currentId;
+    // Row the current entry was last seen at; once it is removed, the entry
+    // that followed it has moved up into this row. -1 before the first.
+    mutable int lastRow;
+    Repeat repeat;
+    bool shuffled;
+
+    // Shuffle state: the permutation, where each slot sits in it, and the
+    // position of the current entry (NoPosition before the first)
+    std::vector<EntryId> order;
+    std::vector<std::uint32_t> positions;
+    std::uint32_t cursor;
+    QRandomGenerator random;
+};
+
+#endif // PLAYQUEUE_H
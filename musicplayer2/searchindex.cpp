@@ -0,0 +1,182 @@
+#include "searchindex.h"
+
+#include <QStringList>
+#include <algorithm>
+
+namespace {
+
+quint64 packTrigram(QChar a, QChar b, QChar c) {
+    return (quint64(a.unicode()) << 32) | (quint64(b.unicode()) << 16) | quint64(c.unicode());
+}
+
+} // namespace
+
+QString SearchIndex::normalize(const QString& text) {
+    // Decompose so accents become separate marks, then keep letters and
+    // digits only, case-folded; everything else separates words
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString result;
+    result.reserve(decomposed.size());
+    for (QChar c : decomposed) {
+        if (c.isMark()) {
+            continue;
+        }
+        result.append(c.isLetterOrNumber() ? c.toCaseFolded() : QChar(' '));
+    }
+    return result;
+}
+
+void SearchIndex::collectTrigrams(const QString& normalized, bool padShortWords, std::vector<quint64>& out) {
+    const QStringList words = normalized.split(' ', Qt::SkipEmptyParts);
+    for (const QString& word : words) {
+        // Two leading pads: "ab" yields "  a" and " ab", so short queries
+        // match word prefixes
+        if (padShortWords || word.size() < 3) {
+            out.push_back(packTrigram(' ', ' ', word[0]));
+            if (word.size() >= 2) {
+                out.push_back(packTrigram(' ', word[0], word[1]));
+            }
+        }
+        for (qsizetype i = 0; i + 2 < word.size(); ++i) {
+            out.push_back(packTrigram(word[i], word[i + 1], word[i + 2]));
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+void SearchIndex::reserve(size_t count) {
+    documents.reserve(count);
+    ids.reserve(static_cast<qsizetype>(count));
+}
+
+void SearchIndex::add(quint64 key, const QString& text) {
+    if (ids.contains(key)) {
+        update(key, text);
+        return;
+    }
+
+    const quint32 id = static_cast<quint32>(documents.size());
+    documents.push_back(Document{key, true});
+    ids.insert(key, id);
+
+    // Ids only grow, so appending keeps every posting list sorted
+    std::vector<quint64> trigrams;
+    collectTrigrams(normalize(text), true, trigrams);
+    for (quint64 trigram : trigrams) {
+        postings[trigram].push_back(id);
+    }
+}
+
+void SearchIndex::remove(quint64 key) {
+    auto it = ids.find(key);
+    if (it == ids.end()) {
+        return;
+    }
+    documents[it.value()].alive = false;
+    ids.erase(it);
+    ++deadCount;
+
+    if (deadCount > documents.size() / 2) {
+        compact();
+    }
+}
+
+void SearchIndex::update(quint64 key, const QString& text) {
+    remove(key);
+    add(key, text);
+}
+
+void SearchIndex::clear() {
+    documents.clear();
+    ids.clear();
+    postings.clear();
+    deadCount = 0;
+    hits = std::vector<quint16>();
+}
+
+void SearchIndex::compact() {
+    // Renumber live documents densely and drop dead ids from every list
+    std::vector<quint32> remap(documents.size(), 0);
+    std::vector<Document> live;
+    live.reserve(documents.size() - deadCount);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        if (documents[i].alive) {
+            remap[i] = static_cast<quint32>(live.size());
+            ids[documents[i].key] = remap[i];
+            live.push_back(documents[i]);
+        }
+    }
+
+    for (auto it = postings.begin(); it != postings.end();) {
+        std::vector<quint32>& list = it->second;
+        size_t out = 0;
+        for (quint32 id : list) {
+            if (documents[id].alive) {
+                list[out++] = remap[id];
+            }
+        }
+        list.resize(out);
+        if (list.empty()) {
+            it = postings.erase(it);
+        } else {
+            list.shrink_to_fit();
+            ++it;
+        }
+    }
+
+    documents.swap(live);
+    deadCount = 0;
+}
+
+std::vector<quint64> SearchIndex::search(const QString& query) const {
+    std::vector<quint64> results;
+    std::vector<quint64> trigrams;
+    collectTrigrams(normalize(query), false, trigrams);
+    if (trigrams.empty()) {
+        return results;
+    }
+
+    // Allow roughly one missed trigram in four for longer queries
+    const size_t total = trigrams.size();
+    const size_t required = total <= 3 ? total : total - std::max<size_t>(1, total / 4);
+
+    // Count hits per document across the posting lists of the query. The
+    // buffer outlives the query, so a keystroke costs the lists it touches
+    // rather than a playlist-sized allocation; new documents start at zero.
+    if (hits.size() < documents.size()) {
+        hits.resize(documents.size(), 0);
+    }
+    touched.clear();
+    for (quint64 trigram : trigrams) {
+        auto it = postings.find(trigram);
+        if (it == postings.end()) {
+            continue;
+        }
+        for (quint32 id : it->second) {
+            if (hits[id]++ == 0) {
+                touched.push_back(id);
+            }
+        }
+    }
+
+    std::vector<std::pair<quint16, quint32>> ranked;
+    for (quint32 id : touched) {
+        if (hits[id] >= required && documents[id].alive) {
+            ranked.emplace_back(hits[id], id);
+        }
+        hits[id] = 0;
+    }
+
+    // Most trigrams matched first, then by document id: insertion order,
+    // with updated entries counted as added when they were last updated
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+    results.reserve(ranked.size());
+    for (const auto& entry : ranked) {
+        results.push_back(documents[entry.second].key);
+    }
+    return results;
+}
@@ -0,0 +1,58 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <unordered_map>
+#include <vector>
+
+// Trigram index for as-you-type playlist search. Each entry's text is
+// case-folded, stripped of accents and split into words; every word is
+// indexed by its trigrams, plus two padded ones at the start so one- and
+// two-letter queries match word prefixes.
+//
+// Queries count trigram hits per entry from the posting lists, so a query
+// costs the size of the lists it touches rather than the playlist size.
+// Entries missing a few of a longer query's trigrams still match, which
+// absorbs small typos; exact matches rank first.
+//
+// Entries are keyed by the caller's stable ids (playlist entry ids).
+// add/remove/update are incremental. Removed entries are tombstoned and the
+// posting lists are compacted once more than half of the entries are dead.
+class SearchIndex {
+public:
+    SearchIndex() : deadCount(0) {}
+
+    void reserve(size_t count);
+    void add(quint64 key, const QString& text);
+    void remove(quint64 key);
+    void update(quint64 key, const QString& text);
+    void clear();
+
+    // Matching keys, best match first; among equal matches, the entry added
+    // (or last updated) earliest comes first. Reuses scratch buffers, so one
+    // index must not be searched from two threads at once.
+    std::vector<quint64> search(const QString& query) const;
+
+private:
+    struct Document {
+        quint64 key;
+        bool alive;
+    };
+
+    static QString normalize(const QString& text);
+    static void collectTrigrams(const QString& normalized, bool padShortWords, std::vector<quint64>& out);
+    void compact();
+
+    std::vector<Document> documents;
+    QHash<quint64, quint32> ids;
+    std::unordered_map<quint64, std::vector<quint32>> postings;
+    size_t deadCount;
+
+    // Per-document hit counts of the running query, all zero between
+    // queries, and the documents whose count it raised
+    mutable std::vector<quint16> hits;
+    mutable std::vector<quint32> touched;
+};
+
+#endif // SEARCHINDEX_H
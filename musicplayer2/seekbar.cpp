@@ -0,0 +1,101 @@
+#include "seekbar.h"
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QSlider>
+#include <QTimer>
+#include <climits>
+
+namespace {
+
+// Reports older than this may still describe the spot before a seek
+const int SettleMs = 500;
+
+QString formatTime(qint64 ms) {
+    const qint64 seconds = qMax<qint64>(0, ms) / 1000;
+    if (seconds >= 3600) {
+        return QString("%1:%2:%3").arg(seconds / 3600).arg(seconds / 60 % 60, 2, 10, QChar('0'))
+                                  .arg(seconds % 60, 2, 10, QChar('0'));
+    }
+    return QString("%1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0'));
+}
+
+} // namespace
+
+SeekBar::SeekBar(QWidget *parent)
+    : QWidget(parent), duration(0), pendingSeek(-1), lastSent(-1), updating(false) {
+    slider = new QSlider(Qt::Horizontal);
+    slider->setFocusPolicy(Qt::StrongFocus);
+    slider->setSingleStep(FineStepMs);
+    slider->setPageStep(CoarseStepMs);
+    slider->setEnabled(false);
+    timeLabel = new QLabel();
+
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(slider, 1);
+    layout->addWidget(timeLabel);
+
+    seekTimer = new QTimer(this);
+    seekTimer->setInterval(SeekIntervalMs);
+    connect(seekTimer, &QTimer::timeout, this, &SeekBar::sendPending);
+
+    // Every user change comes through valueChanged; ours are flagged
+    connect(slider, &QSlider::valueChanged, this, &SeekBar::requestSeek);
+    connect(slider, &QSlider::sliderReleased, this, [this]() {
+        seekTimer->stop();
+        sendPending();
+        pendingSeek = lastSent = -1;
+    });
+
+    showTime(0);
+}
+
+void SeekBar::setDuration(qint64 ms) {
+    duration = qMax<qint64>(0, ms);
+    updating = true;
+    slider->setRange(0, static_cast<int>(qMin<qint64>(duration, INT_MAX)));
+    updating = false;
+    slider->setEnabled(duration > 0);
+    showTime(slider->value());
+}
+
+void SeekBar::setPosition(qint64 ms) {
+    if (slider->isSliderDown() || (sinceSeek.isValid() && sinceSeek.elapsed() < SettleMs)) {
+        return;
+    }
+    updating = true;
+    slider->setValue(static_cast<int>(qMin<qint64>(ms, INT_MAX)));
+    updating = false;
+    showTime(ms);
+}
+
+void SeekBar::requestSeek(int ms) {
+    if (updating) {
+        return;
+    }
+    pendingSeek = ms;
+    sinceSeek.start();
+    showTime(ms);
+
+    // The first move goes out at once; later ones wait for the timer
+    if (!seekTimer->isActive()) {
+        sendPending();
+        seekTimer->start();
+    }
+}
+
+void SeekBar::sendPending() {
+    if (pendingSeek < 0 || pendingSeek == lastSent) {
+        // Nothing new since the last one: the burst is over
+        seekTimer->stop();
+        pendingSeek = lastSent = -1;
+        return;
+    }
+    lastSent = pendingSeek;
+    sinceSeek.start();
+    emit seekRequested(pendingSeek);
+}
+
+void SeekBar::showTime(qint64 ms) {
+    timeLabel->setText(formatTime(ms) + " / " + formatTime(duration));
+}
@@ -0,0 +1,52 @@
+#ifndef SEEKBAR_H
+#define SEEKBAR_H
+
+#include <QElapsedTimer>
+#include <QWidget>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QSlider;
+class QTimer;
+QT_END_NAMESPACE
+
+// Position slider and time readout for the current track. Whatever the user
+// does to the slider (drag, click, wheel, arrow keys for 1 s steps, page
+// keys for 10 s) becomes seekRequested: the first move at once, then at most
+// one per SeekIntervalMs with only the latest target, and the final target
+// on release. Scrubbing a long FLAC or MP4 thus costs a handful of backend
+// seeks instead of one per mouse move. Position reports are ignored while
+// the handle is held and shortly after a seek, so it does not jump back.
+class SeekBar : public QWidget {
+    Q_OBJECT
+
+public:
+    static constexpr int SeekIntervalMs = 150;
+    static constexpr int FineStepMs = 1000;
+    static constexpr int CoarseStepMs = 10000;
+
+    explicit SeekBar(QWidget *parent = nullptr);
+
+    void setPosition(qint64 ms);
+    // Unknown (negative) or zero disables seeking
+    void setDuration(qint64 ms);
+
+signals:
+    void seekRequested(qint64 ms);
+
+private:
+    void requestSeek(int ms);
+    void sendPending();
+    void showTime(qint64 ms);
+
+    QSlider *slider;
+    QLabel *timeLabel;
+    QTimer *seekTimer;
+    QElapsedTimer sinceSeek;
+    qint64 duration;
+    qint64 pendingSeek;
+    qint64 lastSent;
+    bool updating;
+};
+
+#endif // SEEKBAR_H
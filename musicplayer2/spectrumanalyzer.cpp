@@ -0,0 +1,249 @@
+#include "spectrumanalyzer.h"
+#include "dspkernels.h"
+#include <QAudioBuffer>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Shown range of the bars
+const float LowestHz = 40.0f;
+const float HighestHz = 16000.0f;
+const float FloorDb = -70.0f;
+
+// Bars fall back over about two thirds of a second
+const float DecayPerFrame = 1.5f / SpectrumAnalyzer::FramesPerSecond;
+
+} // namespace
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : timer(nullptr), writePos(0), sampleRate(48000), active(false), analyzedPos(0), sequence(0),
+      middle(1), back(0), front(2) {
+    for (std::atomic<float>& sample : ring) {
+        sample.store(0.0f, std::memory_order_relaxed);
+    }
+
+    // Everything the analysis needs is allocated here, once
+    const double pi = std::acos(-1.0);
+    window.resize(FftSize);
+    for (int i = 0; i < FftSize; ++i) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * i / (FftSize - 1)));
+    }
+    samples.resize(FftSize);
+    real.resize(FftSize);
+    imag.resize(FftSize);
+    cosTable.resize(FftSize / 2);
+    sinTable.resize(FftSize / 2);
+    for (int k = 0; k < FftSize / 2; ++k) {
+        cosTable[k] = static_cast<float>(std::cos(2.0 * pi * k / FftSize));
+        sinTable[k] = static_cast<float>(std::sin(2.0 * pi * k / FftSize));
+    }
+    bitReversed.resize(FftSize);
+    int bits = 0;
+    while ((1 << bits) < FftSize) {
+        ++bits;
+    }
+    for (int i = 0; i < FftSize; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReversed[i] = reversed;
+    }
+
+    // Well below the audio threads; the timer lives on this thread
+    thread.setObjectName("SpectrumAnalyzer");
+    moveToThread(&thread);
+    thread.start(QThread::LowPriority);
+    QMetaObject::invokeMethod(this, &SpectrumAnalyzer::initialize, Qt::QueuedConnection);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+    QMetaObject::invokeMethod(this, &SpectrumAnalyzer::shutdown, Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+}
+
+template <typename SampleAt>
+void SpectrumAnalyzer::writeFrames(qint64 frames, int channels, SampleAt sampleAt) {
+    if (frames <= 0 || channels <= 0 || !active.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // Only one producer at a time; the other drops its block rather than wait
+    if (writing.test_and_set(std::memory_order_acquire)) {
+        return;
+    }
+
+    // Only the newest RingSize frames can ever be read
+    const qint64 first = std::max<qint64>(0, frames - RingSize);
+    const float scale = 1.0f / channels;
+    quint64 pos = writePos.load(std::memory_order_relaxed);
+    for (qint64 frame = first; frame < frames; ++frame) {
+        float sum = 0.0f;
+        for (int channel = 0; channel < channels; ++channel) {
+            sum += sampleAt(frame * channels + channel);
+        }
+        ring[pos & (RingSize - 1)].store(sum * scale, std::memory_order_relaxed);
+        ++pos;
+    }
+    writePos.store(pos, std::memory_order_release);
+    writing.clear(std::memory_order_release);
+}
+
+void SpectrumAnalyzer::write(const float* interleaved, qint64 frames, int channels) {
+    writeFrames(frames, channels, [interleaved](qint64 i) { return interleaved[i]; });
+}
+
+void SpectrumAnalyzer::write(const QAudioBuffer& buffer) {
+    const QAudioFormat format = buffer.format();
+    const int channels = format.channelCount();
+    const qint64 frames = buffer.frameCount();
+    setSampleRate(format.sampleRate());
+
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Float: {
+        const float* data = buffer.constData<float>();
+        writeFrames(frames, channels, [data](qint64 i) { return data[i]; });
+        break;
+    }
+    case QAudioFormat::Int16: {
+        const qint16* data = buffer.constData<qint16>();
+        writeFrames(frames, channels, [data](qint64 i) { return data[i] / 32768.0f; });
+        break;
+    }
+    case QAudioFormat::Int32: {
+        const qint32* data = buffer.constData<qint32>();
+        writeFrames(frames, channels, [data](qint64 i) { return data[i] / 2147483648.0f; });
+        break;
+    }
+    case QAudioFormat::UInt8: {
+        const quint8* data = buffer.constData<quint8>();
+        writeFrames(frames, channels, [data](qint64 i) { return (data[i] - 128) / 128.0f; });
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+bool SpectrumAnalyzer::latest(SpectrumSnapshot& snapshot) {
+    if (middle.load(std::memory_order_acquire) & Dirty) {
+        front = middle.exchange(front, std::memory_order_acq_rel) & ~Dirty;
+    }
+    const SpectrumSnapshot& newest = buffers[front];
+    if (newest.sequence == snapshot.sequence) {
+        return false;
+    }
+    snapshot = newest;
+    return true;
+}
+
+void SpectrumAnalyzer::initialize() {
+    timer = new QTimer(this);
+    timer->setTimerType(Qt::PreciseTimer);
+    timer->setInterval(1000 / FramesPerSecond);
+    connect(timer, &QTimer::timeout, this, &SpectrumAnalyzer::analyze);
+    timer->start();
+}
+
+void SpectrumAnalyzer::shutdown() {
+    delete timer;
+    timer = nullptr;
+}
+
+void SpectrumAnalyzer::analyze() {
+    // No new audio (paused, stopped): the last frame stays up
+    const quint64 end = writePos.load(std::memory_order_acquire);
+    if (end == analyzedPos) {
+        return;
+    }
+    analyzedPos = end;
+
+    for (int i = 0; i < FftSize; ++i) {
+        const quint64 pos = end - FftSize + static_cast<quint64>(i);
+        samples[i] = end >= static_cast<quint64>(FftSize - i)
+                     ? ring[pos & (RingSize - 1)].load(std::memory_order_relaxed) : 0.0f;
+    }
+    // A producer that lapped the ring while we copied leaves a torn frame
+    if (writePos.load(std::memory_order_acquire) - end > static_cast<quint64>(RingSize - FftSize)) {
+        return;
+    }
+
+    SpectrumSnapshot& out = buffers[back];
+
+    // Waveform: min/max of each group of samples
+    const int group = FftSize / SpectrumSnapshot::WavePoints;
+    for (int point = 0; point < SpectrumSnapshot::WavePoints; ++point) {
+        const auto range = std::minmax_element(samples.begin() + point * group, samples.begin() + (point + 1) * group);
+        out.waveMin[point] = *range.first;
+        out.waveMax[point] = *range.second;
+    }
+
+    DspKernels::multiply(real.data(), samples.data(), window.data(), FftSize);
+    std::fill(imag.begin(), imag.end(), 0.0f);
+    fft();
+
+    // Peak bin of each log-spaced band, in dB relative to a full-scale sine
+    // (the Hann window halves the amplitude)
+    const float rate = static_cast<float>(sampleRate.load(std::memory_order_relaxed));
+    const float binHz = rate / FftSize;
+    const float highest = std::min(HighestHz, rate / 2.0f);
+    const float normalize = 4.0f / FftSize;
+    for (int bar = 0; bar < SpectrumSnapshot::BarCount; ++bar) {
+        const float f0 = LowestHz * std::pow(highest / LowestHz, static_cast<float>(bar) / SpectrumSnapshot::BarCount);
+        const float f1 = LowestHz * std::pow(highest / LowestHz, static_cast<float>(bar + 1) / SpectrumSnapshot::BarCount);
+        const int bin0 = std::max(1, static_cast<int>(f0 / binHz));
+        const int bin1 = std::min(FftSize / 2, std::max(bin0 + 1, static_cast<int>(f1 / binHz)));
+        float peak = 0.0f;
+        for (int bin = bin0; bin < bin1; ++bin) {
+            peak = std::max(peak, real[bin] * real[bin] + imag[bin] * imag[bin]);
+        }
+        const float db = 20.0f * std::log10(std::max(std::sqrt(peak) * normalize, 1e-9f));
+        const float level = std::clamp((db - FloorDb) / -FloorDb, 0.0f, 1.0f);
+        levels[bar] = std::max(level, levels[bar] - DecayPerFrame);
+    }
+    out.bars = levels;
+    out.sequence = ++sequence;
+
+    // Publish; the reader picks it up on its next look
+    back = middle.exchange(back | Dirty, std::memory_order_acq_rel) & ~Dirty;
+}
+
+void SpectrumAnalyzer::fft() {
+    // Iterative radix-2 decimation in time, in place
+    for (int i = 0; i < FftSize; ++i) {
+        const int j = bitReversed[i];
+        if (i < j) {
+            std::swap(real[i], real[j]);
+            std::swap(imag[i], imag[j]);
+        }
+    }
+    for (int size = 2; size <= FftSize; size *= 2) {
+        const int half = size / 2;
+        const int step = FftSize / size;
+        for (int start = 0; start < FftSize; start += size) {
+            for (int k = 0; k < half; ++k) {
+                const float wr = cosTable[k * step];
+                const float wi = -sinTable[k * step];
+                const int a = start + k;
+                const int b = a + half;
+                const float tr = wr * real[b] - wi * imag[b];
+                const float ti = wr * imag[b] + wi * real[b];
+                real[b] = real[a] - tr;
+                imag[b] = imag[a] - ti;
+                real[a] += tr;
+                imag[a] += ti;
+            }
+        }
+    }
+}
+
+void AnalyzerTap::prepare(int sampleRate, int channelCount) {
+    channels = channelCount;
+    analyzer->setSampleRate(sampleRate);
+}
+
+void AnalyzerTap::process(float* samples, qint64 frames) {
+    analyzer->write(samples, frames, channels);
+}
@@ -0,0 +1,118 @@
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <QObject>
+#include <QThread>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "dspchain.h"
+
+QT_BEGIN_NAMESPACE
+class QAudioBuffer;
+class QTimer;
+QT_END_NAMESPACE
+
+// What the visualizer draws: one frame of band levels and the recent
+// waveform, all in 0..1 (waveform in -1..1)
+struct SpectrumSnapshot {
+    static constexpr int BarCount = 48;
+    static constexpr int WavePoints = 256;
+
+    std::array<float, BarCount> bars{};
+    std::array<float, WavePoints> waveMin{};
+    std::array<float, WavePoints> waveMax{};
+    quint64 sequence = 0;
+};
+
+// Spectrum and waveform analysis of the audio being played.
+//
+// Producers (the mixer's audio thread through AnalyzerTap, or the engine
+// thread with QMediaPlayer's decoded buffers) downmix to mono into a
+// preallocated ring of relaxed atomics, so they never lock or allocate; a
+// block arriving while another producer is mid-write is dropped. The
+// analysis runs on the analyzer's own low-priority thread at a capped rate:
+// Hann window (vectorized), radix-2 FFT with precomputed twiddles, then
+// log-spaced bars with peak decay. Results are published through a lock-free
+// triple buffer, so the widget always reads a whole frame without waiting.
+// Nothing is computed while no new audio arrives, and producers return at
+// once while the analyzer is inactive (no visible view).
+class SpectrumAnalyzer : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int FftSize = 2048;
+    static constexpr int RingSize = 4 * FftSize;
+    static constexpr int FramesPerSecond = 60;
+
+    // Starts the analysis thread
+    SpectrumAnalyzer();
+    virtual ~SpectrumAnalyzer();
+
+    // Producer side; any thread, never blocks
+    void write(const float* interleaved, qint64 frames, int channels);
+    void write(const QAudioBuffer& buffer);
+    void setSampleRate(int rate) { sampleRate.store(rate, std::memory_order_relaxed); }
+
+    // Off while nobody looks at the result
+    void setActive(bool on) { active.store(on, std::memory_order_relaxed); }
+
+    // Consumer side: copies the newest frame into snapshot; false if there
+    // is nothing newer than the sequence number it already holds
+    bool latest(SpectrumSnapshot& snapshot);
+
+private:
+    template <typename SampleAt>
+    void writeFrames(qint64 frames, int channels, SampleAt sampleAt);
+
+    void initialize();
+    void shutdown();
+    void analyze();
+    void fft();
+
+    QThread thread;
+    QTimer *timer;
+
+    // Mono ring; the write position only grows
+    std::array<std::atomic<float>, RingSize> ring;
+    std::atomic<quint64> writePos;
+    std::atomic_flag writing = ATOMIC_FLAG_INIT;
+    std::atomic<int> sampleRate;
+    std::atomic<bool> active;
+
+    // Analysis thread only, allocated once
+    quint64 analyzedPos;
+    quint64 sequence;
+    std::vector<float> window;
+    std::vector<float> samples;
+    std::vector<float> real;
+    std::vector<float> imag;
+    std::vector<float> cosTable;
+    std::vector<float> sinTable;
+    std::vector<int> bitReversed;
+    std::array<float, SpectrumSnapshot::BarCount> levels{};
+
+    // Triple buffer: the analysis thread fills back, swaps it with middle;
+    // the reader swaps front with middle when the dirty bit is set
+    static constexpr int Dirty = 4;
+    std::array<SpectrumSnapshot, 3> buffers;
+    std::atomic<int> middle;
+    int back;
+    int front;
+};
+
+// Last stage of the mixer's DSP chain: hands the processed output to the
+// analyzer without changing it
+class AnalyzerTap : public DspStage {
+public:
+    explicit AnalyzerTap(SpectrumAnalyzer* analyzer) : analyzer(analyzer), channels(2) {}
+
+    void prepare(int sampleRate, int channelCount) override;
+    void process(float* samples, qint64 frames) override;
+
+private:
+    SpectrumAnalyzer* analyzer;
+    int channels;
+};
+
+#endif // SPECTRUMANALYZER_H
@@ -0,0 +1,420 @@
+#include "tagreader.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QStringDecoder>
+#include <QStringList>
+#include <QtEndian>
+
+namespace {
+
+// Large enough for any sane tag block, small enough to never read audio data
+const qint64 MaxTagBytes = 16 * 1024 * 1024;
+
+quint32 syncSafe(const uchar* p) {
+    return (quint32(p[0] & 0x7f) << 21) | (quint32(p[1] & 0x7f) << 14)
+         | (quint32(p[2] & 0x7f) << 7) | quint32(p[3] & 0x7f);
+}
+
+// Decode an ID3v2 text frame body (one encoding byte followed by the text)
+// into its null-separated strings
+QStringList decodeId3Strings(const QByteArray& body) {
+    if (body.isEmpty()) {
+        return QStringList();
+    }
+    const QByteArray text = body.mid(1);
+    QString value;
+    switch (static_cast<uchar>(body[0])) {
+    case 0:
+        value = QString::fromLatin1(text);
+        break;
+    case 1: {
+        QStringDecoder decoder(QStringDecoder::Utf16, QStringDecoder::Flag::ConvertInitialBom);
+        value = decoder(text);
+        break;
+    }
+    case 2: {
+        QStringDecoder decoder(QStringDecoder::Utf16BE);
+        value = decoder(text);
+        break;
+    }
+    default:
+        value = QString::fromUtf8(text);
+        break;
+    }
+    QStringList parts = value.split(QChar(0), Qt::SkipEmptyParts);
+    for (QString& part : parts) {
+        // UTF-16 strings after the first may carry their own BOM
+        if (part.startsWith(QChar(0xfeff))) {
+            part.remove(0, 1);
+        }
+        part = part.trimmed();
+    }
+    return parts;
+}
+
+QString decodeId3Text(const QByteArray& body) {
+    const QStringList parts = decodeId3Strings(body);
+    return parts.isEmpty() ? QString() : parts.first();
+}
+
+// ReplayGain values are written as text such as "-6.48 dB" or "0.988"
+void applyReplayGain(TrackInfo& info, const QString& key, const QString& value) {
+    const QString name = key.toLower();
+    bool ok = false;
+    const float number = value.section(' ', 0, 0).toFloat(&ok);
+    if (!ok) {
+        return;
+    }
+    if (name == "replaygain_track_gain") {
+        info.replayGainDb = number;
+        info.hasReplayGain = true;
+    } else if (name == "replaygain_track_peak") {
+        info.replayGainPeak = number;
+    }
+}
+
+// Parse an ID3v2.3/2.4 tag at the start of the file; returns the tag size
+qint64 readId3v2(QFile& file, TrackInfo& info) {
+    file.seek(0);
+    const QByteArray header = file.read(10);
+    if (header.size() < 10 || !header.startsWith("ID3")) {
+        return 0;
+    }
+    const uchar* h = reinterpret_cast<const uchar*>(header.constData());
+    const int major = h[3];
+    const uchar flags = h[5];
+    const qint64 tagSize = syncSafe(h + 6) + 10 + ((flags & 0x10) ? 10 : 0);
+    if (major < 3 || major > 4 || tagSize > MaxTagBytes) {
+        return tagSize;
+    }
+
+    const QByteArray tag = file.read(tagSize - 10);
+    const uchar* data = reinterpret_cast<const uchar*>(tag.constData());
+    qint64 pos = 0;
+
+    // Skip the extended header
+    if ((flags & 0x40) && tag.size() >= 4) {
+        pos = (major == 4) ? syncSafe(data) : qFromBigEndian<quint32>(data) + 4;
+    }
+
+    while (pos + 10 <= tag.size()) {
+        const QByteArray id = tag.mid(pos, 4);
+        if (id[0] == '\0') {
+            break;  // Padding
+        }
+        const quint32 size = (major == 4) ? syncSafe(data + pos + 4)
+                                          : qFromBigEndian<quint32>(data + pos + 4);
+        pos += 10;
+        if (size == 0 || pos + size > tag.size()) {
+            break;
+        }
+
+        const QByteArray body = tag.mid(pos, size);
+        if (id == "TIT2") {
+            info.title = decodeId3Text(body);
+        } else if (id == "TPE1") {
+            info.artist = decodeId3Text(body);
+        } else if (id == "TALB") {
+            info.album = decodeId3Text(body);
+        } else if (id == "TLEN") {
+            info.durationMs = decodeId3Text(body).toLongLong();
+        } else if (id == "TXXX") {
+            // User text frame: description, then value
+            const QStringList parts = decodeId3Strings(body);
+            if (parts.size() >= 2) {
+                applyReplayGain(info, parts[0], parts[1]);
+            }
+        }
+        pos += size;
+    }
+    return tagSize;
+}
+
+// ID3v1 lives in the last 128 bytes; only used when there is no ID3v2 data
+void readId3v1(QFile& file, TrackInfo& info) {
+    if (file.size() < 128 || !file.seek(file.size() - 128)) {
+        return;
+    }
+    const QByteArray tag = file.read(128);
+    if (!tag.startsWith("TAG")) {
+        return;
+    }
+    auto field = [&](int offset) {
+        QByteArray raw = tag.mid(offset, 30);
+        int end = raw.indexOf('\0');
+        if (end >= 0) {
+            raw.truncate(end);
+        }
+        return QString::fromLatin1(raw).trimmed();
+    };
+    if (info.title.isEmpty()) {
+        info.title = field(3);
+    }
+    if (info.artist.isEmpty()) {
+        info.artist = field(33);
+    }
+    if (info.album.isEmpty()) {
+        info.album = field(63);
+    }
+}
+
+// Estimate the duration from the first MPEG audio frame after the tag,
+// using the Xing/Info frame count for VBR files and the bitrate otherwise
+qint64 readMpegDuration(QFile& file, qint64 audioStart) {
+    if (!file.seek(audioStart)) {
+        return 0;
+    }
+    const QByteArray head = file.read(64 * 1024);
+    const uchar* d = reinterpret_cast<const uchar*>(head.constData());
+
+    static const int bitratesV1[16] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0};
+    static const int bitratesV2[16] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
+    static const int sampleRates[3] = {44100, 48000, 32000};
+
+    for (qint64 i = 0; i + 4 <= head.size(); ++i) {
+        if (d[i] != 0xff || (d[i + 1] & 0xe0) != 0xe0) {
+            continue;
+        }
+        const int version = (d[i + 1] >> 3) & 0x03;    // 0: 2.5, 2: 2, 3: 1
+        const int layer = (d[i + 1] >> 1) & 0x03;      // 1: Layer III
+        const int bitrateIndex = d[i + 2] >> 4;
+        const int rateIndex = (d[i + 2] >> 2) & 0x03;
+        const int channelMode = d[i + 3] >> 6;
+        if (version == 1 || layer != 1 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) {
+            continue;
+        }
+
+        const bool mpeg1 = (version == 3);
+        const int sampleRate = sampleRates[rateIndex] >> (mpeg1 ? 0 : (version == 2 ? 1 : 2));
+        const int samplesPerFrame = mpeg1 ? 1152 : 576;
+        const int bitrate = (mpeg1 ? bitratesV1 : bitratesV2)[bitrateIndex] * 1000;
+
+        // Xing/Info header sits right after the side information
+        const int sideInfo = mpeg1 ? (channelMode == 3 ? 17 : 32) : (channelMode == 3 ? 9 : 17);
+        const qint64 xing = i + 4 + sideInfo;
+        if (xing + 12 <= head.size()
+            && (head.mid(xing, 4) == "Xing" || head.mid(xing, 4) == "Info")
+            && (qFromBigEndian<quint32>(d + xing + 4) & 0x1)) {
+            const quint32 frames = qFromBigEndian<quint32>(d + xing + 8);
+            return qint64(frames) * samplesPerFrame * 1000 / sampleRate;
+        }
+
+        const qint64 audioBytes = file.size() - audioStart - i;
+        return audioBytes * 8 * 1000 / bitrate;
+    }
+    return 0;
+}
+
+void readMp3(QFile& file, TrackInfo& info) {
+    const qint64 tagSize = readId3v2(file, info);
+    if (info.title.isEmpty() || info.artist.isEmpty() || info.album.isEmpty()) {
+        readId3v1(file, info);
+    }
+    if (info.durationMs <= 0) {
+        info.durationMs = readMpegDuration(file, tagSize);
+    }
+}
+
+// Walk MP4 boxes in [begin, end) of data and call visit(type, bodyStart, bodyEnd)
+template <typename Visitor>
+void forEachBox(const QByteArray& data, qint64 begin, qint64 end, Visitor visit) {
+    const uchar* d = reinterpret_cast<const uchar*>(data.constData());
+    qint64 pos = begin;
+    while (pos + 8 <= end) {
+        qint64 size = qFromBigEndian<quint32>(d + pos);
+        const QByteArray type = data.mid(pos + 4, 4);
+        qint64 header = 8;
+        if (size == 1 && pos + 16 <= end) {
+            size = qFromBigEndian<quint64>(d + pos + 8);
+            header = 16;
+        } else if (size == 0) {
+            size = end - pos;
+        }
+        // Compared as remaining bytes: pos + size can overflow on a crafted
+        // 64-bit size
+        if (size < header || size > end - pos) {
+            return;
+        }
+        visit(type, pos + header, pos + size);
+        pos += size;
+    }
+}
+
+void readMp4(QFile& file, TrackInfo& info) {
+    // Find moov among the top-level boxes without reading mdat
+    qint64 pos = 0;
+    QByteArray moov;
+    while (pos + 8 <= file.size() && file.seek(pos)) {
+        const QByteArray header = file.read(16);
+        if (header.size() < 8) {
+            return;
+        }
+        const uchar* h = reinterpret_cast<const uchar*>(header.constData());
+        qint64 size = qFromBigEndian<quint32>(h);
+        qint64 headerSize = 8;
+        if (size == 1 && header.size() >= 16) {
+            size = qFromBigEndian<quint64>(h + 8);
+            headerSize = 16;
+        } else if (size == 0) {
+            size = file.size() - pos;
+        }
+        if (size < headerSize || size > file.size() - pos) {
+            return;
+        }
+        if (header.mid(4, 4) == "moov") {
+            if (size > MaxTagBytes) {
+                return;
+            }
+            file.seek(pos + headerSize);
+            moov = file.read(size - headerSize);
+            break;
+        }
+        pos += size;
+    }
+    if (moov.isEmpty()) {
+        return;
+    }
+
+    const uchar* d = reinterpret_cast<const uchar*>(moov.constData());
+    forEachBox(moov, 0, moov.size(), [&](const QByteArray& type, qint64 begin, qint64 end) {
+        if (type == "mvhd" && end - begin >= 32) {
+            // Version 1 uses 64-bit times and duration
+            const bool v1 = d[begin] == 1;
+            const qint64 scalePos = begin + (v1 ? 20 : 12);
+            const quint32 timescale = qFromBigEndian<quint32>(d + scalePos);
+            const quint64 duration = v1 ? qFromBigEndian<quint64>(d + scalePos + 4)
+                                        : qFromBigEndian<quint32>(d + scalePos + 4);
+            if (timescale > 0) {
+                info.durationMs = static_cast<qint64>(duration * 1000 / timescale);
+            }
+        } else if (type == "udta") {
+            forEachBox(moov, begin, end, [&](const QByteArray& udtaType, qint64 udtaBegin, qint64 udtaEnd) {
+                if (udtaType != "meta") {
+                    return;
+                }
+                // meta is a full box: skip version and flags
+                forEachBox(moov, udtaBegin + 4, udtaEnd, [&](const QByteArray& metaType, qint64 ilstBegin, qint64 ilstEnd) {
+                    if (metaType != "ilst") {
+                        return;
+                    }
+                    forEachBox(moov, ilstBegin, ilstEnd, [&](const QByteArray& item, qint64 itemBegin, qint64 itemEnd) {
+                        if (item == "----") {
+                            // Freeform item: mean, name and data children; the
+                            // first two are full boxes with a 4-byte header
+                            QString name;
+                            QString value;
+                            forEachBox(moov, itemBegin, itemEnd, [&](const QByteArray& part, qint64 partBegin, qint64 partEnd) {
+                                if (part == "name" && partEnd - partBegin >= 4) {
+                                    name = QString::fromUtf8(moov.mid(partBegin + 4, partEnd - partBegin - 4));
+                                } else if (part == "data" && partEnd - partBegin >= 8) {
+                                    value = QString::fromUtf8(moov.mid(partBegin + 8, partEnd - partBegin - 8)).trimmed();
+                                }
+                            });
+                            applyReplayGain(info, name, value);
+                            return;
+                        }
+                        
+                        QString* target = nullptr;
+                        if (item == "\xa9nam") {
+                            target = &info.title;
+                        } else if (item == "\xa9" "ART") {
+                            target = &info.artist;
+                        } else if (item == "\xa9" "alb") {
+                            target = &info.album;
+                        }
+                        if (!target) {
+                            return;
+                        }
+                        // data box: type indicator and locale precede the UTF-8 value
+                        forEachBox(moov, itemBegin, itemEnd, [&](const QByteArray& dataType, qint64 valueBegin, qint64 valueEnd) {
+                            if (dataType == "data" && valueEnd - valueBegin >= 8) {
+                                *target = QString::fromUtf8(moov.mid(valueBegin + 8, valueEnd - valueBegin - 8)).trimmed();
+                            }
+                        });
+                    });
+                });
+            });
+        }
+    });
+}
+
+void readWav(QFile& file, TrackInfo& info) {
+    file.seek(0);
+    const QByteArray riff = file.read(12);
+    if (riff.size() < 12 || !riff.startsWith("RIFF") || riff.mid(8, 4) != "WAVE") {
+        return;
+    }
+
+    quint32 byteRate = 0;
+    qint64 dataSize = 0;
+    qint64 pos = 12;
+    while (pos + 8 <= file.size() && file.seek(pos)) {
+        const QByteArray header = file.read(8);
+        if (header.size() < 8) {
+            break;
+        }
+        const QByteArray id = header.left(4);
+        const qint64 size = qFromLittleEndian<quint32>(header.constData() + 4);
+
+        if (id == "fmt " && size >= 16) {
+            const QByteArray fmt = file.read(16);
+            if (fmt.size() < 16) {
+                break;
+            }
+            byteRate = qFromLittleEndian<quint32>(fmt.constData() + 8);
+        } else if (id == "data") {
+            dataSize = size;
+        } else if (id == "LIST" && size >= 4 && size <= MaxTagBytes) {
+            const QByteArray list = file.read(size);
+            if (list.startsWith("INFO")) {
+                qint64 sub = 4;
+                while (sub + 8 <= list.size()) {
+                    const QByteArray subId = list.mid(sub, 4);
+                    const qint64 subSize = qFromLittleEndian<quint32>(list.constData() + sub + 4);
+                    QByteArray value = list.mid(sub + 8, subSize);
+                    int end = value.indexOf('\0');
+                    if (end >= 0) {
+                        value.truncate(end);
+                    }
+                    if (subId == "INAM") {
+                        info.title = QString::fromUtf8(value).trimmed();
+                    } else if (subId == "IART") {
+                        info.artist = QString::fromUtf8(value).trimmed();
+                    } else if (subId == "IPRD") {
+                        info.album = QString::fromUtf8(value).trimmed();
+                    }
+                    sub += 8 + subSize + (subSize & 1);
+                }
+            }
+        }
+        // Chunks are padded to an even size
+        pos += 8 + size + (size & 1);
+    }
+
+    if (byteRate > 0) {
+        info.durationMs = dataSize * 1000 / byteRate;
+    }
+}
+
+} // namespace
+
+TrackInfo TagReader::read(const QString& path) {
+    QFileInfo fileInfo(path);
+    TrackInfo info(fileInfo.fileName());
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return info;
+    }
+
+    const QString suffix = fileInfo.suffix().toLower();
+    if (suffix == "mp3") {
+        readMp3(file, info);
+    } else if (suffix == "mp4" || suffix == "m4a") {
+        readMp4(file, info);
+    } else if (suffix == "wav") {
+        readWav(file, info);
+    }
+    return info;
+}
@@ -0,0 +1,21 @@
+#ifndef TAGREADER_H
+#define TAGREADER_H
+
+#include <QString>
+#include "trackinfo.h"
+
+// Lightweight tag parser for the formats the player accepts. Reads only the
+// header regions of the file: ID3v2/ID3v1 and the first MPEG frame for MP3,
+// the moov atom for MP4/M4A and the RIFF chunk list for WAV.
+// Safe to call from worker threads; never throws.
+class TagReader {
+public:
+    // Parse path; fields that cannot be read are left empty/zero and
+    // fileName is always set
+    static TrackInfo read(const QString& path);
+
+private:
+    TagReader() {}
+};
+
+#endif // TAGREADER_H
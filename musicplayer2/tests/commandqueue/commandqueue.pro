@@ -0,0 +1,15 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++17 testcase console
+CONFIG -= app_bundle
+
+TARGET = tst_commandqueue
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_commandqueue.cpp
+
+HEADERS += \
+    ../../commandqueue.h
@@ -0,0 +1,114 @@
+#include <QtTest>
+#include <string>
+#include <thread>
+#include <vector>
+#include "commandqueue.h"
+
+// The engine's command queue: order per producer, nothing lost or emptied
+// when producers retry against a full queue.
+class CommandQueueTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void fullQueueKeepsValue();
+    void fifoAfterWrapAround();
+    void producersRetryingOnFullQueue();
+};
+
+void CommandQueueTest::fullQueueKeepsValue() {
+    CommandQueue<std::string, 4> queue;
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY(queue.push(std::string("queued ") + char('0' + i)));
+    }
+
+    // A failed push must not consume the value the caller retries with
+    std::string value = "file:///next.mp3";
+    QVERIFY(!queue.push(std::move(value)));
+    QCOMPARE(value, std::string("file:///next.mp3"));
+
+    std::string out;
+    QVERIFY(queue.pop(out));
+    QCOMPARE(out, std::string("queued 0"));
+    QVERIFY(queue.push(std::move(value)));
+    for (int i = 1; i < 4; ++i) {
+        QVERIFY(queue.pop(out));
+    }
+    QVERIFY(queue.pop(out));
+    QCOMPARE(out, std::string("file:///next.mp3"));
+    QVERIFY(!queue.pop(out));
+}
+
+void CommandQueueTest::fifoAfterWrapAround() {
+    CommandQueue<int, 8> queue;
+    int next = 0;
+    int expected = 0;
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 5; ++i) {
+            int value = next++;
+            QVERIFY(queue.push(std::move(value)));
+        }
+        int out = -1;
+        for (int i = 0; i < 5; ++i) {
+            QVERIFY(queue.pop(out));
+            QCOMPARE(out, expected++);
+        }
+    }
+}
+
+void CommandQueueTest::producersRetryingOnFullQueue() {
+    // A small queue so producers keep finding it full, as PlayerEngine::post
+    // does when the engine thread stalls
+    constexpr int Producers = 4;
+    constexpr int PerProducer = 20000;
+    CommandQueue<std::string, 8> queue;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < Producers; ++p) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < PerProducer; ++i) {
+                std::string value = std::to_string(p) + ':' + std::to_string(i);
+                while (!queue.push(std::move(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> nextOf(Producers, 0);
+    int received = 0;
+    int emptied = 0;
+    int outOfOrder = 0;
+    std::string out;
+    while (received < Producers * PerProducer) {
+        if (!queue.pop(out)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ++received;
+        const std::size_t colon = out.find(':');
+        if (out.empty() || colon == std::string::npos) {
+            ++emptied;
+            continue;
+        }
+        const int p = std::stoi(out.substr(0, colon));
+        const int i = std::stoi(out.substr(colon + 1));
+        // Each producer's values arrive in the order it pushed them
+        if (i != nextOf[p]) {
+            ++outOfOrder;
+        }
+        nextOf[p] = i + 1;
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    QCOMPARE(emptied, 0);
+    QCOMPARE(outOfOrder, 0);
+    for (int p = 0; p < Producers; ++p) {
+        QCOMPARE(nextOf[p], PerProducer);
+    }
+    QVERIFY(!queue.pop(out));
+}
+
+QTEST_APPLESS_MAIN(CommandQueueTest)
+#include "tst_commandqueue.moc"
@@ -0,0 +1,21 @@
+QT       += core multimedia testlib
+QT       -= gui
+
+CONFIG += c++17 testcase console
+CONFIG -= app_bundle
+
+TARGET = tst_crossfademixer
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_crossfademixer.cpp \
+    ../../crossfademixer.cpp \
+    ../../dspchain.cpp \
+    ../../trace.cpp
+
+HEADERS += \
+    ../../crossfademixer.h \
+    ../../dspchain.h \
+    ../../dspkernels.h \
+    ../../trace.h
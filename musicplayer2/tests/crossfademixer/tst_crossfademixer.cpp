@@ -0,0 +1,144 @@
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtTest>
+#include <memory>
+#include <vector>
+#include "crossfademixer.h"
+
+namespace {
+
+// Constant levels that survive the 16-bit round trip exactly
+const qint16 LevelA = 8192;     // 0.25
+const qint16 LevelB = -8192;    // -0.25
+
+// Track lengths stay under the mixer's one-second decode watermark, so both
+// decode completely before mixing starts
+const int FramesA = 9000;
+const int FramesB = 7000;
+
+} // namespace
+
+// Gapless playback through the mixer: with no crossfade the next track's
+// first frame follows the current track's last frame directly.
+class CrossfadeMixerTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void gaplessCutHasNoGap();
+
+private:
+    QString writeWav(const QString& name, int frames, qint16 level, const QAudioFormat& format) const;
+
+    std::unique_ptr<QTemporaryDir> dir;
+};
+
+void CrossfadeMixerTest::init() {
+    dir = std::make_unique<QTemporaryDir>();
+    QVERIFY(dir->isValid());
+}
+
+QString CrossfadeMixerTest::writeWav(const QString& name, int frames, qint16 level,
+                                     const QAudioFormat& format) const {
+    // 16-bit PCM at the mixer's rate and channel count, so nothing resamples
+    const quint16 channels = static_cast<quint16>(format.channelCount());
+    const quint32 rate = static_cast<quint32>(format.sampleRate());
+    const quint32 dataSize = static_cast<quint32>(frames) * channels * 2;
+
+    QByteArray wav;
+    auto u32 = [&wav](quint32 value) {
+        char bytes[4];
+        qToLittleEndian(value, bytes);
+        wav.append(bytes, 4);
+    };
+    auto u16 = [&wav](quint16 value) {
+        char bytes[2];
+        qToLittleEndian(value, bytes);
+        wav.append(bytes, 2);
+    };
+    wav.append("RIFF");
+    u32(36 + dataSize);
+    wav.append("WAVEfmt ");
+    u32(16);
+    u16(1);
+    u16(channels);
+    u32(rate);
+    u32(rate * channels * 2);
+    u16(static_cast<quint16>(channels * 2));
+    u16(16);
+    wav.append("data");
+    u32(dataSize);
+    for (quint32 i = 0; i < static_cast<quint32>(frames) * channels; ++i) {
+        u16(static_cast<quint16>(level));
+    }
+
+    const QString path = dir->filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(wav) != wav.size()) {
+        return QString();
+    }
+    return path;
+}
+
+void CrossfadeMixerTest::gaplessCutHasNoGap() {
+    CrossfadeMixer mixer;
+    if (!mixer.isAvailable()) {
+        QSKIP("No audio output that takes float samples");
+    }
+    const QAudioFormat format = mixer.audioFormat();
+    const int channels = format.channelCount();
+    const QString a = writeWav("a.wav", FramesA, LevelA, format);
+    const QString b = writeWav("b.wav", FramesB, LevelB, format);
+    QVERIFY(!a.isEmpty() && !b.isEmpty());
+
+    QSignalSpy changed(&mixer, &CrossfadeMixer::trackChanged);
+    QSignalSpy finished(&mixer, &CrossfadeMixer::finished);
+    mixer.setCrossfadeDuration(0);
+    mixer.setSource(QUrl::fromLocalFile(a));
+    mixer.setNextSource(QUrl::fromLocalFile(b));
+    // Let both decoders run to the end; mix() is driven by hand below
+    QTest::qWait(1000);
+
+    // Render in sink-sized blocks, as the pull callback would
+    const qint64 blockFrames = 512;
+    std::vector<float> rendered;
+    std::vector<float> block(static_cast<size_t>(blockFrames * channels));
+    const qint64 totalFrames = FramesA + FramesB + 4 * blockFrames;
+    while (static_cast<qint64>(rendered.size()) < totalFrames * channels) {
+        mixer.mix(block.data(), blockFrames);
+        rendered.insert(rendered.end(), block.begin(), block.end());
+        QCoreApplication::processEvents();
+    }
+
+    // Classify every frame by its first channel
+    const float levelA = LevelA / 32768.0f;
+    const float levelB = LevelB / 32768.0f;
+    qint64 lastA = -1;
+    qint64 firstB = -1;
+    qint64 countA = 0;
+    qint64 countB = 0;
+    for (qint64 frame = 0; frame < totalFrames; ++frame) {
+        const float value = rendered[static_cast<size_t>(frame * channels)];
+        if (value == levelA) {
+            lastA = frame;
+            ++countA;
+        } else if (value == levelB) {
+            if (firstB < 0) {
+                firstB = frame;
+            }
+            ++countB;
+        }
+    }
+
+    QCOMPARE(countA, qint64(FramesA));
+    QCOMPARE(countB, qint64(FramesB));
+    // The gap between the tracks, in frames
+    QCOMPARE(firstB - lastA - 1, qint64(0));
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(finished.count(), 1);
+}
+
+QTEST_GUILESS_MAIN(CrossfadeMixerTest)
+#include "tst_crossfademixer.moc"
@@ -0,0 +1,18 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++17 testcase console
+CONFIG -= app_bundle
+
+TARGET = tst_librarystore
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_librarystore.cpp \
+    ../../librarystore.cpp \
+    ../../trackstorage.cpp
+
+HEADERS += \
+    ../../librarystore.h \
+    ../../trackstorage.h
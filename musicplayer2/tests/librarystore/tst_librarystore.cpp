@@ -0,0 +1,211 @@
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <memory>
+#include "librarystore.h"
+
+// Crash safety of the snapshot + journal format: whatever a crash or a bad
+// disk leaves behind, load() returns the last consistent playlist and keeps
+// journalling afterwards.
+class LibraryStoreTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void journalReplaysOverSnapshot();
+    void truncatedTailEntry();
+    void badChecksum();
+    void generationMismatch();
+    void corruptSnapshot_data();
+    void corruptSnapshot();
+    void secondStoreSavesNothing();
+
+private:
+    QString path(const QString& name) const { return dir->filePath(name); }
+    void add(MusicPlaylist& playlist, const QString& name) const;
+    QStringList load() const;
+    QStringList loadFrom(LibraryStore& store) const;
+    void corrupt(const QString& file, qint64 truncateBy, qint64 flipAt) const;
+
+    std::unique_ptr<QTemporaryDir> dir;
+};
+
+void LibraryStoreTest::init() {
+    dir = std::make_unique<QTemporaryDir>();
+    QVERIFY(dir->isValid());
+}
+
+void LibraryStoreTest::add(MusicPlaylist& playlist, const QString& name) const {
+    TrackInfo info;
+    info.fileName = name;
+    playlist.addItem(QUrl::fromLocalFile(path(name)), info);
+}
+
+QStringList LibraryStoreTest::loadFrom(LibraryStore& store) const {
+    QStringList names;
+    for (const ScannedTrack& track : store.load()) {
+        names.append(track.name);
+    }
+    return names;
+}
+
+QStringList LibraryStoreTest::load() const {
+    LibraryStore store(dir->path());
+    return loadFrom(store);
+}
+
+void LibraryStoreTest::corrupt(const QString& file, qint64 truncateBy, qint64 flipAt) const {
+    QFile f(path(file));
+    QVERIFY(f.open(QIODevice::ReadWrite));
+    if (truncateBy > 0) {
+        QVERIFY(f.resize(f.size() - truncateBy));
+    }
+    if (flipAt != 0) {
+        const qint64 at = flipAt < 0 ? f.size() + flipAt : flipAt;
+        f.seek(at);
+        char byte = 0;
+        f.getChar(&byte);
+        f.seek(at);
+        f.putChar(static_cast<char>(byte ^ 0x5a));
+    }
+}
+
+void LibraryStoreTest::journalReplaysOverSnapshot() {
+    MusicPlaylist playlist;
+    add(playlist, "a.mp3");
+    add(playlist, "b.mp3");
+    {
+        LibraryStore store(dir->path());
+        QVERIFY(loadFrom(store).isEmpty());
+        store.compact(playlist);
+        add(playlist, "c.mp3");
+        store.recordAdds(playlist, 2, 2);
+        store.recordRemoves(0, 1);
+    }
+    QCOMPARE(load(), QStringList({"b.mp3", "c.mp3"}));
+}
+
+void LibraryStoreTest::truncatedTailEntry() {
+    MusicPlaylist playlist;
+    add(playlist, "a.mp3");
+    add(playlist, "b.mp3");
+    {
+        LibraryStore store(dir->path());
+        loadFrom(store);
+        store.recordAdds(playlist, 0, 1);
+    }
+    // A crash in the middle of writing the last entry
+    corrupt("library.journal", 3, 0);
+    QCOMPARE(load(), QStringList({"a.mp3"}));
+
+    // New entries follow the last complete one, not the torn bytes
+    add(playlist, "c.mp3");
+    {
+        LibraryStore store(dir->path());
+        QCOMPARE(loadFrom(store), QStringList({"a.mp3"}));
+        store.recordAdds(playlist, 2, 2);
+    }
+    QCOMPARE(load(), QStringList({"a.mp3", "c.mp3"}));
+}
+
+void LibraryStoreTest::badChecksum() {
+    MusicPlaylist playlist;
+    add(playlist, "a.mp3");
+    add(playlist, "b.mp3");
+    {
+        LibraryStore store(dir->path());
+        loadFrom(store);
+        store.recordAdds(playlist, 0, 1);
+    }
+    corrupt("library.journal", 0, -1);
+    QCOMPARE(load(), QStringList({"a.mp3"}));
+}
+
+void LibraryStoreTest::generationMismatch() {
+    MusicPlaylist playlist;
+    add(playlist, "a.mp3");
+    QByteArray staleJournal;
+    {
+        LibraryStore store(dir->path());
+        loadFrom(store);
+        store.compact(playlist);
+        add(playlist, "b.mp3");
+        store.recordAdds(playlist, 1, 1);
+
+        QFile journal(path("library.journal"));
+        QVERIFY(journal.open(QIODevice::ReadOnly));
+        staleJournal = journal.readAll();
+        journal.close();
+
+        // The next compaction folds b into the snapshot...
+        store.compact(playlist);
+    }
+    // ...and a crash before the journal was reset leaves the old one behind
+    QFile journal(path("library.journal"));
+    QVERIFY(journal.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    journal.write(staleJournal);
+    journal.close();
+
+    QCOMPARE(load(), QStringList({"a.mp3", "b.mp3"}));
+}
+
+void LibraryStoreTest::corruptSnapshot_data() {
+    QTest::addColumn<qint64>("truncateBy");
+    QTest::addColumn<qint64>("flipAt");
+    QTest::newRow("truncated") << qint64(5) << qint64(0);
+    QTest::newRow("bad checksum") << qint64(0) << qint64(-1);
+    QTest::newRow("bad magic") << qint64(0) << qint64(1);
+}
+
+void LibraryStoreTest::corruptSnapshot() {
+    QFETCH(qint64, truncateBy);
+    QFETCH(qint64, flipAt);
+
+    MusicPlaylist playlist;
+    add(playlist, "a.mp3");
+    {
+        LibraryStore store(dir->path());
+        loadFrom(store);
+        store.compact(playlist);
+    }
+    corrupt("library.bin", truncateBy, flipAt);
+
+    // Reported, moved aside, and later changes are still saved
+    add(playlist, "b.mp3");
+    {
+        LibraryStore store(dir->path());
+        QVERIFY_THROWS_EXCEPTION(MusicPlayerException, store.load());
+        QVERIFY(QFile::exists(path("library.bin.corrupt")));
+        QVERIFY(!QFile::exists(path("library.bin")));
+        store.recordAdds(playlist, 1, 1);
+    }
+    QCOMPARE(load(), QStringList({"b.mp3"}));
+}
+
+void LibraryStoreTest::secondStoreSavesNothing() {
+    MusicPlaylist playlist;
+    add(playlist, "a.mp3");
+    {
+        LibraryStore owner(dir->path());
+        loadFrom(owner);
+        owner.compact(playlist);
+
+        // Another player on the same library is refused and writes nothing
+        MusicPlaylist other;
+        add(other, "x.mp3");
+        {
+            LibraryStore second(dir->path());
+            QVERIFY_THROWS_EXCEPTION(MusicPlayerException, second.load());
+            second.recordAdds(other, 0, 0);
+            second.compact(other);
+        }
+
+        add(playlist, "b.mp3");
+        owner.recordAdds(playlist, 1, 1);
+    }
+    QCOMPARE(load(), QStringList({"a.mp3", "b.mp3"}));
+}
+
+QTEST_APPLESS_MAIN(LibraryStoreTest)
+
+#include "tst_librarystore.moc"
@@ -0,0 +1,15 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++17 testcase console
+CONFIG -= app_bundle
+
+TARGET = tst_playlistmanager
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_playlistmanager.cpp
+
+HEADERS += \
+    ../../playlistmanager.h
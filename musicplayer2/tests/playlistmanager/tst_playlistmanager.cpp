@@ -0,0 +1,298 @@
+#include <QtTest>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+#include "playlistmanager.h"
+
+namespace {
+
+// Heap allocations made while an AllocationCounter is alive; the global
+// operator new below is replaced for this test binary only
+bool countingAllocations = false;
+int allocations = 0;
+
+class AllocationCounter {
+public:
+    AllocationCounter() {
+        allocations = 0;
+        countingAllocations = true;
+    }
+    ~AllocationCounter() {
+        countingAllocations = false;
+    }
+    int count() const {
+        return allocations;
+    }
+};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (countingAllocations) {
+        ++allocations;
+    }
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+// Value type that counts how often it is copied, moved and built from
+// arguments; Tag keeps item and display counts apart
+template <int Tag>
+struct Counted {
+    inline static int copies = 0;
+    inline static int moves = 0;
+    inline static int built = 0;
+
+    std::string value;
+
+    Counted() = default;
+    explicit Counted(std::string value) : value(std::move(value)) {
+        ++built;
+    }
+    Counted(const Counted& other) : value(other.value) {
+        ++copies;
+    }
+    Counted(Counted&& other) noexcept : value(std::move(other.value)) {
+        ++moves;
+    }
+    Counted& operator=(const Counted& other) {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+    Counted& operator=(Counted&& other) noexcept {
+        value = std::move(other.value);
+        ++moves;
+        return *this;
+    }
+    bool operator==(const Counted& other) const {
+        return value == other.value;
+    }
+
+    static void resetCounts() {
+        copies = 0;
+        moves = 0;
+        built = 0;
+    }
+};
+
+using Item = Counted<0>;
+using Display = Counted<1>;
+
+struct ItemHasher {
+    size_t operator()(const Item& item) const noexcept {
+        return std::hash<std::string>()(item.value);
+    }
+};
+
+using Playlist = PlaylistManager<Item, Display, ItemHasher>;
+using Entries = std::vector<std::pair<Item, Display>>;
+
+} // namespace
+
+// The move-aware adds and the display view: rvalues are moved into the
+// playlist and never copied, rejected duplicates leave their source alone,
+// a range is added with one growth of each container, and reading the
+// playlist neither copies nor allocates.
+class PlaylistManagerTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void emplaceItemMovesWithoutCopies();
+    void emplaceDuplicateBuildsNothing();
+    void addItemsFromMoveIterators();
+    void addItemsFromLvaluesCopies();
+    void displayViewDoesNotCopy();
+    void addItemsReservesOnce_data();
+    void addItemsReservesOnce();
+    void readingDoesNotAllocate();
+
+private:
+    static Entries entries(std::initializer_list<const char*> names);
+    static Entries numbered(int count);
+    static QStringList displays(const Playlist& playlist);
+};
+
+void PlaylistManagerTest::init() {
+    Item::resetCounts();
+    Display::resetCounts();
+}
+
+Entries PlaylistManagerTest::entries(std::initializer_list<const char*> names) {
+    Entries result;
+    result.reserve(names.size());
+    for (const char* name : names) {
+        result.emplace_back(Item(name), Display(std::string(name) + ".title"));
+    }
+    Item::resetCounts();
+    Display::resetCounts();
+    return result;
+}
+
+Entries PlaylistManagerTest::numbered(int count) {
+    // Short enough for the small-string buffer, so moving them allocates nothing
+    Entries result;
+    result.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        result.emplace_back(Item("t" + std::to_string(i)), Display("d" + std::to_string(i)));
+    }
+    return result;
+}
+
+QStringList PlaylistManagerTest::displays(const Playlist& playlist) {
+    QStringList result;
+    for (const Display& display : playlist.displayItems()) {
+        result.append(QString::fromStdString(display.value));
+    }
+    return result;
+}
+
+void PlaylistManagerTest::emplaceItemMovesWithoutCopies() {
+    Playlist playlist;
+    Item item("a");
+    QVERIFY(playlist.emplaceItem(std::move(item), "A"));
+    QCOMPARE(Item::copies, 0);
+    QCOMPARE(Display::copies, 0);
+    QCOMPARE(Display::built, 1);
+    QCOMPARE(playlist.getItem(0).value, std::string("a"));
+    QCOMPARE(playlist.getDisplayInfo(0).value, std::string("A"));
+
+    // The moved-from item can be given a new value and added again
+    item = Item("b");
+    QVERIFY(playlist.emplaceItem(std::move(item), "B"));
+    QCOMPARE(Item::copies, 0);
+    QCOMPARE(Display::copies, 0);
+    QCOMPARE(playlist.size(), size_t(2));
+    QCOMPARE(playlist.getItem(1).value, std::string("b"));
+}
+
+void PlaylistManagerTest::emplaceDuplicateBuildsNothing() {
+    Playlist playlist;
+    QVERIFY(playlist.emplaceItem(Item("a"), "A"));
+    Display::resetCounts();
+
+    QVERIFY(!playlist.emplaceItem(Item("a"), "other"));
+    QCOMPARE(Display::built, 0);
+    QCOMPARE(playlist.size(), size_t(1));
+    QCOMPARE(playlist.getDisplayInfo(0).value, std::string("A"));
+}
+
+void PlaylistManagerTest::addItemsFromMoveIterators() {
+    Entries sources = entries({"a", "b", "a"});
+    Playlist playlist;
+    const size_t added = playlist.addItems(std::make_move_iterator(sources.begin()),
+                                           std::make_move_iterator(sources.end()));
+    QCOMPARE(added, size_t(2));
+    QCOMPARE(Item::copies, 0);
+    QCOMPARE(Display::copies, 0);
+    QCOMPARE(displays(playlist), QStringList({"a.title", "b.title"}));
+
+    // The duplicate was rejected before anything was moved out of it
+    QCOMPARE(sources[2].first.value, std::string("a"));
+    QCOMPARE(sources[2].second.value, std::string("a.title"));
+
+    // Moved-from sources are still usable
+    sources[0].first = Item("c");
+    sources[0].second = Display("c.title");
+    QCOMPARE(playlist.addItems(sources.begin(), sources.begin() + 1), size_t(1));
+    QCOMPARE(displays(playlist), QStringList({"a.title", "b.title", "c.title"}));
+    QCOMPARE(sources[0].first.value, std::string("c"));
+}
+
+void PlaylistManagerTest::addItemsFromLvaluesCopies() {
+    const Entries sources = entries({"a", "b"});
+    Playlist playlist;
+    QCOMPARE(playlist.addItems(sources.begin(), sources.end()), size_t(2));
+    QCOMPARE(Item::copies, 2);
+    QCOMPARE(Display::copies, 2);
+    QCOMPARE(sources[0].first.value, std::string("a"));
+    QCOMPARE(sources[1].second.value, std::string("b.title"));
+}
+
+void PlaylistManagerTest::displayViewDoesNotCopy() {
+    Entries sources = entries({"a", "b", "c"});
+    Playlist playlist;
+    playlist.addItems(std::make_move_iterator(sources.begin()), std::make_move_iterator(sources.end()));
+    Display::resetCounts();
+
+    static_assert(std::is_same<Playlist::DisplayRef, const Display&>::value,
+                  "VectorStorage hands out references");
+    const Playlist::DisplayView view = playlist.displayItems();
+    QCOMPARE(view.size(), size_t(3));
+    QCOMPARE(displays(playlist), QStringList({"a.title", "b.title", "c.title"}));
+    QCOMPARE(&*view.begin(), &playlist.getDisplayInfo(0));
+    QCOMPARE(Display::copies, 0);
+    QCOMPARE(Display::moves, 0);
+}
+
+void PlaylistManagerTest::addItemsReservesOnce_data() {
+    QTest::addColumn<int>("count");
+    QTest::newRow("100") << 100;
+    QTest::newRow("10000") << 10000;
+}
+
+void PlaylistManagerTest::addItemsReservesOnce() {
+    QFETCH(int, count);
+
+    // What one up-front reserve costs, plus the free-slot list the first
+    // insert creates
+    int reserveAllocations;
+    {
+        Playlist playlist;
+        AllocationCounter counter;
+        playlist.reserve(static_cast<size_t>(count));
+        reserveAllocations = counter.count();
+    }
+    QVERIFY(reserveAllocations > 0);
+
+    Entries sources = numbered(count);
+    Playlist playlist;
+    int addAllocations;
+    {
+        AllocationCounter counter;
+        QCOMPARE(playlist.addItems(std::make_move_iterator(sources.begin()),
+                                   std::make_move_iterator(sources.end())),
+                 size_t(count));
+        addAllocations = counter.count();
+    }
+    // Growing per item would take about log2(count) allocations per container
+    QCOMPARE(addAllocations, reserveAllocations + 1);
+    QCOMPARE(playlist.size(), size_t(count));
+}
+
+void PlaylistManagerTest::readingDoesNotAllocate() {
+    Entries sources = numbered(1000);
+    Playlist playlist;
+    playlist.addItems(std::make_move_iterator(sources.begin()), std::make_move_iterator(sources.end()));
+
+    AllocationCounter counter;
+    size_t length = 0;
+    for (const Display& display : playlist.displayItems()) {
+        length += display.value.size();
+    }
+    for (size_t row = 0; row < playlist.size(); ++row) {
+        length += playlist.getItem(row).value.size();
+    }
+    const int reads = counter.count();
+    QVERIFY(length > 0);
+    QCOMPARE(reads, 0);
+}
+
+QTEST_APPLESS_MAIN(PlaylistManagerTest)
+#include "tst_playlistmanager.moc"
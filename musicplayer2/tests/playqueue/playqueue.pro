@@ -0,0 +1,19 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++17 testcase console
+CONFIG -= app_bundle
+
+TARGET = tst_playqueue
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_playqueue.cpp \
+    ../../playqueue.cpp \
+    ../../trackstorage.cpp
+
+HEADERS += \
+    ../../playlistmanager.h \
+    ../../playqueue.h \
+    ../../trackstorage.h
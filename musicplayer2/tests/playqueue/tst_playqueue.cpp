@@ -0,0 +1,200 @@
+#include <QtTest>
+#include <set>
+#include <vector>
+#include "playqueue.h"
+
+namespace {
+
+using EntryId = MusicPlaylist::EntryId;
+
+// Adds the track numbered n and tells the queue, as the players do
+EntryId add(MusicPlaylist& playlist, PlayQueue& queue, int n) {
+    const QString name = QString("%1.flac").arg(n);
+    playlist.addItem(QUrl::fromLocalFile("/music/" + name), TrackInfo(name));
+    const EntryId id = playlist.idAt(playlist.size() - 1);
+    queue.added(id);
+    return id;
+}
+
+std::set<EntryId> liveIds(const MusicPlaylist& playlist) {
+    return std::set<EntryId>(playlist.ids().begin(), playlist.ids().end());
+}
+
+} // namespace
+
+// Playback order: every live entry once per shuffled round, peekNext always
+// naming what advance then returns, and playlist order carrying on past a
+// removed current entry.
+class PlayQueueTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void linearOrder();
+    void shuffleRoundPlaysEachEntryOnce_data();
+    void shuffleRoundPlaysEachEntryOnce();
+    void peekNextMatchesAdvance_data();
+    void peekNextMatchesAdvance();
+    void removedCurrentContinuesWithFollowingRow();
+    void removedCurrentAtEnd();
+};
+
+void PlayQueueTest::linearOrder() {
+    MusicPlaylist playlist;
+    PlayQueue queue(playlist);
+    for (int i = 0; i < 5; ++i) {
+        add(playlist, queue, i);
+    }
+
+    for (size_t row = 0; row < playlist.size(); ++row) {
+        QCOMPARE(queue.advance(false), playlist.idAt(row));
+    }
+    QCOMPARE(queue.advance(false), MusicPlaylist::InvalidId);
+    queue.setRepeat(PlayQueue::Repeat::All);
+    QCOMPARE(queue.advance(false), playlist.idAt(0));
+    QCOMPARE(queue.previous(), playlist.idAt(4));
+}
+
+void PlayQueueTest::shuffleRoundPlaysEachEntryOnce_data() {
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("churn");
+
+    QTest::newRow("1") << 1 << false;
+    QTest::newRow("2") << 2 << false;
+    QTest::newRow("100") << 100 << false;
+    QTest::newRow("1000") << 1000 << false;
+    QTest::newRow("100, edited mid-round") << 100 << true;
+    QTest::newRow("1000, edited mid-round") << 1000 << true;
+}
+
+void PlayQueueTest::shuffleRoundPlaysEachEntryOnce() {
+    QFETCH(int, count);
+    QFETCH(bool, churn);
+
+    MusicPlaylist playlist;
+    PlayQueue queue(playlist);
+    int next = 0;
+    for (; next < count; ++next) {
+        add(playlist, queue, next);
+    }
+    queue.setRepeat(PlayQueue::Repeat::All);
+    queue.setShuffle(true);
+
+    for (int round = 0; round < 4; ++round) {
+        // Whatever is in the playlist when the round ends has to be played
+        // exactly once in it
+        std::set<EntryId> due = liveIds(playlist);
+        std::set<EntryId> played;
+        bool edited = !churn;
+        while (played.size() < due.size()) {
+            const EntryId id = queue.advance(false);
+            QVERIFY(playlist.isValid(id));
+            QVERIFY(due.count(id) == 1);
+            QVERIFY(played.insert(id).second);
+
+            if (!edited && played.size() == due.size() / 2) {
+                // Drop every fifth row, played or not, and add a tenth more
+                std::vector<size_t> rows;
+                for (size_t row = 0; row < playlist.size(); row += 5) {
+                    rows.push_back(row);
+                }
+                playlist.removeRows(rows);
+                for (int i = 0; i < count / 10; ++i) {
+                    add(playlist, queue, next++);
+                }
+                due = liveIds(playlist);
+                std::set<EntryId> stillLive;
+                for (EntryId done : played) {
+                    if (due.count(done) == 1) {
+                        stillLive.insert(done);
+                    }
+                }
+                played.swap(stillLive);
+                edited = true;
+            }
+        }
+    }
+}
+
+void PlayQueueTest::peekNextMatchesAdvance_data() {
+    QTest::addColumn<bool>("shuffle");
+    QTest::addColumn<int>("repeat");
+
+    QTest::newRow("in order") << false << static_cast<int>(PlayQueue::Repeat::Off);
+    QTest::newRow("in order, repeat all") << false << static_cast<int>(PlayQueue::Repeat::All);
+    QTest::newRow("in order, repeat one") << false << static_cast<int>(PlayQueue::Repeat::One);
+    QTest::newRow("shuffled") << true << static_cast<int>(PlayQueue::Repeat::Off);
+    QTest::newRow("shuffled, repeat all") << true << static_cast<int>(PlayQueue::Repeat::All);
+    QTest::newRow("shuffled, repeat one") << true << static_cast<int>(PlayQueue::Repeat::One);
+}
+
+void PlayQueueTest::peekNextMatchesAdvance() {
+    QFETCH(bool, shuffle);
+    QFETCH(int, repeat);
+
+    MusicPlaylist playlist;
+    PlayQueue queue(playlist);
+    int next = 0;
+    for (; next < 50; ++next) {
+        add(playlist, queue, next);
+    }
+    queue.setShuffle(shuffle);
+    queue.setRepeat(static_cast<PlayQueue::Repeat>(repeat));
+
+    for (int step = 0; step < 500; ++step) {
+        if (step % 7 == 3) {
+            // Includes the current entry now and then
+            playlist.removeAt(static_cast<size_t>(step * 13) % playlist.size());
+            add(playlist, queue, next++);
+        }
+        const EntryId promised = queue.peekNext();
+        QCOMPARE(queue.advance(false), promised);
+        if (promised == MusicPlaylist::InvalidId) {
+            QCOMPARE(static_cast<PlayQueue::Repeat>(repeat), PlayQueue::Repeat::Off);
+            return;
+        }
+    }
+}
+
+void PlayQueueTest::removedCurrentContinuesWithFollowingRow() {
+    MusicPlaylist playlist;
+    PlayQueue queue(playlist);
+    for (int i = 0; i < 10; ++i) {
+        add(playlist, queue, i);
+    }
+
+    queue.setCurrent(playlist.idAt(4));
+    const EntryId following = playlist.idAt(5);
+    playlist.removeAt(4);
+    QCOMPARE(queue.peekNext(), following);
+    QCOMPARE(queue.advance(false), following);
+
+    // A deleted range that holds the current entry
+    queue.setCurrent(playlist.idAt(2));
+    const EntryId afterRange = playlist.idAt(5);
+    playlist.removeRows({2, 3, 4});
+    QCOMPARE(queue.advance(true), afterRange);
+
+    // Going back lands on the row before the removed one
+    queue.setCurrent(playlist.idAt(3));
+    const EntryId before = playlist.idAt(2);
+    playlist.removeAt(3);
+    QCOMPARE(queue.previous(), before);
+}
+
+void PlayQueueTest::removedCurrentAtEnd() {
+    MusicPlaylist playlist;
+    PlayQueue queue(playlist);
+    for (int i = 0; i < 3; ++i) {
+        add(playlist, queue, i);
+    }
+
+    queue.setCurrent(playlist.idAt(2));
+    playlist.removeAt(2);
+    QCOMPARE(queue.peekNext(), MusicPlaylist::InvalidId);
+    queue.setRepeat(PlayQueue::Repeat::All);
+    QCOMPARE(queue.advance(false), playlist.idAt(0));
+}
+
+QTEST_APPLESS_MAIN(PlayQueueTest)
+
+#include "tst_playqueue.moc"
@@ -0,0 +1,10 @@
+# Unit tests: qmake tests/tests.pro && make && make check
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    commandqueue \
+    crossfademixer \
+    librarystore \
+    playlistmanager \
+    playqueue \
+    trace
@@ -0,0 +1,16 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++17 testcase console
+CONFIG -= app_bundle
+
+TARGET = tst_trace
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_trace.cpp \
+    ../../trace.cpp
+
+HEADERS += \
+    ../../trace.h
@@ -0,0 +1,173 @@
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtTest>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "trace.h"
+
+namespace {
+
+quint64 currentThread() {
+    return reinterpret_cast<quintptr>(QThread::currentThreadId());
+}
+
+// Events must be named by string literals
+const char* const WorkerNames[] = {"worker 0", "worker 1", "worker 2", "worker 3",
+                                   "worker 4", "worker 5", "worker 6", "worker 7"};
+
+} // namespace
+
+// Per-thread trace rings: concurrent recording, rings handed on when their
+// thread exits, and the exported Chrome trace only ever attributing a ring's
+// events to the thread that wrote them.
+class TraceTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void concurrentRecord();
+    void reusedRingDropsPreviousOwner();
+
+private:
+    QJsonArray exportEvents() const;
+    static QList<QJsonObject> named(const QJsonArray& events, const char* name);
+
+    std::unique_ptr<QTemporaryDir> dir;
+};
+
+void TraceTest::init() {
+    dir = std::make_unique<QTemporaryDir>();
+    QVERIFY(dir->isValid());
+}
+
+// The exported traceEvents; empty if the file is missing or not JSON
+QJsonArray TraceTest::exportEvents() const {
+    const QString path = dir->filePath("trace.json");
+    Trace::exportChromeTrace(path);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QJsonArray();
+    }
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        return QJsonArray();
+    }
+    return document.object().value("traceEvents").toArray();
+}
+
+QList<QJsonObject> TraceTest::named(const QJsonArray& events, const char* name) {
+    QList<QJsonObject> matching;
+    for (const QJsonValue& value : events) {
+        const QJsonObject event = value.toObject();
+        if (event.value("name").toString() == QLatin1String(name)) {
+            matching.append(event);
+        }
+    }
+    return matching;
+}
+
+void TraceTest::concurrentRecord() {
+    // Worker 0 laps its ring; the others fit
+    constexpr int Workers = 8;
+    const int counts[Workers] = {Trace::RingSize + 100, 3000, 3000, 3000, 3000, 3000, 3000, 3000};
+    std::atomic<int> done{0};
+    std::atomic<bool> exported{false};
+    std::vector<quint64> threadIds(Workers, 0);
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < Workers; ++w) {
+        workers.emplace_back([&, w]() {
+            threadIds[w] = currentThread();
+            for (int i = 0; i < counts[w]; ++i) {
+                // Start in whole microseconds so ts reads back exactly
+                Trace::record(WorkerNames[w], static_cast<qint64>(i) * 1000, w);
+            }
+            // Stay alive until the export, so no ring changes hands
+            ++done;
+            while (!exported.load()) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    while (done.load() < Workers) {
+        std::this_thread::yield();
+    }
+    const QJsonArray events = exportEvents();
+    exported = true;
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    QVERIFY(!events.isEmpty());
+
+    for (int w = 0; w < Workers; ++w) {
+        const QList<QJsonObject> mine = named(events, WorkerNames[w]);
+        // A lapped ring loses one more slot: the one a write in progress
+        // could be overwriting
+        const int kept = counts[w] < Trace::RingSize ? counts[w] : Trace::RingSize - 1;
+        QCOMPARE(mine.size(), kept);
+        // The newest events, in order, all on the writing thread
+        const int first = counts[w] - kept;
+        for (int i = 0; i < mine.size(); ++i) {
+            const QJsonObject& event = mine[i];
+            QCOMPARE(event.value("ph").toString(), QString("X"));
+            QCOMPARE(static_cast<quint64>(event.value("tid").toInteger()), threadIds[w]);
+            QCOMPARE(event.value("ts").toDouble(), static_cast<double>(first + i));
+            QCOMPARE(event.value("dur").toDouble(), w / 1000.0);
+        }
+    }
+}
+
+void TraceTest::reusedRingDropsPreviousOwner() {
+    // The old owner laps its ring, so its slots sit both before and after
+    // the index the next owner starts at
+    const int oldCount = Trace::RingSize + 5;
+    std::thread oldOwner([oldCount]() {
+        for (int i = 0; i < oldCount; ++i) {
+            Trace::record("old owner", i * 1000, 1);
+        }
+    });
+    oldOwner.join();
+
+    // A dead thread's events still export until its ring is reused
+    QCOMPARE(named(exportEvents(), "old owner").size(), Trace::RingSize - 1);
+
+    // The next new thread takes over the ring the old owner returned
+    std::atomic<bool> recorded{false};
+    std::atomic<bool> exported{false};
+    quint64 newThread = 0;
+    std::thread newOwner([&]() {
+        newThread = currentThread();
+        for (int i = 0; i < 3; ++i) {
+            Trace::record("new owner", i * 1000, 2);
+        }
+        recorded = true;
+        while (!exported.load()) {
+            std::this_thread::yield();
+        }
+    });
+    while (!recorded.load()) {
+        std::this_thread::yield();
+    }
+    const QJsonArray events = exportEvents();
+    exported = true;
+    newOwner.join();
+    QVERIFY(!events.isEmpty());
+
+    QCOMPARE(named(events, "old owner").size(), 0);
+    const QList<QJsonObject> fresh = named(events, "new owner");
+    QCOMPARE(fresh.size(), 3);
+    for (const QJsonObject& event : fresh) {
+        QCOMPARE(static_cast<quint64>(event.value("tid").toInteger()), newThread);
+    }
+}
+
+QTEST_APPLESS_MAIN(TraceTest)
+
+#include "tst_trace.moc"
@@ -0,0 +1,163 @@
+#include "trace.h"
+#include "playlistmanager.h"
+
+#ifndef MUSICPLAYER_NO_TRACE
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThread>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace Trace {
+
+std::atomic<qint64> counters[static_cast<int>(Counter::Count)] = {};
+
+namespace {
+
+// One thread's events. Only that thread writes; the exporter reads fields
+// as relaxed atomics and discards slots the writer may have lapped meanwhile.
+struct Ring {
+    struct Slot {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<qint64> start{0};
+        std::atomic<qint64> duration{0};
+    };
+
+    // Owner and the first index it wrote; registry mutex
+    quint64 threadId = 0;
+    quint64 firstIndex = 0;
+    std::atomic<quint64> head{0};
+    std::array<Slot, RingSize> events;
+};
+
+// Every ring ever made. A thread's ring goes back to the free list when the
+// thread exits and is reused by the next new thread, so pool threads that
+// expire and get recreated don't grow the set: it stays as large as the
+// most threads ever tracing at once. Until reuse, a dead thread's events
+// still export.
+QMutex registryMutex;
+std::vector<std::unique_ptr<Ring>> registry;
+std::vector<Ring*> freeRings;
+
+struct RingHolder {
+    Ring* ring = nullptr;
+
+    ~RingHolder() {
+        if (ring) {
+            QMutexLocker locker(&registryMutex);
+            freeRings.push_back(ring);
+        }
+    }
+};
+
+Ring& threadRing() {
+    thread_local RingHolder holder;
+    if (!holder.ring) {
+        QMutexLocker locker(&registryMutex);
+        if (freeRings.empty()) {
+            registry.push_back(std::make_unique<Ring>());
+            holder.ring = registry.back().get();
+        } else {
+            holder.ring = freeRings.back();
+            freeRings.pop_back();
+        }
+        holder.ring->threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+        holder.ring->firstIndex = holder.ring->head.load(std::memory_order_relaxed);
+    }
+    return *holder.ring;
+}
+
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+} // namespace
+
+qint64 now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void record(const char* name, qint64 startNs, qint64 durationNs) {
+    Ring& ring = threadRing();
+    const quint64 index = ring.head.load(std::memory_order_relaxed);
+    Ring::Slot& slot = ring.events[index % RingSize];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(startNs, std::memory_order_relaxed);
+    slot.duration.store(durationNs, std::memory_order_relaxed);
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+void exportChromeTrace(const QString& path) {
+    struct Copied {
+        const char* name;
+        qint64 start;
+        qint64 duration;
+        quint64 threadId;
+    };
+    std::vector<Copied> events;
+    {
+        // Copied under the lock so no ring changes owner meanwhile
+        QMutexLocker locker(&registryMutex);
+        events.reserve(registry.size() * RingSize);
+        for (const std::unique_ptr<Ring>& ring : registry) {
+            const quint64 end = ring->head.load(std::memory_order_acquire);
+            const quint64 begin = end > static_cast<quint64>(RingSize) ? end - RingSize : 0;
+            const size_t copied = events.size();
+            for (quint64 i = begin; i < end; ++i) {
+                const Ring::Slot& slot = ring->events[i % RingSize];
+                events.push_back({slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                                  slot.duration.load(std::memory_order_relaxed), ring->threadId});
+            }
+            // Slots the thread wrote over (or was writing) while we copied may
+            // be torn; a slot is three independent fields, so at worst one
+            // event would show another's timing, never a bad name pointer
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const quint64 after = ring->head.load(std::memory_order_relaxed);
+            const quint64 firstValid = after >= static_cast<quint64>(RingSize) ? after - RingSize + 1 : 0;
+            const quint64 keepFrom = qMax(qMax(begin, firstValid), ring->firstIndex);
+            if (keepFrom > begin) {
+                events.erase(events.begin() + copied,
+                             events.begin() + copied + static_cast<size_t>(qMin(keepFrom, end) - begin));
+            }
+        }
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        throw MusicPlayerException("Cannot write trace: " + file.errorString().toStdString());
+    }
+    QTextStream out(&file);
+    const qint64 pid = QCoreApplication::applicationPid();
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const Copied& event : events) {
+        if (!event.name) {
+            continue;
+        }
+        // Timestamps in microseconds, as the format expects
+        out << (first ? "" : ",") << "\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":" << pid
+            << ",\"tid\":" << event.threadId << ",\"ts\":" << QString::number(event.start / 1000.0, 'f', 3)
+            << ",\"dur\":" << QString::number(event.duration / 1000.0, 'f', 3) << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+    out.flush();
+    if (!file.commit()) {
+        throw MusicPlayerException("Cannot save trace: " + file.errorString().toStdString());
+    }
+}
+
+} // namespace Trace
+
+#else
+
+void Trace::exportChromeTrace(const QString&) {
+    throw MusicPlayerException("This build has tracing compiled out (CONFIG+=notrace)");
+}
+
+#endif
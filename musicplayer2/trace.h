@@ -0,0 +1,92 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+// Low-overhead latency tracing for player operations.
+//
+// TRACE_SCOPE("name") times the enclosing block and, when it ends, writes
+// one event into a ring buffer owned by the current thread: no lock, no
+// allocation, a few relaxed stores. Rings hold the newest RingSize events
+// per thread; exportChromeTrace() gathers them into Chrome trace JSON
+// (chrome://tracing, Perfetto). Names must be string literals.
+//
+// Counters are process-wide relaxed atomics for the live counters panel.
+//
+// Building with CONFIG+=notrace (MUSICPLAYER_NO_TRACE) compiles all of it
+// out: the macro expands to nothing and the counters to empty inlines.
+namespace Trace {
+
+static constexpr int RingSize = 4096;
+
+enum class Counter {
+    TracksLoaded,
+    DecodeMs,             // Wall time of finished decodes: playback, waveforms, loudness
+    Underruns,            // Times the mixer output ran dry mid-track
+    TimeToFirstAudioMs,   // Of the most recent track start
+    Count
+};
+
+#ifndef MUSICPLAYER_NO_TRACE
+
+constexpr bool Enabled = true;
+
+// Nanoseconds on a monotonic clock
+qint64 now();
+
+void record(const char* name, qint64 startNs, qint64 durationNs);
+
+class Scope {
+public:
+    explicit Scope(const char* name) : name(name), start(now()) {}
+    ~Scope() { record(name, start, now() - start); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name;
+    qint64 start;
+};
+
+extern std::atomic<qint64> counters[static_cast<int>(Counter::Count)];
+
+inline void add(Counter counter, qint64 amount) {
+    counters[static_cast<int>(counter)].fetch_add(amount, std::memory_order_relaxed);
+}
+
+inline void set(Counter counter, qint64 value) {
+    counters[static_cast<int>(counter)].store(value, std::memory_order_relaxed);
+}
+
+inline qint64 value(Counter counter) {
+    return counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+}
+
+// Write every thread's recent events to path; throws MusicPlayerException
+void exportChromeTrace(const QString& path);
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+#else
+
+constexpr bool Enabled = false;
+
+inline qint64 now() { return 0; }
+inline void record(const char*, qint64, qint64) {}
+inline void add(Counter, qint64) {}
+inline void set(Counter, qint64) {}
+inline qint64 value(Counter) { return 0; }
+void exportChromeTrace(const QString& path);
+
+#define TRACE_SCOPE(name) do {} while (false)
+
+#endif
+
+} // namespace Trace
+
+#endif // TRACE_H
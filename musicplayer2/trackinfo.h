@@ -0,0 +1,91 @@
+#ifndef TRACKINFO_H
+#define TRACKINFO_H
+
+#include <QMetaType>
+#include <QString>
+#include <QtMath>
+
+// Display record kept alongside every playlist entry. Starts out with just
+// the file name and is filled in by the background metadata reader.
+struct TrackInfo {
+    QString fileName;
+    QString title;
+    QString artist;
+    QString album;
+    qint64 durationMs = 0;
+
+    // ReplayGain track values from the tags, if present
+    bool hasReplayGain = false;
+    float replayGainDb = 0.0f;
+    float replayGainPeak = 0.0f;
+
+    // EBU R128 analysis results, filled in by LoudnessAnalyzer
+    bool hasLoudness = false;
+    float loudnessLufs = 0.0f;
+    float truePeakDb = 0.0f;
+
+    // Loudness normalization target and true-peak ceiling
+    static constexpr float LoudnessTargetLufs = -18.0f;
+    static constexpr float TruePeakCeilingDb = -1.0f;
+
+    TrackInfo() {}
+    explicit TrackInfo(const QString& fileName) : fileName(fileName) {}
+
+    // Text shown in playlist views and the status bar
+    QString displayName() const {
+        if (title.isEmpty()) {
+            return fileName;
+        }
+        if (artist.isEmpty()) {
+            return title;
+        }
+        return artist + " - " + title;
+    }
+
+    // Everything the playlist search matches against
+    QString searchText() const {
+        return fileName + ' ' + title + ' ' + artist + ' ' + album;
+    }
+
+    // Linear playback gain from ReplayGain, reduced so the tagged peak
+    // never clips; 1.0 when the track has no ReplayGain data
+    float replayGainFactor() const {
+        if (!hasReplayGain) {
+            return 1.0f;
+        }
+        float factor = qPow(10.0f, replayGainDb / 20.0f);
+        if (replayGainPeak > 0.0f && factor * replayGainPeak > 1.0f) {
+            factor = 1.0f / replayGainPeak;
+        }
+        return factor;
+    }
+
+    // Linear gain that brings the measured loudness to the target while
+    // keeping the true peak under the ceiling; 1.0 if not analysed or
+    // unmeasurable (silence has NaN loudness)
+    float loudnessGainFactor() const {
+        if (!hasLoudness || qIsNaN(loudnessLufs)) {
+            return 1.0f;
+        }
+        const float gainDb = qMin(LoudnessTargetLufs - loudnessLufs, TruePeakCeilingDb - truePeakDb);
+        return qPow(10.0f, gainDb / 20.0f);
+    }
+
+    // Duration formatted as m:ss (or h:mm:ss), empty if unknown
+    QString durationText() const {
+        if (durationMs <= 0) {
+            return QString();
+        }
+        const qint64 seconds = durationMs / 1000;
+        if (seconds >= 3600) {
+            return QString("%1:%2:%3").arg(seconds / 3600)
+                .arg((seconds / 60) % 60, 2, 10, QChar('0'))
+                .arg(seconds % 60, 2, 10, QChar('0'));
+        }
+        return QString("%1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0'));
+    }
+};
+
+Q_DECLARE_METATYPE(TrackInfo)
+
+#endif // TRACKINFO_H
@@ -0,0 +1,269 @@
+#include "trackstorage.h"
+
+namespace {
+
+// Leave small amounts of garbage alone; compaction copies the whole arena
+const size_t MinCompactChars = 64 * 1024;
+
+// Rough per-entry cost of a QHash node plus the QString header it keys
+const size_t HashEntryOverhead = 48;
+
+} // namespace
+
+TrackStorage::TrackStorage() : deadChars(0) {
+    // Pool index 0 is the empty string, so cleared slots need no lookup
+    pool.emplace_back();
+    poolIds.insert(QString(), 0);
+}
+
+void TrackStorage::reserve(size_t count) {
+    dirs.reserve(count);
+    files.reserve(count);
+    names.reserve(count);
+    titles.reserve(count);
+    artists.reserve(count);
+    albums.reserve(count);
+    durations.reserve(count);
+    replayGainDb.reserve(count);
+    replayGainPeak.reserve(count);
+    loudnessLufs.reserve(count);
+    truePeakDb.reserve(count);
+    flags.reserve(count);
+}
+
+void TrackStorage::ensureSlot(std::uint32_t slot) {
+    if (slot < dirs.size()) {
+        return;
+    }
+    const size_t count = static_cast<size_t>(slot) + 1;
+    dirs.resize(count, 0);
+    files.resize(count);
+    names.resize(count);
+    titles.resize(count);
+    artists.resize(count, 0);
+    albums.resize(count, 0);
+    durations.resize(count, 0);
+    replayGainDb.resize(count, 0.0f);
+    replayGainPeak.resize(count, 0.0f);
+    loudnessLufs.resize(count, 0.0f);
+    truePeakDb.resize(count, 0.0f);
+    flags.resize(count, 0);
+}
+
+TrackStorage::StringRef TrackStorage::append(QStringView text) {
+    StringRef ref;
+    if (text.isEmpty()) {
+        return ref;
+    }
+    ref.offset = static_cast<std::uint32_t>(arena.size());
+    ref.length = static_cast<std::uint32_t>(text.size());
+    arena.insert(arena.end(), text.begin(), text.end());
+    return ref;
+}
+
+void TrackStorage::release(StringRef& ref) {
+    deadChars += ref.length;
+    ref = StringRef();
+}
+
+std::uint32_t TrackStorage::intern(const QString& text) {
+    auto it = poolIds.constFind(text);
+    if (it != poolIds.constEnd()) {
+        return it.value();
+    }
+    const std::uint32_t id = static_cast<std::uint32_t>(pool.size());
+    pool.push_back(text);
+    poolIds.insert(text, id);
+    return id;
+}
+
+std::uint32_t TrackStorage::directoryId(const QString& directory) {
+    auto it = directoryIds.constFind(directory);
+    if (it != directoryIds.constEnd()) {
+        return it.value();
+    }
+    const std::uint32_t id = static_cast<std::uint32_t>(directories.size());
+    directories.push_back(directory);
+    directoryIds.insert(directory, id);
+    return id;
+}
+
+void TrackStorage::assign(std::uint32_t slot, const QUrl& url, const TrackInfo& info) {
+    ensureSlot(slot);
+    if (url.isLocalFile()) {
+        const QString path = url.toLocalFile();
+        const qsizetype cut = path.lastIndexOf('/') + 1;
+        dirs[slot] = directoryId(path.left(cut));
+        files[slot] = append(QStringView(path).mid(cut));
+    } else {
+        dirs[slot] = NoDirectory;
+        files[slot] = append(url.toString());
+    }
+    storeDisplay(slot, info);
+}
+
+void TrackStorage::storeDisplay(std::uint32_t slot, const TrackInfo& info) {
+    // Scanned tracks are named after their file, so share those characters
+    if (dirs[slot] != NoDirectory && QStringView(info.fileName) == view(files[slot])) {
+        names[slot] = files[slot];
+    } else {
+        names[slot] = append(info.fileName);
+    }
+    titles[slot] = append(info.title);
+    storeFields(slot, info);
+}
+
+void TrackStorage::storeFields(std::uint32_t slot, const TrackInfo& info) {
+    artists[slot] = intern(info.artist);
+    albums[slot] = intern(info.album);
+    durations[slot] = info.durationMs;
+    replayGainDb[slot] = info.replayGainDb;
+    replayGainPeak[slot] = info.replayGainPeak;
+    loudnessLufs[slot] = info.loudnessLufs;
+    truePeakDb[slot] = info.truePeakDb;
+    flags[slot] = static_cast<std::uint8_t>((info.hasReplayGain ? HasReplayGain : 0)
+                                            | (info.hasLoudness ? HasLoudness : 0));
+}
+
+void TrackStorage::releaseDisplay(std::uint32_t slot) {
+    if (names[slot].offset == files[slot].offset && names[slot].length == files[slot].length) {
+        names[slot] = StringRef();
+    } else {
+        release(names[slot]);
+    }
+    release(titles[slot]);
+}
+
+QUrl TrackStorage::item(std::uint32_t slot) const {
+    if (dirs[slot] == NoDirectory) {
+        return QUrl(view(files[slot]).toString());
+    }
+    QString path;
+    path.reserve(directories[dirs[slot]].size() + files[slot].length);
+    path.append(directories[dirs[slot]]);
+    path.append(view(files[slot]));
+    return QUrl::fromLocalFile(path);
+}
+
+TrackInfo TrackStorage::display(std::uint32_t slot) const {
+    TrackInfo info(view(names[slot]).toString());
+    info.title = view(titles[slot]).toString();
+    info.artist = pool[artists[slot]];
+    info.album = pool[albums[slot]];
+    info.durationMs = durations[slot];
+    info.hasReplayGain = (flags[slot] & HasReplayGain) != 0;
+    info.replayGainDb = replayGainDb[slot];
+    info.replayGainPeak = replayGainPeak[slot];
+    info.hasLoudness = (flags[slot] & HasLoudness) != 0;
+    info.loudnessLufs = loudnessLufs[slot];
+    info.truePeakDb = truePeakDb[slot];
+    return info;
+}
+
+std::vector<std::uint32_t> TrackStorage::directoriesUnder(const QString& directory) const {
+    std::vector<std::uint32_t> ids;
+    for (size_t id = 0; id < directories.size(); ++id) {
+        if (directories[id].startsWith(directory)) {
+            ids.push_back(static_cast<std::uint32_t>(id));
+        }
+    }
+    return ids;
+}
+
+QString TrackStorage::displayName(std::uint32_t slot) const {
+    const QStringView title = view(titles[slot]);
+    const QString& artist = pool[artists[slot]];
+    if (title.isEmpty()) {
+        return view(names[slot]).toString();
+    }
+    if (artist.isEmpty()) {
+        return title.toString();
+    }
+    QString name;
+    name.reserve(artist.size() + 3 + title.size());
+    name.append(artist);
+    name.append(QLatin1String(" - "));
+    name.append(title);
+    return name;
+}
+
+void TrackStorage::setDisplay(std::uint32_t slot, const TrackInfo& info) {
+    // Unchanged text (loudness results, say) keeps its arena bytes
+    if (QStringView(info.fileName) == view(names[slot]) && QStringView(info.title) == view(titles[slot])) {
+        storeFields(slot, info);
+        return;
+    }
+    releaseDisplay(slot);
+    storeDisplay(slot, info);
+    if (deadChars > MinCompactChars && deadChars * 2 > arena.size()) {
+        compact();
+    }
+}
+
+bool TrackStorage::matches(std::uint32_t slot, const QUrl& url) const {
+    if (dirs[slot] == NoDirectory) {
+        return !url.isLocalFile() && view(files[slot]) == url.toString();
+    }
+    if (!url.isLocalFile()) {
+        return false;
+    }
+    // File names differ far more often than directories, so compare them first
+    const QString path = url.toLocalFile();
+    const qsizetype cut = path.lastIndexOf('/') + 1;
+    return QStringView(path).mid(cut) == view(files[slot])
+        && QStringView(path).left(cut) == directories[dirs[slot]];
+}
+
+void TrackStorage::clear(std::uint32_t slot) {
+    releaseDisplay(slot);
+    release(files[slot]);
+    dirs[slot] = 0;
+    artists[slot] = 0;
+    albums[slot] = 0;
+    if (deadChars > MinCompactChars && deadChars * 2 > arena.size()) {
+        compact();
+    }
+}
+
+void TrackStorage::compact() {
+    std::vector<QChar> live;
+    live.reserve(arena.size() - deadChars);
+    auto copy = [this, &live](StringRef ref) {
+        StringRef moved;
+        if (ref.length > 0) {
+            moved.offset = static_cast<std::uint32_t>(live.size());
+            moved.length = ref.length;
+            live.insert(live.end(), arena.begin() + ref.offset, arena.begin() + ref.offset + ref.length);
+        }
+        return moved;
+    };
+
+    for (size_t slot = 0; slot < dirs.size(); ++slot) {
+        const bool shared = names[slot].offset == files[slot].offset && names[slot].length == files[slot].length;
+        files[slot] = copy(files[slot]);
+        names[slot] = shared ? files[slot] : copy(names[slot]);
+        titles[slot] = copy(titles[slot]);
+    }
+
+    arena.swap(live);
+    deadChars = 0;
+}
+
+size_t TrackStorage::memoryUsage() const {
+    size_t bytes = arena.capacity() * sizeof(QChar);
+    bytes += dirs.capacity() * sizeof(std::uint32_t);
+    bytes += (files.capacity() + names.capacity() + titles.capacity()) * sizeof(StringRef);
+    bytes += (artists.capacity() + albums.capacity()) * sizeof(std::uint32_t);
+    bytes += durations.capacity() * sizeof(qint64);
+    bytes += (replayGainDb.capacity() + replayGainPeak.capacity()
+              + loudnessLufs.capacity() + truePeakDb.capacity()) * sizeof(float);
+    bytes += flags.capacity();
+    // Hash keys share their characters with the vectors
+    for (const QString& directory : directories) {
+        bytes += directory.capacity() * sizeof(QChar) + HashEntryOverhead;
+    }
+    for (const QString& text : pool) {
+        bytes += text.capacity() * sizeof(QChar) + HashEntryOverhead;
+    }
+    return bytes;
+}
@@ -0,0 +1,110 @@
+#ifndef TRACKSTORAGE_H
+#define TRACKSTORAGE_H
+
+#include <QChar>
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <QUrl>
+#include <cstdint>
+#include <vector>
+#include "trackinfo.h"
+
+// Packed playlist storage for large libraries, used as the Storage policy of
+// MusicPlaylist. Every field is a column indexed by slot. Paths are split
+// into an interned directory plus a file name; file names and titles live in
+// one contiguous UTF-16 arena and are referenced by offset and length.
+// Artists and albums repeat heavily, so they are interned as pool indices.
+// A display file name equal to the path's file name shares its arena bytes.
+//
+// Replaced and removed strings leave holes in the arena that are reclaimed
+// by compacting once they make up half of it. Views returned by the column
+// accessors are only valid until the next mutation.
+class TrackStorage {
+public:
+    // Directory id of entries that are not local files (stored whole)
+    static constexpr std::uint32_t NoDirectory = 0xffffffffu;
+
+    TrackStorage();
+
+    void reserve(size_t count);
+    void assign(std::uint32_t slot, const QUrl& url, const TrackInfo& info);
+    QUrl item(std::uint32_t slot) const;
+    TrackInfo display(std::uint32_t slot) const;
+    void setDisplay(std::uint32_t slot, const TrackInfo& info);
+    bool matches(std::uint32_t slot, const QUrl& url) const;
+    void clear(std::uint32_t slot);
+    size_t memoryUsage() const;
+
+    // Column accessors
+    QStringView fileName(std::uint32_t slot) const { return view(names[slot]); }
+    QStringView title(std::uint32_t slot) const { return view(titles[slot]); }
+    QStringView artist(std::uint32_t slot) const { return pool[artists[slot]]; }
+    QStringView album(std::uint32_t slot) const { return pool[albums[slot]]; }
+    qint64 durationMs(std::uint32_t slot) const { return durations[slot]; }
+
+    // Where an entry's file lives: an interned directory id (directory paths
+    // end in '/') and the file name within it
+    std::uint32_t directoryOf(std::uint32_t slot) const { return dirs[slot]; }
+    QStringView pathName(std::uint32_t slot) const { return view(files[slot]); }
+
+    // Id of an interned directory, or NoDirectory
+    std::uint32_t findDirectory(const QString& directory) const {
+        return directoryIds.value(directory, NoDirectory);
+    }
+
+    // Ids of the interned directories equal to or below directory
+    std::vector<std::uint32_t> directoriesUnder(const QString& directory) const;
+
+    // Same text as TrackInfo::displayName(), built with a single allocation
+    QString displayName(std::uint32_t slot) const;
+
+private:
+    struct StringRef {
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+    };
+
+    enum Flags : std::uint8_t {
+        HasReplayGain = 0x01,
+        HasLoudness = 0x02
+    };
+
+    QStringView view(StringRef ref) const {
+        return QStringView(arena.data() + ref.offset, static_cast<qsizetype>(ref.length));
+    }
+
+    StringRef append(QStringView text);
+    void release(StringRef& ref);
+    std::uint32_t intern(const QString& text);
+    std::uint32_t directoryId(const QString& directory);
+    void ensureSlot(std::uint32_t slot);
+    void storeDisplay(std::uint32_t slot, const TrackInfo& info);
+    void storeFields(std::uint32_t slot, const TrackInfo& info);
+    void releaseDisplay(std::uint32_t slot);
+    void compact();
+
+    // Shared text
+    std::vector<QChar> arena;
+    size_t deadChars;
+    std::vector<QString> directories;
+    QHash<QString, std::uint32_t> directoryIds;
+    std::vector<QString> pool;
+    QHash<QString, std::uint32_t> poolIds;
+
+    // Columns
+    std::vector<std::uint32_t> dirs;
+    std::vector<StringRef> files;
+    std::vector<StringRef> names;
+    std::vector<StringRef> titles;
+    std::vector<std::uint32_t> artists;
+    std::vector<std::uint32_t> albums;
+    std::vector<qint64> durations;
+    std::vector<float> replayGainDb;
+    std::vector<float> replayGainPeak;
+    std::vector<float> loudnessLufs;
+    std::vector<float> truePeakDb;
+    std::vector<std::uint8_t> flags;
+};
+
+#endif // TRACKSTORAGE_H
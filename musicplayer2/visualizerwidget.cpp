@@ -0,0 +1,70 @@
+#include "visualizerwidget.h"
+#include <QPainter>
+#include <QPolygonF>
+#include <QTimer>
+
+VisualizerWidget::VisualizerWidget(SpectrumAnalyzer* analyzer, QWidget* parent)
+    : QWidget(parent), analyzer(analyzer), timer(new QTimer(this)) {
+    // Everything is repainted each frame
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumHeight(80);
+
+    timer->setTimerType(Qt::PreciseTimer);
+    timer->setInterval(1000 / SpectrumAnalyzer::FramesPerSecond);
+    connect(timer, &QTimer::timeout, this, &VisualizerWidget::poll);
+}
+
+QSize VisualizerWidget::sizeHint() const {
+    return QSize(300, 120);
+}
+
+void VisualizerWidget::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    analyzer->setActive(true);
+    timer->start();
+}
+
+void VisualizerWidget::hideEvent(QHideEvent* event) {
+    QWidget::hideEvent(event);
+    timer->stop();
+    analyzer->setActive(false);
+}
+
+void VisualizerWidget::poll() {
+    if (analyzer->latest(snapshot)) {
+        update();
+    }
+}
+
+void VisualizerWidget::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+
+    const qreal w = width();
+    const qreal waveHeight = height() * 0.4;
+    const qreal barsTop = waveHeight + 4;
+    const qreal barsHeight = height() - barsTop;
+
+    // Waveform as a min/max envelope
+    const int points = SpectrumSnapshot::WavePoints;
+    QPolygonF envelope;
+    envelope.reserve(2 * points);
+    const qreal middle = waveHeight / 2;
+    for (int i = 0; i < points; ++i) {
+        envelope << QPointF(i * w / (points - 1), middle - snapshot.waveMax[i] * middle);
+    }
+    for (int i = points - 1; i >= 0; --i) {
+        envelope << QPointF(i * w / (points - 1), middle - snapshot.waveMin[i] * middle);
+    }
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(palette().color(QPalette::Highlight));
+    painter.drawPolygon(envelope);
+
+    // Spectrum bars with a one pixel gap
+    const int bars = SpectrumSnapshot::BarCount;
+    const qreal barWidth = w / bars;
+    for (int bar = 0; bar < bars; ++bar) {
+        const qreal h = snapshot.bars[bar] * barsHeight;
+        painter.drawRect(QRectF(bar * barWidth, barsTop + barsHeight - h, barWidth - 1, h));
+    }
+}
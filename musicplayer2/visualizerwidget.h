@@ -0,0 +1,36 @@
+#ifndef VISUALIZERWIDGET_H
+#define VISUALIZERWIDGET_H
+
+#include <QWidget>
+#include "spectrumanalyzer.h"
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+// Waveform (top) and spectrum bars (bottom) of what is playing. Polls the
+// analyzer's lock-free snapshot at the analysis rate and repaints only when
+// a new frame arrived; while hidden it stops polling and turns the analyzer
+// off, so a collapsed view costs nothing.
+class VisualizerWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit VisualizerWidget(SpectrumAnalyzer* analyzer, QWidget* parent = nullptr);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    void poll();
+
+    SpectrumAnalyzer* analyzer;
+    QTimer* timer;
+    SpectrumSnapshot snapshot;
+};
+
+#endif // VISUALIZERWIDGET_H
@@ -0,0 +1,199 @@
+#include "waveformcache.h"
+#include "playlistmanager.h"
+#include "trace.h"
+
+#include <QAudioBuffer>
+#include <QAudioDecoder>
+#include <QAudioFormat>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QTimer>
+#include <vector>
+
+namespace {
+
+// Bytes hashed from each end of the file; enough to tell tracks apart
+// without reading a whole multi-hour mix
+const qint64 HashedBytes = 1 << 20;
+
+// How quickly a decode notices the cache is being destroyed
+const int ShutdownCheckMs = 100;
+
+QString contentKey(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw MusicPlayerException("Cannot read " + path.toStdString() + ": " + file.errorString().toStdString());
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const qint64 size = file.size();
+    hash.addData(QByteArray::number(size));
+    hash.addData(file.read(HashedBytes));
+    if (size > 2 * HashedBytes) {
+        file.seek(size - HashedBytes);
+    }
+    hash.addData(file.read(HashedBytes));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+} // namespace
+
+WaveformCache::WaveformCache(const QString& cacheDir, QObject *parent)
+    : QObject(parent), cacheDir(cacheDir), shuttingDown(false) {
+    qRegisterMetaType<WaveformPtr>();
+
+    // One decode at a time, behind playback
+    pool.setMaxThreadCount(1);
+    pool.setThreadPriority(QThread::LowPriority);
+
+    connect(this, &WaveformCache::waveformReady, this, [this](const QUrl& url) {
+        pending.remove(url);
+    });
+}
+
+WaveformCache::~WaveformCache() {
+    shuttingDown = true;
+    pool.clear();
+    pool.waitForDone();
+}
+
+QString WaveformCache::defaultLocation() {
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("waveforms");
+}
+
+void WaveformCache::request(const QUrl& url) {
+    if (!url.isLocalFile() || pending.contains(url)) {
+        return;
+    }
+    pending.insert(url);
+    pool.start([this, url]() { prepare(url); });
+}
+
+void WaveformCache::prepare(const QUrl& url) {
+    WaveformPtr waveform;
+    try {
+        const QString cacheFile = QDir(cacheDir).filePath(contentKey(url.toLocalFile()) + ".peaks");
+
+        // Built before: reading it back takes milliseconds
+        QFile cached(cacheFile);
+        if (cached.open(QIODevice::ReadOnly)) {
+            QDataStream in(&cached);
+            auto loaded = std::make_shared<WaveformPyramid>();
+            if (loaded->read(in)) {
+                emit waveformReady(url, loaded);
+                return;
+            }
+        }
+
+        waveform = decode(url);
+        if (waveform) {
+            QDir().mkpath(cacheDir);
+            QSaveFile file(cacheFile);
+            if (!file.open(QIODevice::WriteOnly)) {
+                throw MusicPlayerException("Cannot write waveform cache: " + file.errorString().toStdString());
+            }
+            QDataStream out(&file);
+            waveform->write(out);
+            if (!file.commit()) {
+                throw MusicPlayerException("Cannot save waveform cache: " + file.errorString().toStdString());
+            }
+        }
+    } catch (const MusicPlayerException& e) {
+        emit errorOccurred(QString("Waveform: ") + e.what());
+    }
+    // Also sent empty, so the request is no longer pending
+    emit waveformReady(url, waveform);
+}
+
+WaveformPtr WaveformCache::decode(const QUrl& url) {
+    TRACE_SCOPE("waveform: decode");
+    const qint64 decodeStart = Trace::now();
+    QAudioFormat format;
+    format.setSampleFormat(QAudioFormat::Float);
+
+    QAudioDecoder decoder;
+    decoder.setAudioFormat(format);
+    decoder.setSource(url);
+
+    auto waveform = std::make_shared<WaveformPyramid>();
+    std::vector<float> converted;
+    int sampleRate = 0;
+    bool failed = false;
+    // Set by whichever handler ends the decode; the backend may report an
+    // error from inside start(), before the loop runs
+    bool done = false;
+
+    // The decoder reports through signals, so run a local loop on this worker
+    QEventLoop loop;
+    connect(&decoder, &QAudioDecoder::bufferReady, &loop, [&]() {
+        while (decoder.bufferAvailable() && !shuttingDown) {
+            const QAudioBuffer buffer = decoder.read();
+            const QAudioFormat bufferFormat = buffer.format();
+            const int channels = bufferFormat.channelCount();
+            const qint64 frames = buffer.frameCount();
+            if (frames <= 0 || channels <= 0) {
+                continue;
+            }
+            sampleRate = bufferFormat.sampleRate();
+
+            if (bufferFormat.sampleFormat() == QAudioFormat::Float) {
+                waveform->addFrames(buffer.constData<float>(), frames, channels);
+            } else {
+                const char* raw = buffer.constData<char>();
+                const int bytesPerSample = bufferFormat.bytesPerSample();
+                converted.resize(static_cast<size_t>(frames * channels));
+                for (size_t i = 0; i < converted.size(); ++i) {
+                    converted[i] = bufferFormat.normalizedSampleValue(raw + i * bytesPerSample);
+                }
+                waveform->addFrames(converted.data(), frames, channels);
+            }
+        }
+        if (shuttingDown) {
+            decoder.stop();
+            done = true;
+            loop.quit();
+        }
+    });
+    connect(&decoder, &QAudioDecoder::finished, &loop, [&]() {
+        done = true;
+        loop.quit();
+    });
+    connect(&decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), &loop,
+            [&](QAudioDecoder::Error) {
+        failed = true;
+        done = true;
+        loop.quit();
+    });
+    // Shutdown must not wait on a decoder that has stopped delivering buffers
+    QTimer shutdownCheck;
+    shutdownCheck.setInterval(ShutdownCheckMs);
+    connect(&shutdownCheck, &QTimer::timeout, &loop, [&]() {
+        if (shuttingDown) {
+            decoder.stop();
+            done = true;
+            loop.quit();
+        }
+    });
+
+    decoder.start();
+    if (!done) {
+        shutdownCheck.start();
+        loop.exec();
+    }
+    Trace::add(Trace::Counter::DecodeMs, (Trace::now() - decodeStart) / 1000000);
+
+    if (failed) {
+        emit errorOccurred("Waveform: cannot decode " + url.toLocalFile() + ": " + decoder.errorString());
+        return nullptr;
+    }
+    if (shuttingDown) {
+        return nullptr;
+    }
+    waveform->finish(sampleRate);
+    return waveform;
+}
@@ -0,0 +1,51 @@
+#ifndef WAVEFORMCACHE_H
+#define WAVEFORMCACHE_H
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QUrl>
+#include <atomic>
+#include <memory>
+#include "waveformpyramid.h"
+
+using WaveformPtr = std::shared_ptr<const WaveformPyramid>;
+
+Q_DECLARE_METATYPE(WaveformPtr)
+
+// Waveform overviews for the tracks being played. A track is decoded once,
+// in the background, into a WaveformPyramid that is saved under a hash of
+// the file's contents; later requests (also after a rename or move) just
+// read it back. Overviews are immutable once built and shared read-only.
+class WaveformCache : public QObject {
+    Q_OBJECT
+
+public:
+    explicit WaveformCache(const QString& cacheDir = defaultLocation(), QObject *parent = nullptr);
+    virtual ~WaveformCache();
+
+    // Per-user cache directory used when none is given
+    static QString defaultLocation();
+
+    // Result arrives through waveformReady; requests for a track that is
+    // still being prepared are ignored
+    void request(const QUrl& url);
+
+signals:
+    void waveformReady(const QUrl& url, const WaveformPtr& waveform);
+    void errorOccurred(const QString& error);
+
+private:
+    void prepare(const QUrl& url);
+    WaveformPtr decode(const QUrl& url);
+
+    QString cacheDir;
+    QThreadPool pool;
+    std::atomic<bool> shuttingDown;
+
+    // GUI thread only
+    QSet<QUrl> pending;
+};
+
+#endif // WAVEFORMCACHE_H
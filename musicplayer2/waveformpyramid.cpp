@@ -0,0 +1,141 @@
+#include "waveformpyramid.h"
+#include <QDataStream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const quint32 PyramidMagic = 0x5750594D;   // "WPYM"
+const quint32 PyramidVersion = 1;
+
+qint8 quantize(float sample) {
+    return static_cast<qint8>(std::clamp(std::lround(sample * 127.0f), -127L, 127L));
+}
+
+} // namespace
+
+WaveformPyramid::WaveformPyramid()
+    : frames(0), rate(0), pendingMin(0.0f), pendingMax(0.0f), pendingFrames(0) {
+}
+
+void WaveformPyramid::addFrames(const float* samples, qint64 count, int channels) {
+    for (qint64 frame = 0; frame < count; ++frame) {
+        const float* first = samples + frame * channels;
+        const auto range = std::minmax_element(first, first + channels);
+        if (pendingFrames == 0) {
+            pendingMin = *range.first;
+            pendingMax = *range.second;
+        } else {
+            pendingMin = std::min(pendingMin, *range.first);
+            pendingMax = std::max(pendingMax, *range.second);
+        }
+        if (++pendingFrames == BaseFrames) {
+            flushPeak();
+        }
+    }
+    frames += count;
+}
+
+void WaveformPyramid::flushPeak() {
+    base.push_back(Peak{quantize(pendingMin), quantize(pendingMax)});
+    pendingFrames = 0;
+}
+
+void WaveformPyramid::finish(int sampleRate) {
+    if (pendingFrames > 0) {
+        flushPeak();
+    }
+    rate = sampleRate;
+    levels.clear();
+    if (base.empty()) {
+        return;
+    }
+
+    levels.push_back(std::move(base));
+    base = std::vector<Peak>();
+    while (levels.back().size() > 1) {
+        const std::vector<Peak>& below = levels.back();
+        std::vector<Peak> above((below.size() + 1) / 2);
+        for (size_t i = 0; i < above.size(); ++i) {
+            const Peak& left = below[2 * i];
+            const Peak& right = 2 * i + 1 < below.size() ? below[2 * i + 1] : left;
+            above[i] = Peak{std::min(left.min, right.min), std::max(left.max, right.max)};
+        }
+        levels.push_back(std::move(above));
+    }
+}
+
+void WaveformPyramid::render(qint64 first, qint64 last, int columns, std::vector<Peak>& out) const {
+    out.assign(static_cast<size_t>(std::max(columns, 0)), Peak{0, 0});
+    if (levels.empty() || columns <= 0 || last <= first) {
+        return;
+    }
+
+    // Coarsest level that still has a peak per column
+    const double perColumn = static_cast<double>(last - first) / columns;
+    int index = 0;
+    while (index + 1 < levelCount() && framesPerPeak(index + 1) <= perColumn) {
+        ++index;
+    }
+    const std::vector<Peak>& peaks = levels[index];
+    const double perPeak = static_cast<double>(framesPerPeak(index));
+    const qint64 size = static_cast<qint64>(peaks.size());
+
+    for (int column = 0; column < columns; ++column) {
+        const double start = first + column * perColumn;
+        const double end = start + perColumn;
+        const qint64 from = std::max<qint64>(0, static_cast<qint64>(std::floor(start / perPeak)));
+        const qint64 to = std::min(size, std::max(from + 1, static_cast<qint64>(std::ceil(end / perPeak))));
+        if (from >= size) {
+            break;
+        }
+        Peak peak = peaks[from];
+        for (qint64 i = from + 1; i < to; ++i) {
+            peak.min = std::min(peak.min, peaks[i].min);
+            peak.max = std::max(peak.max, peaks[i].max);
+        }
+        out[column] = peak;
+    }
+}
+
+void WaveformPyramid::write(QDataStream& out) const {
+    out << PyramidMagic << PyramidVersion << static_cast<qint32>(BaseFrames)
+        << static_cast<qint32>(rate) << frames << static_cast<qint32>(levels.size());
+    for (const std::vector<Peak>& peaks : levels) {
+        out << static_cast<qint64>(peaks.size());
+        out.writeRawData(reinterpret_cast<const char*>(peaks.data()), static_cast<int>(peaks.size() * sizeof(Peak)));
+    }
+}
+
+bool WaveformPyramid::read(QDataStream& in) {
+    levels.clear();
+    quint32 magic;
+    quint32 version;
+    qint32 baseFrames;
+    qint32 sampleRate;
+    qint64 frameTotal;
+    qint32 count;
+    in >> magic >> version >> baseFrames >> sampleRate >> frameTotal >> count;
+    if (in.status() != QDataStream::Ok || magic != PyramidMagic || version != PyramidVersion
+        || baseFrames != BaseFrames || count < 0 || count > 64) {
+        return false;
+    }
+
+    std::vector<std::vector<Peak>> loaded(static_cast<size_t>(count));
+    for (std::vector<Peak>& peaks : loaded) {
+        qint64 size;
+        in >> size;
+        if (in.status() != QDataStream::Ok || size < 0 || size > (frameTotal / BaseFrames) + 1) {
+            return false;
+        }
+        peaks.resize(static_cast<size_t>(size));
+        const int bytes = static_cast<int>(peaks.size() * sizeof(Peak));
+        if (in.readRawData(reinterpret_cast<char*>(peaks.data()), bytes) != bytes) {
+            return false;
+        }
+    }
+    levels.swap(loaded);
+    rate = sampleRate;
+    frames = frameTotal;
+    return true;
+}
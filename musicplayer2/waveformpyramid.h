@@ -0,0 +1,62 @@
+#ifndef WAVEFORMPYRAMID_H
+#define WAVEFORMPYRAMID_H
+
+#include <QtGlobal>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QDataStream;
+QT_END_NAMESPACE
+
+// Min/max overview of a whole track at several resolutions. Level 0 holds
+// one peak per BaseFrames frames (over all channels); each level above
+// merges pairs of the one below, up to a single peak. Drawing any span at
+// any width then reads about two peaks per column from the level that fits,
+// so a four-hour mix redraws as fast as a three-minute song.
+// Feed interleaved float frames with addFrames(), then call finish().
+class WaveformPyramid {
+public:
+    static constexpr int BaseFrames = 256;
+
+    // Samples quantized to -127..127
+    struct Peak {
+        qint8 min;
+        qint8 max;
+    };
+
+    WaveformPyramid();
+
+    void addFrames(const float* samples, qint64 frames, int channels);
+    // Flush the last partial peak and build the upper levels
+    void finish(int sampleRate);
+
+    bool isEmpty() const { return levels.empty(); }
+    qint64 frameCount() const { return frames; }
+    int sampleRate() const { return rate; }
+    int levelCount() const { return static_cast<int>(levels.size()); }
+    qint64 framesPerPeak(int level) const { return static_cast<qint64>(BaseFrames) << level; }
+    const std::vector<Peak>& level(int index) const { return levels[index]; }
+
+    // One peak per column for frames [first, last); columns past the end
+    // of the track are flat
+    void render(qint64 first, qint64 last, int columns, std::vector<Peak>& out) const;
+
+    void write(QDataStream& out) const;
+    // False (and left empty) if the data is not a pyramid of this version
+    bool read(QDataStream& in);
+
+private:
+    void flushPeak();
+
+    std::vector<std::vector<Peak>> levels;
+    qint64 frames;
+    int rate;
+
+    // Peak being collected by addFrames
+    float pendingMin;
+    float pendingMax;
+    int pendingFrames;
+    std::vector<Peak> base;
+};
+
+#endif // WAVEFORMPYRAMID_H
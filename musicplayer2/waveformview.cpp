@@ -0,0 +1,82 @@
+#include "waveformview.h"
+#include <QPainter>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Closest zoom: a few peaks of the finest level per column
+const qint64 MinVisibleFrames = 64 * WaveformPyramid::BaseFrames;
+
+} // namespace
+
+WaveformView::WaveformView(QWidget *parent) : QWidget(parent), firstFrame(0), lastFrame(0) {
+    setMinimumHeight(48);
+}
+
+QSize WaveformView::sizeHint() const {
+    return QSize(300, 64);
+}
+
+void WaveformView::setSource(const QUrl& url) {
+    if (url == source) {
+        return;
+    }
+    source = url;
+    waveform.reset();
+    showWhole();
+}
+
+void WaveformView::setWaveform(const QUrl& url, const WaveformPtr& ready) {
+    if (url != source) {
+        return;
+    }
+    waveform = ready;
+    showWhole();
+}
+
+void WaveformView::showWhole() {
+    firstFrame = 0;
+    lastFrame = waveform ? waveform->frameCount() : 0;
+    update();
+}
+
+void WaveformView::wheelEvent(QWheelEvent *event) {
+    if (!waveform || lastFrame <= firstFrame) {
+        return;
+    }
+    // Zoom about the frame under the pointer, 1.25x per wheel notch
+    const double span = static_cast<double>(lastFrame - firstFrame);
+    const double anchor = firstFrame + span * event->position().x() / std::max(1, width());
+    const double factor = std::pow(1.25, -event->angleDelta().y() / 120.0);
+    const double total = static_cast<double>(waveform->frameCount());
+    const double closest = std::min(static_cast<double>(MinVisibleFrames), total);
+    const double newSpan = std::clamp(span * factor, closest, total);
+    const double start = std::clamp(anchor - (anchor - firstFrame) * newSpan / span, 0.0, total - newSpan);
+    firstFrame = static_cast<qint64>(start);
+    lastFrame = static_cast<qint64>(start + newSpan);
+    update();
+    event->accept();
+}
+
+void WaveformView::mouseDoubleClickEvent(QMouseEvent *) {
+    showWhole();
+}
+
+void WaveformView::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+    if (!waveform || waveform->isEmpty()) {
+        return;
+    }
+
+    waveform->render(firstFrame, lastFrame, width(), columns);
+    const qreal middle = height() / 2.0;
+    const qreal scale = middle / 127.0;
+    painter.setPen(palette().color(QPalette::Highlight));
+    for (int x = 0; x < static_cast<int>(columns.size()); ++x) {
+        const WaveformPyramid::Peak& peak = columns[x];
+        painter.drawLine(QPointF(x + 0.5, middle - peak.max * scale), QPointF(x + 0.5, middle - peak.min * scale));
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef WAVEFORMVIEW_H
+#define WAVEFORMVIEW_H
+
+#include <QWidget>
+#include <QUrl>
+#include <vector>
+#include "waveformcache.h"
+
+// Overview of the current track from its WaveformPyramid. The wheel zooms
+// around the pointer and a double click shows the whole track again.
+// Painting only reads the pyramid, so it costs the same at any zoom.
+class WaveformView : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit WaveformView(QWidget *parent = nullptr);
+
+    QSize sizeHint() const override;
+
+    // Track to show; its overview follows through setWaveform
+    void setSource(const QUrl& url);
+    // Ignored unless it belongs to the current source
+    void setWaveform(const QUrl& url, const WaveformPtr& waveform);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private:
+    void showWhole();
+
+    QUrl source;
+    WaveformPtr waveform;
+
+    // Visible frames [firstFrame, lastFrame)
+    qint64 firstFrame;
+    qint64 lastFrame;
+
+    // Reused between paints
+    std::vector<WaveformPyramid::Peak> columns;
+};
+
+#endif // WAVEFORMVIEW_H